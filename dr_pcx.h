@@ -22,14 +22,25 @@
 // #define DR_PCX_NO_STDIO
 //   Disable drpcx_load_file().
 //
+// #define DR_PCX_USE_THREADS
+//   Makes drpcx_load_batch() decode the images on multiple threads. This needs pthreads on non-Windows platforms. When this is
+//   not defined the images are decoded one after the other on the calling thread, and no threading library is needed.
+//
+// #define DR_PCX_BUFFER_SIZE <number>
+//   Defines the size of the internal buffer to store data from onRead(). This buffer is used to reduce the number of calls
+//   back to the client for more data. The default is 4KB. This is not used by drpcx_load_memory() which reads straight from
+//   the given memory.
+//
 //
 //
 // QUICK NOTES
-// - 1- and 2-bit per pixel images are not properly supported.
+// - Supported formats are 8-bit palette, grayscale, RGB and RGBA, 1-bit monochrome and 8/16 color EGA with up to 4 planes,
+//   and 2- and 4-bit with a single plane.
+// - 2-bit per pixel images use the palette from the header. The CGA palette encoding is not supported.
 //
 //
 // TODO
-// - Fix decoding of 1- and 2-bit per pixel images.
+// - CGA palettes for 2-bit per pixel images.
 
 #ifndef dr_pcx_h
 #define dr_pcx_h
@@ -38,6 +49,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// As data is read from the client it is placed into an internal buffer so the decoder doesn't need to call back to the client
+// for every byte. This controls the size of that buffer.
+#ifndef DR_PCX_BUFFER_SIZE
+#define DR_PCX_BUFFER_SIZE  4096
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,6 +62,44 @@ extern "C" {
 // Callback for when data is read. Return value is the number of bytes actually read.
 typedef size_t (* drpcx_read_proc)(void* userData, void* bufferOut, size_t bytesToRead);
 
+typedef enum
+{
+    drpcx_seek_origin_start,
+    drpcx_seek_origin_end
+} drpcx_seek_origin;
+
+// Callback for when data needs to be seeked. <offset> is relative to <origin>, where drpcx_seek_origin_start is the first byte of
+// the file and drpcx_seek_origin_end is one past the last byte, with a negative offset. Return value is false on failure.
+typedef bool (* drpcx_seek_proc)(void* userData, int64_t offset, drpcx_seek_origin origin);
+
+// The pixel formats images can be decoded to with drpcx_load_into(). Each component is 8-bit.
+typedef enum
+{
+    drpcx_format_rgb8,
+    drpcx_format_rgba8,
+    drpcx_format_bgra8
+} drpcx_format;
+
+// The format of an image as described by its header. This is retrieved with drpcx_info().
+typedef struct
+{
+    // The width of the image.
+    unsigned int width;
+
+    // The height of the image.
+    unsigned int height;
+
+    // The number of bits per pixel in each plane: 1, 2, 4 or 8.
+    unsigned int bitsPerPixel;
+
+    // The number of planes: 1 to 4.
+    unsigned int bitPlanes;
+
+    // The number of color components drpcx_load() outputs: 3 (RGB) or 4 (RGBA).
+    unsigned int components;
+
+} drpcx_image_info;
+
 typedef struct
 {
     // The width of the image.
@@ -78,6 +133,119 @@ drpcx* drpcx_load_file(const char* pFile, bool flipped);
 drpcx* drpcx_load_memory(const void* pData, size_t dataSize, bool flipped);
 
 
+// Retrieves the dimensions and format of a PCX file from its header without decoding it. This reads the 128 byte header and
+// nothing else, and doesn't allocate any memory. Returns false if the file isn't a PCX file or isn't in a supported format.
+bool drpcx_info(drpcx_read_proc onRead, void* pUserData, drpcx_image_info* pInfoOut);
+
+#ifndef DR_PCX_NO_STDIO
+// Same as drpcx_info(), except reads from a file.
+bool drpcx_info_file(const char* pFile, drpcx_image_info* pInfoOut);
+#endif
+
+// Same as drpcx_info(), except reads from a block of memory.
+bool drpcx_info_memory(const void* pData, size_t dataSize, drpcx_image_info* pInfoOut);
+
+
+// Decodes a PCX file straight into a buffer owned by the client, such as a mapped texture or a region of an atlas, without
+// allocating memory for the image.
+//
+// The image is written to the top left of an area of <outWidth> x <outHeight> pixels starting at <pOut>, with rows <outStride>
+// bytes apart. This fails without writing anything if the image is bigger than that area. Images without an alpha channel get
+// an alpha of 255 when decoded to a 4 component format, and the alpha channel is dropped when decoding to RGB. When <flipped>
+// is true the first row of the image is written last.
+bool drpcx_load_into(drpcx_read_proc onRead, void* pUserData, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped);
+
+#ifndef DR_PCX_NO_STDIO
+// Same as drpcx_load_into(), except loads from a file.
+bool drpcx_load_file_into(const char* pFile, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped);
+#endif
+
+// Same as drpcx_load_into(), except loads from a block of memory.
+bool drpcx_load_memory_into(const void* pData, size_t dataSize, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped);
+
+
+// A PCX file being decoded one row at a time, from top to bottom. Only a single row of the image is ever held in memory so
+// this can be used for images of any size.
+typedef struct
+{
+    // The width of the image.
+    unsigned int width;
+
+    // The height of the image.
+    unsigned int height;
+
+    // The format each row is output in, and its number of components.
+    drpcx_format format;
+    unsigned int components;
+
+    // The index of the next row to be read.
+    unsigned int nextRow;
+
+} drpcx_stream;
+
+// Callback for drpcx_read_rows(). <pRow> holds width pixels in the stream's format. Return false to stop decoding.
+typedef bool (* drpcx_row_proc)(void* pUserData, unsigned int row, const void* pRow);
+
+// Opens a PCX file for decoding one row at a time using the given callbacks.
+//
+// onSeek is optional, but 8-bit images with a single plane whose header says they have a 256 color palette can only be
+// streamed when it's given. The palette is at the end of the file and needs to be read before the first row. Those whose
+// header says they don't have one are streamed as grayscale.
+drpcx_stream* drpcx_open(drpcx_read_proc onRead, drpcx_seek_proc onSeek, void* pUserData, drpcx_format format);
+
+#ifndef DR_PCX_NO_STDIO
+// Opens a PCX file for decoding one row at a time from an actual file.
+drpcx_stream* drpcx_open_file(const char* pFile, drpcx_format format);
+#endif
+
+// Opens a PCX file for decoding one row at a time from a block of memory. The memory must remain valid until the stream is
+// closed.
+drpcx_stream* drpcx_open_memory(const void* pData, size_t dataSize, drpcx_format format);
+
+// Closes a stream opened with drpcx_open(), drpcx_open_file() or drpcx_open_memory().
+void drpcx_close(drpcx_stream* pStream);
+
+// Decodes the next row into <pRowOut>, which needs to have room for width pixels in the stream's format. Returns false once
+// every row has been read.
+bool drpcx_read_row(drpcx_stream* pStream, void* pRowOut);
+
+// Decodes every remaining row, passing each one to <onRow>. Returns false if <onRow> stopped decoding early.
+bool drpcx_read_rows(drpcx_stream* pStream, drpcx_row_proc onRow, void* pUserData);
+
+
+// An image to be decoded by drpcx_load_batch().
+typedef struct
+{
+    // The source. When pFilePath is not NULL the image is loaded from that file, otherwise it's loaded from the <dataSize> bytes
+    // at pData.
+    const char* pFilePath;
+    const void* pData;
+    size_t dataSize;
+
+    // The destination. When pOut is NULL the image is loaded as with drpcx_load() and returned in pPCX. Otherwise it's decoded
+    // into pOut as with drpcx_load_into(), using the other members. <flipped> applies either way.
+    void* pOut;
+    unsigned int outWidth;
+    unsigned int outHeight;
+    size_t outStride;
+    drpcx_format format;
+    bool flipped;
+
+    // Set by drpcx_load_batch(). pPCX needs to be deleted with drpcx_delete() when it's not NULL.
+    drpcx* pPCX;
+    bool succeeded;
+
+} drpcx_batch_item;
+
+// Decodes a list of images on <threadCount> threads at the same time, including the calling thread, and returns once they're
+// all done. A <threadCount> of 0 uses one thread per processor. The result of each image is in its <succeeded> member, and a
+// failed image doesn't stop the others. Returns true if every image was decoded successfully.
+//
+// The images are only decoded on multiple threads when DR_PCX_USE_THREADS is defined. Otherwise <threadCount> is ignored and
+// they're decoded one after the other on the calling thread.
+bool drpcx_load_batch(drpcx_batch_item* pItems, size_t itemCount, unsigned int threadCount);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -91,6 +259,25 @@ drpcx* drpcx_load_memory(const void* pData, size_t dataSize, bool flipped);
 //
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef DR_PCX_IMPLEMENTATION
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef DR_PCX_USE_THREADS
+#define DRPCX_HAS_THREADS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define DRPCX_INLINE __forceinline
+#else
+#define DRPCX_INLINE inline
+#endif
 
 #ifndef DR_PCX_NO_STDIO
 #include <stdio.h>
@@ -100,459 +287,1118 @@ static size_t drpcx__on_read_stdio(void* pUserData, void* bufferOut, size_t byte
     return fread(bufferOut, 1, bytesToRead, (FILE*)pUserData);
 }
 
-drpcx* drpcx_load_file(const char* filename, bool flipped)
+static bool drpcx__on_seek_stdio(void* pUserData, int64_t offset, drpcx_seek_origin origin)
+{
+    return fseek((FILE*)pUserData, (long)offset, (origin == drpcx_seek_origin_end) ? SEEK_END : SEEK_SET) == 0;
+}
+
+static FILE* drpcx__fopen(const char* filename)
 {
     FILE* pFile;
 #ifdef _MSC_VER
     if (fopen_s(&pFile, filename, "rb") != 0) {
-        return false;
+        return NULL;
     }
 #else
     pFile = fopen(filename, "rb");
     if (pFile == NULL) {
-        return false;
+        return NULL;
     }
 #endif
 
-    return drpcx_load(drpcx__on_read_stdio, pFile, flipped);
+    return pFile;
 }
 #endif  // DR_PCX_NO_STDIO
 
 
 typedef struct
 {
-    // A pointer to the beginning of the data. We use a char as the type here for easy offsetting.
-    const unsigned char* data;
-
-    // The size of the data.
-    size_t dataSize;
+    drpcx_read_proc onRead;
+    drpcx_seek_proc onSeek;
+    void* pUserData;
 
-    // The position we're currently sitting at.
-    size_t currentReadPos;
+    // The format of the image from the header.
+    uint32_t width;
+    uint32_t height;
+    uint32_t bpp;
+    uint32_t bitPlanes;
+    uint32_t bytesPerLine;
 
-} drpcx_memory;
+    // The state of the run-length decoder. Some encoders let runs carry over from one scanline to the next so this needs to
+    // persist between scanlines.
+    uint32_t rleCount;
+    uint8_t rleValue;
+
+    // The encoded scanline, every plane of it, and for images with less than 8 bits per pixel the palette index of each pixel
+    // in that scanline.
+    uint8_t* pScanline;
+    uint8_t* pIndices;
+
+    // The 16 color palette from the header, as RGB triples.
+    uint8_t palette16[48];
+
+    // For 8-bit images with a single plane, the 256 color palette from the end of the file as RGB triples. When the header
+    // says there is one and the data can be seeked, it's read before decoding, in which case isPalette256Known is set and
+    // hasPalette256 tells whether or not the last 769 bytes look like one. Otherwise it's read after the last row.
+    bool isPalette256Expected;
+    bool isPalette256Known;
+    bool hasPalette256;
+    uint8_t palette256[768];
+
+    // The number of components of the output format, and the positions of red and blue within a pixel. Green is always in the
+    // middle and alpha, if any, at the end.
+    uint32_t outComponents;
+    uint32_t redOffset;
+    uint32_t blueOffset;
+
+    // The palette in the output format, with each entry padded to 4 bytes so it can be copied with a single 32-bit store. This
+    // is the 16 color palette from the header for images with less than 8 bits per pixel, or the 256 color palette at the end
+    // of the file.
+    uint8_t palette[256][4];
+
+    // Maps a byte of a scanline to the palette indices of the pixels it holds, for images with less than 8 bits per pixel.
+    // The bit depth determines how many pixels a byte holds: 8, 4 or 2.
+    uint8_t unpackTable[256][8];
+
+    // The unread part of the data that's been read from the client so far. When decoding from memory these point straight
+    // into the client's buffer and onRead is NULL.
+    const uint8_t* pRead;
+    const uint8_t* pReadEnd;
+
+    // When decoding from memory, the start of the image data straight after the header.
+    const uint8_t* pImageData;
+
+    // The buffer the client's data is read into.
+    uint8_t buffer[DR_PCX_BUFFER_SIZE];
+} drpcx_decoder;
 
-static size_t drpcx__on_read_memory(void* pUserData, void* bufferOut, size_t bytesToRead)
+// Refills the buffer from the client. Returns false if there's no more data.
+static bool drpcx__refill(drpcx_decoder* pDecoder)
 {
-    drpcx_memory* memory = pUserData;
-    assert(memory != NULL);
-    assert(memory->dataSize >= memory->currentReadPos);
-
-    size_t bytesRemaining = memory->dataSize - memory->currentReadPos;
-    if (bytesToRead > bytesRemaining) {
-        bytesToRead = bytesRemaining;
+    if (pDecoder->onRead == NULL) {
+        return false;
     }
 
-    if (bytesToRead > 0) {
-        memcpy(bufferOut, memory->data + memory->currentReadPos, bytesToRead);
-        memory->currentReadPos += bytesToRead;
-    }
+    size_t bytesRead = pDecoder->onRead(pDecoder->pUserData, pDecoder->buffer, sizeof(pDecoder->buffer));
+    pDecoder->pRead = pDecoder->buffer;
+    pDecoder->pReadEnd = pDecoder->buffer + bytesRead;
 
-    return bytesToRead;
+    return bytesRead > 0;
 }
 
-drpcx* drpcx_load_memory(const void* data, size_t dataSize, bool flipped)
+// Reads <bytesToRead> bytes into <pBufferOut>. Returns the number of bytes actually read, which is only less than requested
+// at the end of the data.
+static size_t drpcx__read(drpcx_decoder* pDecoder, void* pBufferOut, size_t bytesToRead)
 {
-    drpcx_memory* pUserData = malloc(sizeof(*pUserData));
-    if (pUserData == NULL) {
-        return false;
+    uint8_t* pOut = (uint8_t*)pBufferOut;
+    size_t totalBytesRead = 0;
+
+    while (totalBytesRead < bytesToRead) {
+        if (pDecoder->pRead == pDecoder->pReadEnd && !drpcx__refill(pDecoder)) {
+            break;
+        }
+
+        size_t bytesAvailable = (size_t)(pDecoder->pReadEnd - pDecoder->pRead);
+        if (bytesAvailable > bytesToRead - totalBytesRead) {
+            bytesAvailable = bytesToRead - totalBytesRead;
+        }
+
+        memcpy(pOut + totalBytesRead, pDecoder->pRead, bytesAvailable);
+        pDecoder->pRead += bytesAvailable;
+        totalBytesRead += bytesAvailable;
     }
 
-    pUserData->data = data;
-    pUserData->dataSize = dataSize;
-    pUserData->currentReadPos = 0;
-    return drpcx_load(drpcx__on_read_memory, pUserData, flipped);
+    return totalBytesRead;
 }
 
-
-typedef struct
+static void drpcx__init_decoder_callbacks(drpcx_decoder* pDecoder, drpcx_read_proc onRead, drpcx_seek_proc onSeek, void* pUserData)
 {
-    drpcx* pPCX;
-    drpcx_read_proc onRead;
-    void* pUserData;
-    bool flipped;
+    pDecoder->onRead = onRead;
+    pDecoder->onSeek = onSeek;
+    pDecoder->pUserData = pUserData;
+    pDecoder->pRead = pDecoder->buffer;
+    pDecoder->pReadEnd = pDecoder->buffer;
+}
 
-    uint8_t* palette16;
-    uint32_t bitPlanes;
-    uint32_t bytesPerLine;
-    uint32_t stride;
-} drpcx_decoder;
+// There's no need to go through the buffer when the whole file is already in memory.
+static void drpcx__init_decoder_memory(drpcx_decoder* pDecoder, const void* pData, size_t dataSize)
+{
+    pDecoder->onRead = NULL;
+    pDecoder->onSeek = NULL;
+    pDecoder->pUserData = NULL;
+    pDecoder->pRead = (const uint8_t*)pData;
+    pDecoder->pReadEnd = (const uint8_t*)pData + dataSize;
+}
 
-static uint8_t drpcx_read_byte(drpcx_decoder* pReader)
+// Reads a single byte, returning 0 at the end of the data.
+static DRPCX_INLINE uint8_t drpcx_read_byte(drpcx_decoder* pDecoder)
 {
-    uint8_t byte = 0;
-    pReader->onRead(pReader->pUserData, &byte, 1);
+    if (pDecoder->pRead == pDecoder->pReadEnd && !drpcx__refill(pDecoder)) {
+        return 0;
+    }
 
-    return byte;
+    return *pDecoder->pRead++;
 }
 
-bool drpcx__decode_1bit(drpcx_decoder* pDecoder)
+// Decodes the next scanline into pScanline, with each plane following the previous one.
+static void drpcx__decode_scanline(drpcx_decoder* pDecoder)
 {
-    drpcx* pPCX = pDecoder->pPCX;
-    uint32_t rleCount = 0;
-    uint32_t rleValue = 0;
-    uint32_t stride = pPCX->width * pPCX->components;
+    uint8_t* pOut = pDecoder->pScanline;
+    uint8_t* pOutEnd = pOut + pDecoder->bytesPerLine*pDecoder->bitPlanes;
 
-    if (pDecoder->bitPlanes == 1)
+    while (pOut < pOutEnd)
     {
-        for (uint32_t y = 0; y < pPCX->height; ++y)
-        {
-            uint8_t* pRow = pPCX->pData;
-            if (pDecoder->flipped) {
-                pRow += (pPCX->height - y - 1) * stride;
-            } else {
-                pRow += y * stride;
+        if (pDecoder->rleCount == 0) {
+            uint8_t value = drpcx_read_byte(pDecoder);
+            if ((value & 0xC0) != 0xC0) {
+                *pOut++ = value;    // A single byte, which is by far the most common case outside of runs.
+                continue;
             }
 
-            for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
-            {
-                if (rleCount == 0) {
-                    rleValue = drpcx_read_byte(pDecoder);
-                    if ((rleValue & 0xC0) == 0xC0) {
-                        rleCount = rleValue & 0x3F;
-                        rleValue = drpcx_read_byte(pDecoder);
-                    } else {
-                        rleCount = 1;
-                    }
-                }
-
-                rleCount -= 1;
-
-                for (int bit = 0; bit < 8; ++bit)
-                {
-                    if (x*8 + bit < pPCX->width)
-                    {
-                        uint8_t mask = (1 << (7 - bit));
-                        uint8_t paletteIndex = (rleValue & mask) >> (7 - bit);
+            pDecoder->rleCount = value & 0x3F;
+            pDecoder->rleValue = drpcx_read_byte(pDecoder);
+        }
 
-                        pRow[0] = pDecoder->palette16[paletteIndex*3 + 0];
-                        pRow[1] = pDecoder->palette16[paletteIndex*3 + 1];
-                        pRow[2] = pDecoder->palette16[paletteIndex*3 + 2];
-                        pRow += pPCX->components;
-                    }
-                }
-            }
+        uint32_t count = pDecoder->rleCount;
+        if (count > (uint32_t)(pOutEnd - pOut)) {
+            count = (uint32_t)(pOutEnd - pOut);
         }
 
-        return true;
+        memset(pOut, pDecoder->rleValue, count);
+        pOut += count;
+        pDecoder->rleCount -= count;
     }
-    else
-    {
-        if (pDecoder->bitPlanes == 3 || pDecoder->bitPlanes == 4)
-        {
-            // NOTE: THIS IS WRONG.
-
-            for (uint32_t y = 0; y < pPCX->height; ++y)
-            {
-                for (uint32_t component = 0; component < pPCX->components; ++component)
-                {
-                    uint8_t* pRow = pPCX->pData;
-                    if (pDecoder->flipped) {
-                        pRow += (pPCX->height - y - 1) * stride;
-                    } else {
-                        pRow += y * stride;
-                    }
-
-                    for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
-                    {
-                        if (rleCount == 0) {
-                            rleValue = drpcx_read_byte(pDecoder);
-                            if ((rleValue & 0xC0) == 0xC0) {
-                                rleCount = rleValue & 0x3F;
-                                rleValue = drpcx_read_byte(pDecoder);
-                            } else {
-                                rleCount = 1;
-                            }
-                        }
-
-                        rleCount -= 1;
-
-                        for (int bit = 0; bit < 8; ++bit)
-                        {
-                            if (x*8 + bit < pPCX->width)
-                            {
-                                uint8_t mask = (1 << (7 - bit));
-                                uint8_t paletteIndex = (rleValue & mask) >> (7 - bit);
-
-                                pRow[component] = pDecoder->palette16[paletteIndex*3 + component];
-                                pRow += pPCX->components;
-                            }
-                        }
-                    }
-                }
-            }
+}
 
-            return true;
+// Converts the scanline to one palette index per pixel for images with less than 8 bits per pixel. Each byte of each plane is
+// expanded with a table lookup and the planes are combined by shifting each into its own bit of the index. The table entries
+// are 8 bytes no matter how many pixels they hold so they can be combined as 64-bit integers.
+static void drpcx__unpack_indices(drpcx_decoder* pDecoder)
+{
+    uint32_t pixelsPerByte = 8 / pDecoder->bpp;
+    for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
+    {
+        uint64_t indices = 0;
+        for (uint32_t plane = 0; plane < pDecoder->bitPlanes; ++plane) {
+            uint64_t bits;
+            memcpy(&bits, pDecoder->unpackTable[pDecoder->pScanline[plane*pDecoder->bytesPerLine + x]], 8);
+            indices |= bits << plane;
         }
-    }
 
-    return false;
+        memcpy(pDecoder->pIndices + x*pixelsPerByte, &indices, 8);
+    }
 }
 
-bool drpcx__decode_2bit(drpcx_decoder* pDecoder)
+// Looks up <count> palette indices and writes them out. The palette entries are already in the output format, padded to 4
+// bytes. For 3 component formats each pixel is still written with a single 4-byte copy, with the next pixel overwriting the
+// padding, so the last one is done separately to not write past the end.
+static void drpcx__expand_palette(const uint8_t palette[][4], const uint8_t* pIndices, uint32_t count, uint32_t components, uint8_t* pOut)
 {
-    drpcx* pPCX = pDecoder->pPCX;
-    uint32_t rleCount = 0;
-    uint32_t rleValue = 0;
-    uint32_t stride = pPCX->width * pPCX->components;
+    if (count == 0) {
+        return;
+    }
 
-    if (pDecoder->bitPlanes == 1)
-    {
-        // NOTE: THIS IS WRONG. I think the palette needs to be converted to CGA, but I'm not fully sure.
-
-        for (uint32_t y = 0; y < pPCX->height; ++y)
-        {
-            uint8_t* pRow = pPCX->pData;
-            if (pDecoder->flipped) {
-                pRow += (pPCX->height - y - 1) * stride;
-            } else {
-                pRow += y * stride;
-            }
+    for (uint32_t x = 0; x < count-1; ++x) {
+        memcpy(pOut, palette[*pIndices++], 4);
+        pOut += components;
+    }
 
-            for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
-            {
-                if (rleCount == 0) {
-                    rleValue = drpcx_read_byte(pDecoder);
-                    if ((rleValue & 0xC0) == 0xC0) {
-                        rleCount = rleValue & 0x3F;
-                        rleValue = drpcx_read_byte(pDecoder);
-                    } else {
-                        rleCount = 1;
-                    }
-                }
+    memcpy(pOut, palette[*pIndices], components);
+}
 
-                rleCount -= 1;
+// Sets palette entry <index> from an RGB triple, converting it to the output format.
+static void drpcx__set_palette_entry(drpcx_decoder* pDecoder, uint32_t index, const uint8_t* pRGB)
+{
+    pDecoder->palette[index][pDecoder->redOffset]  = pRGB[0];
+    pDecoder->palette[index][1]                    = pRGB[1];
+    pDecoder->palette[index][pDecoder->blueOffset] = pRGB[2];
+    pDecoder->palette[index][3]                    = 0xFF;
+}
 
-                for (int bit = 0; bit < 4; ++bit)
-                {
-                    if (x*4 + bit < pPCX->width)
-                    {
-                        uint8_t mask = (3 << ((3 - bit) * 2));
-                        uint8_t paletteIndex = (rleValue & mask) >> ((3 - bit) * 2);
+// Decodes the next row of the image into <pRow>, which receives width pixels in the output format. 8-bit single plane images
+// are output as grayscale unless the palette has been read ahead, in which case the caller needs to look up the palette once
+// all rows are done.
+static void drpcx__decode_row(drpcx_decoder* pDecoder, uint8_t* pRow)
+{
+    drpcx__decode_scanline(pDecoder);
+
+    const uint8_t* pLine = pDecoder->pScanline;
+    const uint8_t* pRed   = pLine;
+    const uint8_t* pGreen = pLine + pDecoder->bytesPerLine;
+    const uint8_t* pBlue  = pLine + pDecoder->bytesPerLine*2;
+    const uint8_t* pAlpha = pLine + pDecoder->bytesPerLine*3;
+    uint32_t width = pDecoder->width;
+    uint32_t components = pDecoder->outComponents;
+    uint32_t r = pDecoder->redOffset;
+    uint32_t b = pDecoder->blueOffset;
+
+    if (pDecoder->bpp < 8) {
+        drpcx__unpack_indices(pDecoder);
+        drpcx__expand_palette((const uint8_t (*)[4])pDecoder->palette, pDecoder->pIndices, width, components, pRow);
+        return;
+    }
 
-                        pRow[0] = pDecoder->palette16[paletteIndex*3 + 0];
-                        pRow[1] = pDecoder->palette16[paletteIndex*3 + 1];
-                        pRow[2] = pDecoder->palette16[paletteIndex*3 + 2];
-                        pRow += 3;
-                    }
-                }
-            }
+    if (pDecoder->bitPlanes == 1) {
+        if (pDecoder->hasPalette256) {
+            drpcx__expand_palette((const uint8_t (*)[4])pDecoder->palette, pLine, width, components, pRow);
+            return;
         }
 
-        return true;
+        pGreen = pLine;
+        pBlue  = pLine;
     }
 
-    return false;
+    if (components == 3) {
+        for (uint32_t x = 0; x < width; ++x) {
+            pRow[r] = pRed[x];
+            pRow[1] = pGreen[x];
+            pRow[b] = pBlue[x];
+            pRow += 3;
+        }
+    } else if (pDecoder->bitPlanes == 4) {
+        for (uint32_t x = 0; x < width; ++x) {
+            pRow[r] = pRed[x];
+            pRow[1] = pGreen[x];
+            pRow[b] = pBlue[x];
+            pRow[3] = pAlpha[x];
+            pRow += 4;
+        }
+    } else {
+        for (uint32_t x = 0; x < width; ++x) {
+            pRow[r] = pRed[x];
+            pRow[1] = pGreen[x];
+            pRow[b] = pBlue[x];
+            pRow[3] = 0xFF;
+            pRow += 4;
+        }
+    }
 }
 
-bool drpcx__decode_4bit(drpcx_decoder* pDecoder)
+// Goes back to the start of the image data, straight after the header. Returns false if the data can't be seeked.
+static bool drpcx__rewind_to_image_data(drpcx_decoder* pDecoder)
 {
-    drpcx* pPCX = pDecoder->pPCX;
-    uint32_t rleCount = 0;
-    uint32_t rleValue = 0;
-    uint32_t stride = pPCX->width * pPCX->components;
+    if (pDecoder->onRead == NULL) {
+        pDecoder->pRead = pDecoder->pImageData;
+        return true;
+    }
+
+    if (pDecoder->onSeek == NULL || !pDecoder->onSeek(pDecoder->pUserData, 128, drpcx_seek_origin_start)) {
+        return false;
+    }
 
-    // TODO: Implement me.
-    return false;
+    // Anything that's been buffered is from somewhere else.
+    pDecoder->pRead = pDecoder->buffer;
+    pDecoder->pReadEnd = pDecoder->buffer;
+    return true;
 }
 
-bool drpcx__decode_8bit(drpcx_decoder* pDecoder)
+// The 256 color palette of 8-bit images follows the image data, marked with 0x0C. Reading it before the image data, when
+// that's possible, means each row can be output in its final colors as it's decoded. Returns false if the data couldn't be
+// put back to where it was.
+//
+// This only looks at the last 769 bytes of the file, so a grayscale image can happen to have 0x0C in the right place. The
+// full image loaders check that the marker really follows the image data once the rows are decoded.
+static bool drpcx__read_palette256_ahead(drpcx_decoder* pDecoder)
 {
-    drpcx* pPCX = pDecoder->pPCX;
-    uint32_t rleCount = 0;
-    uint32_t rleValue = 0;
-    uint32_t stride = pPCX->width * pPCX->components;
+    uint8_t palette[769];
 
-    if (pDecoder->bitPlanes == 3 || pDecoder->bitPlanes == 4)
-    {
-        for (uint32_t y = 0; y < pPCX->height; ++y)
-        {
-            for (uint32_t component = 0; component < pPCX->components; ++component)
-            {
-                uint8_t* pRow = pPCX->pData;
-                if (pDecoder->flipped) {
-                    pRow += (pPCX->height - y - 1) * stride;
-                } else {
-                    pRow += y * stride;
-                }
+    if (pDecoder->onRead == NULL) {
+        // Decoding from memory, so the end of the data is right there. There's no palette if there isn't room for one.
+        pDecoder->isPalette256Known = true;
+        if ((size_t)(pDecoder->pReadEnd - pDecoder->pRead) < sizeof(palette)) {
+            return true;
+        }
 
-                for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
-                {
-                    if (rleCount == 0) {
-                        rleValue = drpcx_read_byte(pDecoder);
-                        if ((rleValue & 0xC0) == 0xC0) {
-                            rleCount = rleValue & 0x3F;
-                            rleValue = drpcx_read_byte(pDecoder);
-                        } else {
-                            rleCount = 1;
-                        }
-                    }
-
-                    rleCount -= 1;
-
-                    if (x < pPCX->width) {
-                        pRow[component] = rleValue;
-                        pRow += pPCX->components;
-                    }
-                }
-            }
+        memcpy(palette, pDecoder->pReadEnd - sizeof(palette), sizeof(palette));
+    } else {
+        if (pDecoder->onSeek == NULL) {
+            return true;
         }
-    }
-    else
-    {
-        for (uint32_t y = 0; y < pPCX->height; ++y)
-        {
-            uint8_t* pRow = pPCX->pData;
-            if (pDecoder->flipped) {
-                pRow += (pPCX->height - y - 1) * stride;
-            } else {
-                pRow += y * stride;
-            }
 
-            for (uint32_t x = 0; x < pDecoder->bytesPerLine; ++x)
-            {
-                if (rleCount == 0) {
-                    rleValue = drpcx_read_byte(pDecoder);
-                    if ((rleValue & 0xC0) == 0xC0) {
-                        rleCount = rleValue & 0x3F;
-                        rleValue = drpcx_read_byte(pDecoder);
-                    } else {
-                        rleCount = 1;
-                    }
-                }
+        if (!pDecoder->onSeek(pDecoder->pUserData, -(int64_t)sizeof(palette), drpcx_seek_origin_end)) {
+            // Either the data can't be seeked after all, or it's too short to have a palette. If it can be seeked back to the
+            // image data it's the latter.
+            if (!drpcx__rewind_to_image_data(pDecoder)) {
+                return true;
+            }
 
-                rleCount -= 1;
+            pDecoder->isPalette256Known = true;
+            return true;
+        }
 
-                if (x < pPCX->width) {
-                    pRow[0] = rleValue;
-                    pRow[1] = rleValue;
-                    pRow[2] = rleValue;
-                    pRow += 3;
-                }
+        size_t bytesRead = 0;
+        while (bytesRead < sizeof(palette)) {
+            size_t bytesJustRead = pDecoder->onRead(pDecoder->pUserData, palette + bytesRead, sizeof(palette) - bytesRead);
+            if (bytesJustRead == 0) {
+                break;
             }
+            bytesRead += bytesJustRead;
         }
 
-        // At this point we can know if we are dealing with a palette or a grayscale image by checking the next byte. If ti's equal to 0x0C, we
-        // need to do a simple palette lookup.
-        uint8_t paletteMarker = drpcx_read_byte(pDecoder);
-        if (paletteMarker == 0x0C)
-        {
-            // A palette is present - we need to do a second pass.
-            uint8_t palette256[768];
-            if (pDecoder->onRead(pDecoder->pUserData, palette256, sizeof(palette256)) != sizeof(palette256)) {
-                free(pPCX);
-                return false;
-            }
+        if (!drpcx__rewind_to_image_data(pDecoder)) {
+            return false;
+        }
 
-            for (uint32_t y = 0; y < pPCX->height; ++y)
-            {
-                uint8_t* pRow = pPCX->pData + (y * stride);
-
-                for (uint32_t x = 0; x < pPCX->width; ++x)
-                {
-                    uint8_t index = pRow[0];
-                    pRow[0] = palette256[index*3 + 0];
-                    pRow[1] = palette256[index*3 + 1];
-                    pRow[2] = palette256[index*3 + 2];
-                    pRow += 3;
-                }
-            }
+        pDecoder->isPalette256Known = true;
+        if (bytesRead < sizeof(palette)) {
+            return true;
         }
     }
 
+    pDecoder->hasPalette256 = (palette[0] == 0x0C);
+    memcpy(pDecoder->palette256, palette + 1, sizeof(pDecoder->palette256));
     return true;
 }
 
-drpcx* drpcx_load(drpcx_read_proc onRead, void* pUserData, bool flipped)
+// Validates the 128 byte header and retrieves the format of the image. <pBytesPerLine> receives the size of each plane of a
+// scanline.
+static bool drpcx__parse_header(const uint8_t* header, drpcx_image_info* pInfo, uint32_t* pBytesPerLine)
 {
-    if (onRead == NULL) {
-        return NULL;
-    }
-
-    // The first thing to do when loading is to find the dimensions and component count. Once we've done that we can figure
-    // out how much memory to allocate.
-    unsigned char header[128];
-    if (onRead(pUserData, header, sizeof(header)) != sizeof(header)) {
-        return NULL;    // Failed to read the header.
-    }
-
     if (header[0] != 10) {
-        return NULL;    // Not a PCX file.
+        return false;   // Not a PCX file.
     }
 
-    //uint8_t version = header[1];    // Unused.
-
     uint8_t encoding = header[2];
     if (encoding != 1) {
-        return NULL;    // Not supporting non-RLE encoding. Would assume a value of 0 indicates raw, unencoded, but that is apparently never used.
+        return false;   // Not supporting non-RLE encoding. Would assume a value of 0 indicates raw, unencoded, but that is apparently never used.
     }
 
     uint8_t bpp = header[3];
-    if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) {
-        return NULL;    // Unsupported bits per pixel.
-    }
-
     uint16_t left   = (header[ 5] << 8) | (header[ 4] << 0);
     uint16_t top    = (header[ 7] << 8) | (header[ 6] << 0);
     uint16_t right  = (header[ 9] << 8) | (header[ 8] << 0);
     uint16_t bottom = (header[11] << 8) | (header[10] << 0);
-    uint8_t* palette16 = header + 16;
     uint8_t bitPlanes = header[65];
     uint16_t bytesPerLine = (header[67] << 8) | (header[66] << 0);
 
-    uint32_t components = (bitPlanes == 1/* || bpp == 1*/) ? 3 : bitPlanes;
+    // The supported formats are 8-bit with 1 (palette or grayscale), 3 (RGB) or 4 (RGBA) planes, 1-bit with up to 4 planes,
+    // which covers monochrome and the 8 and 16 color EGA formats, and 2- and 4-bit with a single plane.
+    if (bpp == 8) {
+        if (bitPlanes != 1 && bitPlanes != 3 && bitPlanes != 4) {
+            return false;
+        }
+    } else if (bpp == 1) {
+        if (bitPlanes < 1 || bitPlanes > 4) {
+            return false;
+        }
+    } else if (bpp == 2 || bpp == 4) {
+        if (bitPlanes != 1) {
+            return false;
+        }
+    } else {
+        return false;   // Unsupported bits per pixel.
+    }
+
+    if (right < left || bottom < top) {
+        return false;
+    }
 
-    uint32_t width    = right - left + 1;
-    uint32_t height   = bottom - top + 1;
-    uint32_t dataSize = width * height * components;
+    uint32_t width = right - left + 1;
+    if ((uint32_t)bytesPerLine*8 < width*bpp) {
+        return false;   // The scanlines are too short for the width of the image.
+    }
 
-    drpcx* pPCX = malloc(sizeof(*pPCX) - sizeof(pPCX->pData) + dataSize);
-    if (pPCX == NULL) {
-        return NULL;
+    pInfo->width = width;
+    pInfo->height = bottom - top + 1;
+    pInfo->bitsPerPixel = bpp;
+    pInfo->bitPlanes = bitPlanes;
+    pInfo->components = (bpp == 8 && bitPlanes == 4) ? 4 : 3;
+    *pBytesPerLine = bytesPerLine;
+    return true;
+}
+
+// Reads and validates the header, and sets up the decoder for the image it describes.
+static bool drpcx__read_header(drpcx_decoder* pDecoder)
+{
+    uint8_t header[128];
+    if (drpcx__read(pDecoder, header, sizeof(header)) != sizeof(header)) {
+        return false;   // Failed to read the header.
     }
 
-    pPCX->width      = width;
-    pPCX->height     = height;
-    pPCX->components = components;
+    drpcx_image_info info;
+    if (!drpcx__parse_header(header, &info, &pDecoder->bytesPerLine)) {
+        return false;
+    }
 
-    drpcx_decoder decoder;
-    decoder.pPCX = pPCX;
-    decoder.onRead = onRead;
-    decoder.pUserData = pUserData;
-    decoder.flipped = flipped;
-    decoder.palette16 = palette16;
-    decoder.bitPlanes = bitPlanes;
-    decoder.bytesPerLine = bytesPerLine;
-
-    switch (bpp)
+    pDecoder->width = info.width;
+    pDecoder->height = info.height;
+    pDecoder->bpp = info.bitsPerPixel;
+    pDecoder->bitPlanes = info.bitPlanes;
+    pDecoder->rleCount = 0;
+    pDecoder->rleValue = 0;
+    memcpy(pDecoder->palette16, header + 16, sizeof(pDecoder->palette16));
+    pDecoder->pImageData = pDecoder->pRead;
+
+    // Only version 5 files have a 256 color palette, and not when the palette info says the image is grayscale.
+    uint8_t version = header[1];
+    uint16_t paletteInfo = (header[69] << 8) | (header[68] << 0);
+
+    pDecoder->isPalette256Expected = info.bitsPerPixel == 8 && info.bitPlanes == 1 && version == 5 && paletteInfo != 2;
+    pDecoder->isPalette256Known = false;
+    pDecoder->hasPalette256 = false;
+    if (pDecoder->isPalette256Expected) {
+        return drpcx__read_palette256_ahead(pDecoder);
+    }
+
+    return true;
+}
+
+// Gets the decoder ready to decode rows in the given format, once the header has been read.
+static bool drpcx__begin_decode(drpcx_decoder* pDecoder, drpcx_format format)
+{
+    uint32_t bpp = pDecoder->bpp;
+
+    pDecoder->outComponents = (format == drpcx_format_rgb8) ? 3 : 4;
+    pDecoder->redOffset  = (format == drpcx_format_bgra8) ? 2 : 0;
+    pDecoder->blueOffset = (format == drpcx_format_bgra8) ? 0 : 2;
+
+    if (bpp < 8) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            drpcx__set_palette_entry(pDecoder, i, pDecoder->palette16 + i*3);
+        }
+
+        // Pixels are stored from the most significant bits down.
+        uint32_t pixelsPerByte = 8 / bpp;
+        uint32_t mask = (1U << bpp) - 1;
+        for (uint32_t i = 0; i < 256; ++i) {
+            memset(pDecoder->unpackTable[i], 0, 8);
+            for (uint32_t j = 0; j < pixelsPerByte; ++j) {
+                pDecoder->unpackTable[i][j] = (uint8_t)((i >> ((pixelsPerByte - j - 1) * bpp)) & mask);
+            }
+        }
+    }
+
+    if (pDecoder->hasPalette256) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            drpcx__set_palette_entry(pDecoder, i, pDecoder->palette256 + i*3);
+        }
+    }
+
+    // The scanline and the palette indices share an allocation. The indices are written 8 at a time so they're padded. For
+    // 8-bit images the indices are used for a row of the 256 color palette lookup.
+    size_t scanlineSize = (size_t)pDecoder->bytesPerLine * pDecoder->bitPlanes;
+    pDecoder->pScanline = (uint8_t*)malloc(scanlineSize + (size_t)pDecoder->bytesPerLine*8 + 8);
+    if (pDecoder->pScanline == NULL) {
+        return false;
+    }
+    pDecoder->pIndices = pDecoder->pScanline + scanlineSize;
+
+    return true;
+}
+
+static void drpcx__end_decode(drpcx_decoder* pDecoder)
+{
+    free(pDecoder->pScanline);
+    pDecoder->pScanline = NULL;
+}
+
+// Decodes the image described by the header that's just been read into <pOut> in the given format.
+static bool drpcx__decode(drpcx_decoder* pDecoder, uint8_t* pOut, size_t outStride, drpcx_format format, bool flipped)
+{
+    uint32_t width = pDecoder->width;
+    uint32_t height = pDecoder->height;
+
+    if (!drpcx__begin_decode(pDecoder, format)) {
+        return false;
+    }
+
+    for (uint32_t y = 0; y < height; ++y) {
+        drpcx__decode_row(pDecoder, pOut + (flipped ? (height - y - 1) : y) * outStride);
+    }
+
+    // A palette that's been read ahead only counts if its marker is straight after the image data. If it isn't, the image is
+    // grayscale after all and is decoded again without it.
+    if (pDecoder->hasPalette256 && drpcx_read_byte(pDecoder) != 0x0C)
+    {
+        if (!drpcx__rewind_to_image_data(pDecoder)) {
+            drpcx__end_decode(pDecoder);
+            return false;
+        }
+
+        pDecoder->hasPalette256 = false;
+        pDecoder->rleCount = 0;
+        pDecoder->rleValue = 0;
+        for (uint32_t y = 0; y < height; ++y) {
+            drpcx__decode_row(pDecoder, pOut + (flipped ? (height - y - 1) : y) * outStride);
+        }
+    }
+
+    // When the palette of an 8-bit single plane image couldn't be read ahead, the image is either grayscale, in which case
+    // we're done, or has the 256 color palette straight after the image data. The gray value in each pixel is its palette
+    // index.
+    if (pDecoder->bpp == 8 && pDecoder->bitPlanes == 1 && !pDecoder->isPalette256Known && drpcx_read_byte(pDecoder) == 0x0C)
     {
-        case 1:
-        {
-            drpcx__decode_1bit(&decoder);
-        } break;
+        if (drpcx__read(pDecoder, pDecoder->palette256, sizeof(pDecoder->palette256)) != sizeof(pDecoder->palette256)) {
+            drpcx__end_decode(pDecoder);
+            return false;
+        }
 
-        case 2:
-        {
-            drpcx__decode_2bit(&decoder);
-        } break;
+        for (uint32_t i = 0; i < 256; ++i) {
+            drpcx__set_palette_entry(pDecoder, i, pDecoder->palette256 + i*3);
+        }
 
-        case 4:
-        {
-            drpcx__decode_4bit(&decoder);
-        } break;
+        // Each pixel's palette entry overwrites the index of the next pixel, so the indices of a row are gathered first.
+        uint32_t components = pDecoder->outComponents;
+        for (uint32_t y = 0; y < height; ++y) {
+            uint8_t* pRow = pOut + y*outStride;
+            for (uint32_t x = 0; x < width; ++x) {
+                pDecoder->pIndices[x] = pRow[x*components];
+            }
 
-        case 8:
-        {
-            drpcx__decode_8bit(&decoder);
-        } break;
+            drpcx__expand_palette((const uint8_t (*)[4])pDecoder->palette, pDecoder->pIndices, width, components, pRow);
+        }
     }
 
-    return pPCX;
+    drpcx__end_decode(pDecoder);
+    return true;
 }
 
-void drpcx_delete(drpcx* pPCX)
+// Loads the image from a decoder that's been set up to read from either the client's callbacks or memory.
+static drpcx* drpcx__load(drpcx_decoder* pDecoder, bool flipped)
 {
-    free(pPCX);
+    // The first thing to do when loading is to find the dimensions and component count. Once we've done that we can figure
+    // out how much memory to allocate.
+    if (!drpcx__read_header(pDecoder)) {
+        return NULL;
+    }
+
+    uint32_t components = (pDecoder->bpp == 8 && pDecoder->bitPlanes == 4) ? 4 : 3;
+    size_t stride = (size_t)pDecoder->width * components;
+
+    drpcx* pPCX = (drpcx*)malloc(sizeof(*pPCX) - sizeof(pPCX->pData) + stride*pDecoder->height);
+    if (pPCX == NULL) {
+        return NULL;
+    }
+
+    pPCX->width      = pDecoder->width;
+    pPCX->height     = pDecoder->height;
+    pPCX->components = components;
+
+    if (!drpcx__decode(pDecoder, (uint8_t*)pPCX->pData, stride, (components == 4) ? drpcx_format_rgba8 : drpcx_format_rgb8, flipped)) {
+        free(pPCX);
+        return NULL;
+    }
+
+    return pPCX;
+}
+
+// Decodes the image from a decoder that's been set up to read from either the client's callbacks or memory into the client's
+// buffer.
+static bool drpcx__load_into(drpcx_decoder* pDecoder, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped)
+{
+    if (!drpcx__read_header(pDecoder)) {
+        return false;
+    }
+
+    if (pDecoder->width > outWidth || pDecoder->height > outHeight) {
+        return false;   // The image doesn't fit.
+    }
+
+    size_t components = (format == drpcx_format_rgb8) ? 3 : 4;
+    if (outStride < outWidth*components) {
+        return false;
+    }
+
+    return drpcx__decode(pDecoder, (uint8_t*)pOut, outStride, format, flipped);
+}
+
+drpcx* drpcx_load(drpcx_read_proc onRead, void* pUserData, bool flipped)
+{
+    if (onRead == NULL) {
+        return NULL;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_callbacks(&decoder, onRead, NULL, pUserData);
+    return drpcx__load(&decoder, flipped);
+}
+
+drpcx* drpcx_load_memory(const void* data, size_t dataSize, bool flipped)
+{
+    if (data == NULL) {
+        return NULL;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_memory(&decoder, data, dataSize);
+    return drpcx__load(&decoder, flipped);
+}
+
+bool drpcx_load_into(drpcx_read_proc onRead, void* pUserData, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped)
+{
+    if (onRead == NULL || pOut == NULL) {
+        return false;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_callbacks(&decoder, onRead, NULL, pUserData);
+    return drpcx__load_into(&decoder, pOut, outWidth, outHeight, outStride, format, flipped);
+}
+
+bool drpcx_load_memory_into(const void* data, size_t dataSize, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped)
+{
+    if (data == NULL || pOut == NULL) {
+        return false;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_memory(&decoder, data, dataSize);
+    return drpcx__load_into(&decoder, pOut, outWidth, outHeight, outStride, format, flipped);
+}
+
+bool drpcx_info(drpcx_read_proc onRead, void* pUserData, drpcx_image_info* pInfoOut)
+{
+    if (onRead == NULL || pInfoOut == NULL) {
+        return false;
+    }
+
+    // This doesn't go through a decoder since its buffer would read more than just the header.
+    uint8_t header[128];
+    size_t bytesRead = 0;
+    while (bytesRead < sizeof(header)) {
+        size_t bytesJustRead = onRead(pUserData, header + bytesRead, sizeof(header) - bytesRead);
+        if (bytesJustRead == 0) {
+            return false;
+        }
+        bytesRead += bytesJustRead;
+    }
+
+    uint32_t bytesPerLine;
+    return drpcx__parse_header(header, pInfoOut, &bytesPerLine);
+}
+
+bool drpcx_info_memory(const void* data, size_t dataSize, drpcx_image_info* pInfoOut)
+{
+    if (data == NULL || dataSize < 128 || pInfoOut == NULL) {
+        return false;
+    }
+
+    uint32_t bytesPerLine;
+    return drpcx__parse_header((const uint8_t*)data, pInfoOut, &bytesPerLine);
+}
+
+#ifndef DR_PCX_NO_STDIO
+bool drpcx_info_file(const char* filename, drpcx_image_info* pInfoOut)
+{
+    if (pInfoOut == NULL) {
+        return false;
+    }
+
+    FILE* pFile = drpcx__fopen(filename);
+    if (pFile == NULL) {
+        return false;
+    }
+
+    bool result = drpcx_info(drpcx__on_read_stdio, pFile, pInfoOut);
+
+    fclose(pFile);
+    return result;
+}
+
+drpcx* drpcx_load_file(const char* filename, bool flipped)
+{
+    FILE* pFile = drpcx__fopen(filename);
+    if (pFile == NULL) {
+        return NULL;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_callbacks(&decoder, drpcx__on_read_stdio, drpcx__on_seek_stdio, pFile);
+    drpcx* pPCX = drpcx__load(&decoder, flipped);
+
+    fclose(pFile);
+    return pPCX;
+}
+
+bool drpcx_load_file_into(const char* filename, void* pOut, unsigned int outWidth, unsigned int outHeight, size_t outStride, drpcx_format format, bool flipped)
+{
+    if (pOut == NULL) {
+        return false;
+    }
+
+    FILE* pFile = drpcx__fopen(filename);
+    if (pFile == NULL) {
+        return false;
+    }
+
+    drpcx_decoder decoder;
+    drpcx__init_decoder_callbacks(&decoder, drpcx__on_read_stdio, drpcx__on_seek_stdio, pFile);
+    bool result = drpcx__load_into(&decoder, pOut, outWidth, outHeight, outStride, format, flipped);
+
+    fclose(pFile);
+    return result;
+}
+#endif  // DR_PCX_NO_STDIO
+
+
+void drpcx_delete(drpcx* pPCX)
+{
+    free(pPCX);
+}
+
+
+
+typedef struct
+{
+    drpcx_stream stream;
+    drpcx_decoder decoder;
+
+    // The row handed to the callback of drpcx_read_rows(). This is only allocated when that's used.
+    uint8_t* pRow;
+
+    // Whether or not the stream was opened with drpcx_open_file() and needs to close the file.
+    bool ownsFile;
+} drpcx__stream;
+
+// Finishes opening a stream whose decoder has been set up to read from the client's callbacks or memory.
+static drpcx_stream* drpcx__open(drpcx__stream* pStream, drpcx_format format)
+{
+    drpcx_decoder* pDecoder = &pStream->decoder;
+
+    if (!drpcx__read_header(pDecoder)) {
+        return NULL;
+    }
+
+    // 8-bit single plane images can only be output in order when the palette has been read ahead, or when the header says
+    // there isn't one. Unlike the full image loaders, rows have already been handed out by the time the marker after the
+    // image data could be checked, so the end of the file is trusted.
+    if (pDecoder->bpp == 8 && pDecoder->bitPlanes == 1 && !pDecoder->isPalette256Known) {
+        if (pDecoder->isPalette256Expected) {
+            return NULL;
+        }
+
+        pDecoder->isPalette256Known = true;
+    }
+
+    if (!drpcx__begin_decode(pDecoder, format)) {
+        return NULL;
+    }
+
+    pStream->stream.width = pDecoder->width;
+    pStream->stream.height = pDecoder->height;
+    pStream->stream.format = format;
+    pStream->stream.components = pDecoder->outComponents;
+    pStream->stream.nextRow = 0;
+    pStream->pRow = NULL;
+    pStream->ownsFile = false;
+    return &pStream->stream;
+}
+
+drpcx_stream* drpcx_open(drpcx_read_proc onRead, drpcx_seek_proc onSeek, void* pUserData, drpcx_format format)
+{
+    if (onRead == NULL) {
+        return NULL;
+    }
+
+    drpcx__stream* pStream = (drpcx__stream*)malloc(sizeof(*pStream));
+    if (pStream == NULL) {
+        return NULL;
+    }
+
+    drpcx__init_decoder_callbacks(&pStream->decoder, onRead, onSeek, pUserData);
+    if (drpcx__open(pStream, format) == NULL) {
+        free(pStream);
+        return NULL;
+    }
+
+    return &pStream->stream;
+}
+
+#ifndef DR_PCX_NO_STDIO
+drpcx_stream* drpcx_open_file(const char* filename, drpcx_format format)
+{
+    FILE* pFile = drpcx__fopen(filename);
+    if (pFile == NULL) {
+        return NULL;
+    }
+
+    drpcx_stream* pStream = drpcx_open(drpcx__on_read_stdio, drpcx__on_seek_stdio, pFile, format);
+    if (pStream == NULL) {
+        fclose(pFile);
+        return NULL;
+    }
+
+    ((drpcx__stream*)pStream)->ownsFile = true;
+    return pStream;
+}
+#endif
+
+drpcx_stream* drpcx_open_memory(const void* data, size_t dataSize, drpcx_format format)
+{
+    if (data == NULL) {
+        return NULL;
+    }
+
+    drpcx__stream* pStream = (drpcx__stream*)malloc(sizeof(*pStream));
+    if (pStream == NULL) {
+        return NULL;
+    }
+
+    drpcx__init_decoder_memory(&pStream->decoder, data, dataSize);
+    if (drpcx__open(pStream, format) == NULL) {
+        free(pStream);
+        return NULL;
+    }
+
+    return &pStream->stream;
+}
+
+void drpcx_close(drpcx_stream* pStream)
+{
+    if (pStream == NULL) {
+        return;
+    }
+
+    drpcx__stream* pInternalStream = (drpcx__stream*)pStream;
+    drpcx__end_decode(&pInternalStream->decoder);
+
+#ifndef DR_PCX_NO_STDIO
+    if (pInternalStream->ownsFile) {
+        fclose((FILE*)pInternalStream->decoder.pUserData);
+    }
+#endif
+
+    free(pInternalStream->pRow);
+    free(pInternalStream);
+}
+
+bool drpcx_read_row(drpcx_stream* pStream, void* pRowOut)
+{
+    if (pStream == NULL || pRowOut == NULL || pStream->nextRow == pStream->height) {
+        return false;
+    }
+
+    drpcx__decode_row(&((drpcx__stream*)pStream)->decoder, (uint8_t*)pRowOut);
+    pStream->nextRow += 1;
+    return true;
+}
+
+bool drpcx_read_rows(drpcx_stream* pStream, drpcx_row_proc onRow, void* pUserData)
+{
+    if (pStream == NULL || onRow == NULL) {
+        return false;
+    }
+
+    drpcx__stream* pInternalStream = (drpcx__stream*)pStream;
+    if (pInternalStream->pRow == NULL) {
+        pInternalStream->pRow = (uint8_t*)malloc((size_t)pStream->width * pStream->components);
+        if (pInternalStream->pRow == NULL) {
+            return false;
+        }
+    }
+
+    while (pStream->nextRow < pStream->height) {
+        unsigned int row = pStream->nextRow;
+        drpcx_read_row(pStream, pInternalStream->pRow);
+        if (!onRow(pUserData, row, pInternalStream->pRow)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+static void drpcx__load_batch_item(drpcx_batch_item* pItem)
+{
+    drpcx_decoder decoder;
+#ifndef DR_PCX_NO_STDIO
+    FILE* pFile = NULL;
+#endif
+
+    pItem->pPCX = NULL;
+    pItem->succeeded = false;
+
+    if (pItem->pFilePath != NULL) {
+#ifndef DR_PCX_NO_STDIO
+        pFile = drpcx__fopen(pItem->pFilePath);
+        if (pFile == NULL) {
+            return;
+        }
+
+        drpcx__init_decoder_callbacks(&decoder, drpcx__on_read_stdio, drpcx__on_seek_stdio, pFile);
+#else
+        return;
+#endif
+    } else {
+        if (pItem->pData == NULL) {
+            return;
+        }
+
+        drpcx__init_decoder_memory(&decoder, pItem->pData, pItem->dataSize);
+    }
+
+    if (pItem->pOut == NULL) {
+        pItem->pPCX = drpcx__load(&decoder, pItem->flipped);
+        pItem->succeeded = (pItem->pPCX != NULL);
+    } else {
+        pItem->succeeded = drpcx__load_into(&decoder, pItem->pOut, pItem->outWidth, pItem->outHeight, pItem->outStride, pItem->format, pItem->flipped);
+    }
+
+#ifndef DR_PCX_NO_STDIO
+    if (pFile != NULL) {
+        fclose(pFile);
+    }
+#endif
+}
+
+#ifdef DRPCX_HAS_THREADS
+// The state shared by the threads of a drpcx_load_batch() call. Each thread takes the next image that hasn't been taken
+// until there are none left, so threads that get small images just take more of them.
+typedef struct
+{
+    drpcx_batch_item* pItems;
+    size_t itemCount;
+    size_t nextItem;
+
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} drpcx__batch;
+
+#ifdef _WIN32
+static void drpcx__batch_lock(drpcx__batch* pBatch)   { EnterCriticalSection(&pBatch->lock); }
+static void drpcx__batch_unlock(drpcx__batch* pBatch) { LeaveCriticalSection(&pBatch->lock); }
+#else
+static void drpcx__batch_lock(drpcx__batch* pBatch)   { pthread_mutex_lock(&pBatch->lock); }
+static void drpcx__batch_unlock(drpcx__batch* pBatch) { pthread_mutex_unlock(&pBatch->lock); }
+#endif
+
+static void drpcx__batch_thread(drpcx__batch* pBatch)
+{
+    for (;;) {
+        drpcx__batch_lock(pBatch);
+        size_t index = pBatch->nextItem;
+        if (index < pBatch->itemCount) {
+            pBatch->nextItem += 1;
+        }
+        drpcx__batch_unlock(pBatch);
+
+        if (index == pBatch->itemCount) {
+            break;
+        }
+
+        drpcx__load_batch_item(&pBatch->pItems[index]);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI drpcx__batch_thread_win32(LPVOID pUserData)
+{
+    drpcx__batch_thread((drpcx__batch*)pUserData);
+    return 0;
+}
+#else
+static void* drpcx__batch_thread_posix(void* pUserData)
+{
+    drpcx__batch_thread((drpcx__batch*)pUserData);
+    return NULL;
+}
+#endif
+
+static unsigned int drpcx__processor_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (unsigned int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (unsigned int)count : 1;
+#endif
+}
+#endif  // DRPCX_HAS_THREADS
+
+bool drpcx_load_batch(drpcx_batch_item* pItems, size_t itemCount, unsigned int threadCount)
+{
+    if (pItems == NULL) {
+        return itemCount == 0;
+    }
+
+    // Images are taken from the front of this range, and whatever the threads don't take is decoded at the end.
+    size_t firstItem = 0;
+
+#ifdef DRPCX_HAS_THREADS
+    if (threadCount == 0) {
+        threadCount = drpcx__processor_count();
+    }
+
+    if (threadCount > itemCount) {
+        threadCount = (unsigned int)itemCount;
+    }
+
+    if (threadCount > 1) {
+        drpcx__batch batch;
+        batch.pItems = pItems;
+        batch.itemCount = itemCount;
+        batch.nextItem = 0;
+
+        // The calling thread is one of the threads. If some or all of the others can't be created it just takes more images.
+        unsigned int workerCount = 0;
+#ifdef _WIN32
+        HANDLE* pThreads = (HANDLE*)malloc(sizeof(*pThreads) * (threadCount - 1));
+        if (pThreads != NULL) {
+            InitializeCriticalSection(&batch.lock);
+            while (workerCount < threadCount - 1) {
+                pThreads[workerCount] = CreateThread(NULL, 0, drpcx__batch_thread_win32, &batch, 0, NULL);
+                if (pThreads[workerCount] == NULL) {
+                    break;
+                }
+                workerCount += 1;
+            }
+
+            drpcx__batch_thread(&batch);
+
+            for (unsigned int i = 0; i < workerCount; ++i) {
+                WaitForSingleObject(pThreads[i], INFINITE);
+                CloseHandle(pThreads[i]);
+            }
+
+            DeleteCriticalSection(&batch.lock);
+            free(pThreads);
+        }
+#else
+        pthread_t* pThreads = (pthread_t*)malloc(sizeof(*pThreads) * (threadCount - 1));
+        if (pThreads != NULL && pthread_mutex_init(&batch.lock, NULL) == 0) {
+            while (workerCount < threadCount - 1) {
+                if (pthread_create(&pThreads[workerCount], NULL, drpcx__batch_thread_posix, &batch) != 0) {
+                    break;
+                }
+                workerCount += 1;
+            }
+
+            drpcx__batch_thread(&batch);
+
+            for (unsigned int i = 0; i < workerCount; ++i) {
+                pthread_join(pThreads[i], NULL);
+            }
+
+            pthread_mutex_destroy(&batch.lock);
+        }
+        free(pThreads);
+#endif
+
+        // Nothing is left over unless the threads couldn't be set up, in which case everything is done below.
+        firstItem = batch.nextItem;
+    }
+#else
+    (void)threadCount;
+#endif
+
+    for (size_t i = firstItem; i < itemCount; ++i) {
+        drpcx__load_batch_item(&pItems[i]);
+    }
+
+    for (size_t i = 0; i < itemCount; ++i) {
+        if (!pItems[i].succeeded) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 #endif // DR_PCX_IMPLEMENTATION
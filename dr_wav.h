@@ -20,8 +20,12 @@
 // QUICK NOTES
 //
 // - Samples are always interleaved.
-// - The default read function does not do any data conversion. Use drwav_read_f32() to read and convert audio data
-//   to IEEE 32-bit floating point samples. Tested and supported internal formats include the following:
+// - The drwav_init*() APIs initialize a caller-owned drwav object and do not allocate any memory. The drwav_open*() APIs are
+//   the same, except the drwav object is allocated on the heap. Use drwav_uninit() with the former and drwav_close() with the
+//   latter.
+// - The default read function does not do any data conversion. Use drwav_read_f32(), drwav_read_s32() or drwav_read_s16()
+//   to read and convert audio data to IEEE 32-bit floating point, signed 32-bit PCM or signed 16-bit PCM samples. Tested
+//   and supported internal formats include the following:
 //   - Unsigned 8-bit PCM
 //   - Signed 12-bit PCM
 //   - Signed 16-bit PCM
@@ -30,7 +34,22 @@
 //   - IEEE 32-bit floating point.
 //   - IEEE 64-bit floating point.
 //   - A-law and u-law
-// - Microsoft ADPCM is not currently supported.
+//   - Microsoft ADPCM and IMA (DVI) ADPCM, mono and stereo.
+// - ADPCM data is variable sized so drwav_read() can't be used with it. Use drwav_read_s16() or one of the other converting
+//   read functions instead. Seeking is sample accurate - drwav_seek() seeks to the start of the block containing the target
+//   sample and then decodes up to it.
+// - Files can be read from sources that can't be seeked, such as pipes, by passing null for <onSeek>. Streamed files with a
+//   data chunk size of 0xFFFFFFFF are read until the end of the stream, and have a <totalSampleCount> of 0.
+// - Sony Wave64 and RF64/BW64 files are supported transparently. Use the <container> member of the drwav object to find out
+//   which one was opened.
+// - Use drwav_open_write() or drwav_open_file_write() to write wav files. The RIFF and data chunk sizes are written when the
+//   file is closed, and files that end up larger than 4GB are automatically turned into RF64 files.
+// - Use drwav_read_f32_downmixed() to read multichannel files as mono or stereo. The conversion and mix are done together in
+//   small blocks rather than in separate passes over the data.
+// - Use drwav_open_file_read_ahead() to stream large files without blocking on the disk. The file is read on a background
+//   thread and drwav_get_read_ahead_underrun_count() reports how often a read had to wait for it anyway.
+// - Files opened with drwav_open_memory() or drwav_open_file_mapped() can have their sample data accessed directly with
+//   drwav_get_raw_data_pointer(). Use drwav_convert_raw_to_f32() and friends to convert it without any intermediate copies.
 // - This library does not do strict validation - it will try it's hardest to open every wav file.
 //
 //
@@ -38,18 +57,35 @@
 // OPTIONS
 //
 // #define DR_WAV_NO_CONVERSION_API
-//   Excludes conversion APIs such as drwav_read_f32() and drwav_s16PCM_to_f32().
+//   Excludes conversion APIs such as drwav_read_f32(), drwav_read_s16() and drwav_s16PCM_to_f32().
 //
 // #define DR_WAV_NO_STDIO
-//   Excludes drwav_open_file().
+//   Excludes drwav_open_file() and drwav_open_file_mapped().
+//
+// #define DR_WAV_NO_THREADS
+//   Excludes drwav_open_file_read_ahead(), which is the only part of the library that creates threads. When this is not
+//   defined, pthreads is needed on non-Windows platforms.
+//
+// #define DR_WAV_READ_AHEAD_BUFFER_SIZE <number>
+//   Defines the default size of the ring buffer used by drwav_open_file_read_ahead(). Defaults to 256KB.
+//
+// #define DR_WAV_NO_MMAP
+//   Disables the use of mmap() in drwav_open_file_mapped(). The whole file will be loaded into memory instead.
+//
+// #define DR_WAV_NO_SSE2
+//   Disables the SSE2 optimized conversion paths. These are compiled in automatically on x64 and whenever the compiler is
+//   targeting SSE2.
+//
+// #define DR_WAV_NO_AVX2
+//   Disables the AVX2 optimized conversion paths. These are only compiled in when the compiler is targeting AVX2 (-mavx2 or
+//   /arch:AVX2, for example).
+//
+// #define DR_WAV_WRITE_BUFFER_SIZE <number>
+//   Defines the size of the internal buffer used to combine writes when writing a wav file. Data is only passed to onWrite()
+//   once this buffer is full, or when the file is closed. Defaults to 64KB.
 //
 //
 //
-// TODO:
-// - Add seamless support for w64. This is very similar to WAVE, but supports files >4GB. There's no real reason this
-//   can't be added to dr_wav and have it work seamlessly.
-// - Add drwav_read_s32() for consistency with dr_flac.
-// - Look at making this not use the heap.
 
 #ifndef dr_wav_h
 #define dr_wav_h
@@ -61,20 +97,70 @@
 extern "C" {
 #endif
 
+#ifndef DR_WAV_WRITE_BUFFER_SIZE
+#define DR_WAV_WRITE_BUFFER_SIZE    65536
+#endif
+
+#ifndef DR_WAV_READ_AHEAD_BUFFER_SIZE
+#define DR_WAV_READ_AHEAD_BUFFER_SIZE   262144
+#endif
+
+#if !defined(DR_WAV_NO_STDIO) && !defined(DR_WAV_NO_THREADS)
+#define DRWAV_HAS_READ_AHEAD
+#endif
+
 // Common data formats.
 #define DR_WAVE_FORMAT_PCM          0x1
-#define DR_WAVE_FORMAT_ADPCM        0x2     // Not currently supported.
+#define DR_WAVE_FORMAT_ADPCM        0x2
 #define DR_WAVE_FORMAT_IEEE_FLOAT   0x3
 #define DR_WAVE_FORMAT_ALAW         0x6
 #define DR_WAVE_FORMAT_MULAW        0x7
+#define DR_WAVE_FORMAT_DVI_ADPCM    0x11
 #define DR_WAVE_FORMAT_EXTENSIBLE   0xFFFE
 
+// Speaker positions, as used by the channel mask of WAVE_FORMAT_EXTENSIBLE files. Channels are stored in the order of these bits.
+#define DR_WAVE_SPEAKER_FRONT_LEFT              0x1
+#define DR_WAVE_SPEAKER_FRONT_RIGHT             0x2
+#define DR_WAVE_SPEAKER_FRONT_CENTER            0x4
+#define DR_WAVE_SPEAKER_LOW_FREQUENCY           0x8
+#define DR_WAVE_SPEAKER_BACK_LEFT               0x10
+#define DR_WAVE_SPEAKER_BACK_RIGHT              0x20
+#define DR_WAVE_SPEAKER_FRONT_LEFT_OF_CENTER    0x40
+#define DR_WAVE_SPEAKER_FRONT_RIGHT_OF_CENTER   0x80
+#define DR_WAVE_SPEAKER_BACK_CENTER             0x100
+#define DR_WAVE_SPEAKER_SIDE_LEFT               0x200
+#define DR_WAVE_SPEAKER_SIDE_RIGHT              0x400
+#define DR_WAVE_SPEAKER_TOP_CENTER              0x800
+#define DR_WAVE_SPEAKER_TOP_FRONT_LEFT          0x1000
+#define DR_WAVE_SPEAKER_TOP_FRONT_CENTER        0x2000
+#define DR_WAVE_SPEAKER_TOP_FRONT_RIGHT         0x4000
+#define DR_WAVE_SPEAKER_TOP_BACK_LEFT           0x8000
+#define DR_WAVE_SPEAKER_TOP_BACK_CENTER         0x10000
+#define DR_WAVE_SPEAKER_TOP_BACK_RIGHT          0x20000
+
 // Callback for when data is read. Return value is the number of bytes actually read.
 typedef size_t (* drwav_read_proc)(void* pUserData, void* pBufferOut, size_t bytesToRead);
 
-// Callback for when data needs to be seeked. Offset is always relative to the current position. Return value
-// is 0 on failure, non-zero success.
-typedef int (* drwav_seek_proc)(void* pUserData, int offset);
+// Callback for when data is written. Return value is the number of bytes actually written.
+typedef size_t (* drwav_write_proc)(void* pUserData, const void* pData, size_t bytesToWrite);
+
+typedef enum
+{
+    drwav_seek_origin_start,
+    drwav_seek_origin_current
+} drwav_seek_origin;
+
+typedef enum
+{
+    drwav_container_riff,
+    drwav_container_w64,
+    drwav_container_rf64
+} drwav_container;
+
+// Callback for when data needs to be seeked. <offset> is relative to <origin>, where drwav_seek_origin_start is the start of the
+// wav file (the first byte of the RIFF header) and drwav_seek_origin_current is the current read position. Offsets are 64-bit
+// so that files larger than 4GB can be seeked directly. Return value is 0 on failure, non-zero success.
+typedef int (* drwav_seek_proc)(void* pUserData, int64_t offset, drwav_seek_origin origin);
 
 typedef struct
 {
@@ -105,7 +191,8 @@ typedef struct
     // many bits a valid per sample. Mainly used for informational purposes.
     unsigned short validBitsPerSample;
 
-    // The channel mask. Not used at the moment.
+    // The channel mask. This is a combination of the DR_WAVE_SPEAKER_* bits, or 0 if the file does not specify one. Used by
+    // drwav_read_f32_downmixed().
     unsigned int channelMask;
 
     // The sub-format, exactly as specified by the wave file.
@@ -113,6 +200,153 @@ typedef struct
 
 } drwav_fmt;
 
+typedef struct
+{
+    // The container to write. drwav_container_riff will be promoted to RF64 if the file ends up larger than 4GB. Setting this
+    // to drwav_container_rf64 will always write an RF64 file.
+    drwav_container container;
+
+    // The format tag. This should be DR_WAVE_FORMAT_PCM, DR_WAVE_FORMAT_IEEE_FLOAT, DR_WAVE_FORMAT_ALAW or DR_WAVE_FORMAT_MULAW.
+    //
+    // Files with more than 2 channels, and PCM files with more than 16 bits per sample, are written as WAVE_FORMAT_EXTENSIBLE
+    // with this as the sub-format and the default speaker layout for the channel count. Everything other than PCM gets a
+    // "fact" chunk holding the number of sample frames.
+    unsigned int format;
+
+    // The number of channels.
+    unsigned int channels;
+
+    // The sample rate.
+    unsigned int sampleRate;
+
+    // The number of bits per sample. This must be a multiple of 8.
+    unsigned int bitsPerSample;
+
+} drwav_data_format;
+
+// The maximum number of chunks that can be recorded in the chunk index of a drwav object.
+#define DRWAV_MAX_CHUNKS    32
+
+typedef struct
+{
+    // The chunk's ID. For RIFF and RF64 files this is the FOURCC, followed by zeros. For Wave64 files it's the GUID.
+    unsigned char id[16];
+
+    // The position of the chunk's data relative to the start of the file.
+    uint64_t dataPos;
+
+    // The size in bytes of the chunk's data, not including the header or padding.
+    uint64_t dataSize;
+
+} drwav_chunk;
+
+typedef struct
+{
+    // The ID of the cue point. This is what loops in the "smpl" chunk refer to.
+    uint32_t id;
+
+    // The position of the cue point in sample frames, for files without a playlist.
+    uint32_t position;
+
+    // The ID of the chunk containing the cue point. This is normally "data".
+    unsigned char dataChunkId[4];
+
+    // The position of the chunk containing the cue point, and of the block containing it. Normally both 0.
+    uint32_t chunkStart;
+    uint32_t blockStart;
+
+    // The offset of the cue point in sample frames from the start of the block.
+    uint32_t sampleOffset;
+
+} drwav_cue_point;
+
+typedef struct
+{
+    // The ID of the cue point associated with the loop.
+    uint32_t cuePointId;
+
+    // The loop type. 0 = forward, 1 = ping-pong, 2 = backward.
+    uint32_t type;
+
+    // The first and last sample frames of the loop. Both are inclusive.
+    uint32_t start;
+    uint32_t end;
+
+    // The fractional position of the loop point, and the number of times to play the loop where 0 is infinite.
+    uint32_t fraction;
+    uint32_t playCount;
+
+} drwav_smpl_loop;
+
+typedef struct
+{
+    // The text fields of the "bext" chunk, null terminated. These are stored in the file as ASCII.
+    char description[257];
+    char originator[33];
+    char originatorReference[33];
+    char originationDate[11];   // yyyy:mm:dd
+    char originationTime[9];    // hh:mm:ss
+
+    // The number of samples since midnight of the first sample in the file.
+    uint64_t timeReference;
+
+    // The version of the "bext" chunk. The fields below are only valid when this is high enough.
+    unsigned short version;
+
+    // The SMPTE UMID. Version 1 and above.
+    unsigned char umid[64];
+
+    // Loudness values in hundredths of a unit (LUFS, LU or dBTP). Version 2 and above.
+    short loudnessValue;
+    short loudnessRange;
+    short maxTruePeakLevel;
+    short maxMomentaryLoudness;
+    short maxShortTermLoudness;
+
+    // The size in bytes of the coding history which follows the fixed size part of the chunk. Use drwav_read_chunk_data() with
+    // <codingHistoryOffset> to read it.
+    uint64_t codingHistoryOffset;
+    uint64_t codingHistorySize;
+
+} drwav_bext;
+
+// The state of a memory stream used by drwav_init_memory() and drwav_init_file_mapped(). This is stored in the drwav object
+// so that no allocations are needed.
+typedef enum
+{
+    drwav_memory_ownership_none,
+    drwav_memory_ownership_malloc,
+    drwav_memory_ownership_mmap
+} drwav_memory_ownership;
+
+typedef struct
+{
+    // A pointer to the beginning of the data. We use a char as the type here for easy offsetting.
+    const unsigned char* data;
+
+    // The size of the data.
+    size_t dataSize;
+
+    // The position we're currently sitting at.
+    size_t currentReadPos;
+
+    // Whether or not <data> is owned by the drwav_memory object, and how it needs to be released.
+    drwav_memory_ownership ownership;
+
+} drwav_memory;
+
+// The state of the random number generator used to dither samples in drwav_f32_to_s16_dithered() and
+// drwav_f32_to_s24_dithered(). This is four independent xorshift generators so that four samples can be dithered at a time.
+// Initialize this with drwav_dither_init().
+typedef struct
+{
+    uint32_t state[4];
+
+} drwav_dither;
+
+// The maximum number of coefficient pairs that can be stored for Microsoft ADPCM. Standard files use 7.
+#define DRWAV_MAX_MSADPCM_COEFFS    32
+
 typedef struct
 {
     // A pointer to the function to call when more data is needed.
@@ -121,10 +355,19 @@ typedef struct
     // A pointer to the function to call when the wav file needs to be seeked.
     drwav_seek_proc onSeek;
 
+    // A pointer to the function to call when data needs to be written. This is only set when the wav file was opened for
+    // writing, in which case <onRead> is null.
+    drwav_write_proc onWrite;
+
     // The user data to pass to callbacks.
     void* pUserData;
 
 
+    // The container type. This is set based on whether or not the file is a standard RIFF file, a Sony Wave64 file or an
+    // RF64/BW64 file.
+    drwav_container container;
+
+
     // Structure containing format information exactly as specified by the wav file.
     drwav_fmt fmt;
 
@@ -137,7 +380,7 @@ typedef struct
     // The bits per sample. Will be set to somthing like 16, 24, etc.
     unsigned short bitsPerSample;
 
-    // The number of bytes per sample.
+    // The number of bytes per sample. This is set to 0 for compressed formats such as ADPCM where samples are not a fixed size.
     unsigned short bytesPerSample;
 
     // Equal to fmt.formatTag, or the value specified by fmt.subFormat is fmt.formatTag is equal to 65534 (WAVE_FORMAT_EXTENSIBLE).
@@ -145,6 +388,9 @@ typedef struct
 
     // The total number of samples making up the audio data. Use <totalSampleCount> * <bytesPerSample> to calculate
     // the required size of a buffer to hold the entire audio data.
+    //
+    // This is 0 for streamed files that don't specify the size of their data chunk (a size of 0xFFFFFFFF). The length of these
+    // is not known until the end is reached, so keep reading until fewer samples are returned than were requested.
     uint64_t totalSampleCount;
 
     
@@ -152,15 +398,106 @@ typedef struct
     // The number of bytes remaining in the data chunk.
     uint64_t bytesRemaining;
 
+    // The size in bytes of the data chunk. Set to UINT64_MAX when the size is not known.
+    uint64_t dataChunkDataSize;
+
+    // The position of the first byte of the data chunk's data, relative to the start of the file. Used for seeking.
+    uint64_t dataChunkDataPos;
+
+
+    // Microsoft ADPCM and IMA ADPCM specific data. Not used for other formats.
+    struct
+    {
+        // The number of sample frames making up a full block.
+        unsigned int framesPerBlock;
+
+        // The number of compressed bytes remaining in the current block. When this is 0 the next block header needs to be read.
+        unsigned int bytesRemainingInBlock;
+
+        // The index of the next sample to be returned. Used for stopping at <totalSampleCount>, since the last block is padded.
+        uint64_t iCurrentSample;
+
+        // The Microsoft ADPCM coefficient table, exactly as specified in the "fmt " chunk.
+        short coeffTable[DRWAV_MAX_MSADPCM_COEFFS][2];
+        unsigned short coeffCount;
+
+        // The per-channel decoder state. For Microsoft ADPCM <prevSamples> holds the two previous samples, <delta> is the
+        // adaptive step and <coeff> is the coefficient pair selected by the block header. For IMA ADPCM <prevSamples[ch][0]>
+        // is the predictor and <stepIndex> is the index into the step table.
+        int prevSamples[2][2];
+        int delta[2];
+        int coeff[2][2];
+        int stepIndex[2];
+
+        // Samples that have been decoded but not yet returned. These are the samples stored in block headers and the left over
+        // samples when fewer samples are requested than a byte (or an IMA group of bytes) decodes to. The valid samples are
+        // always at the end of the array.
+        int16_t cachedSamples[16];
+        unsigned int cachedSampleCount;
+
+    } compressed;
+
+
+    // The memory stream used when the file was opened with drwav_init_memory() or drwav_init_file_mapped(). <pUserData> points
+    // to this, so a drwav object initialized this way must not be moved.
+    drwav_memory memoryStream;
+
+
+    // An index of the chunks making up the file. Chunks up to and including the "data" chunk are recorded when the file is
+    // opened. Chunks after the "data" chunk are only scanned the first time a chunk is searched for and not found, at which
+    // point <isChunkIndexComplete> is set. Chunks past DRWAV_MAX_CHUNKS are not recorded.
+    drwav_chunk chunks[DRWAV_MAX_CHUNKS];
+    unsigned int chunkCount;
+    int isChunkIndexComplete;
+
+
+    // The write-combining buffer. Only used when writing. Data is passed to onWrite() only when this buffer is full.
+    unsigned char* pWriteBuffer;
+    size_t writeBufferCapacity;
+    size_t writeBufferSize;
+
+    // Set when onWrite() fails to write everything it's given. Once this is set all further writes will fail.
+    int writeFailed;
+
+    // The position of the frame count in the "fact" chunk, or 0 if the file being written doesn't have one.
+    uint64_t factFrameCountPos;
+
+    // Whether or not drwav_write_f32() dithers samples when converting them to 16- or 24-bit PCM, and the state of the noise
+    // generator. Set with drwav_set_write_dither().
+    int isWriteDitherEnabled;
+    drwav_dither writeDither;
+
 } drwav;
 
 
+// Initializes a pre-allocated drwav object for reading a .wav file using the given callbacks.
+//
+// This does not allocate any memory, which means the drwav object can be placed on the stack or inside another object. Use
+// drwav_uninit() to clean up.
+//
+// <onSeek> can be null for sources that can't be seeked, such as pipes and sockets. Chunks are then skipped by reading them
+// and throwing the data away, so only one pass is made over the stream. drwav_seek() and the chunk and metadata functions
+// are not available in this mode.
+//
+// Returns 0 on error, non-zero on success.
+int drwav_init(drwav* pWav, drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData);
+
+// Uninitializes the given drwav object.
+//
+// If the file was initialized for writing, this flushes any buffered data and writes the final chunk sizes. Use this for
+// objects initialized with the drwav_init*() family of APIs, and drwav_close() for objects returned by drwav_open*().
+void drwav_uninit(drwav* pWav);
+
 // Opens a .wav file using the given callbacks.
 //
+// This is the same as drwav_init(), except the drwav object is allocated on the heap.
+//
 // Returns null on error.
 drwav* drwav_open(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData);
 
-// Closes the given drwav object.
+// Uninitializes and deletes the given drwav object.
+//
+// If the file was opened for writing, this flushes any buffered data and writes the final chunk sizes.
 void drwav_close(drwav* pWav);
 
 
@@ -181,18 +518,113 @@ size_t drwav_read_raw(drwav* pWav, void* pBufferOut, size_t bytesToRead);
 //
 // This function will only work when sample data is of a fixed size. If you are using an unusual
 // format which uses variable sized samples, consider using drwav_read_raw(), but don't combine them.
+// This always returns 0 for ADPCM.
 size_t drwav_read(drwav* pWav, size_t samplesToRead, void* pBufferOut, size_t bufferOutSize);
 
 // Seeks to the given sample.
 //
-// The return value is zero if an error occurs, non-zero if successful.
+// The return value is zero if an error occurs, non-zero if successful. Seeking is not supported when writing.
 int drwav_seek(drwav* pWav, uint64_t sample);
 
 
+// Finds a chunk by it's FOURCC.
+//
+// Chunks after the "data" chunk are not scanned until they are needed, so the first call for a chunk that's not before the
+// "data" chunk will seek to the end of the file and back. For Wave64 files the FOURCC is mapped to its GUID. "LIST" maps to
+// the Wave64 list GUID and everything else to the FOURCC followed by the same 12 bytes as the "fmt " and "data" GUIDs.
+//
+// Returns null if the chunk could not be found.
+const drwav_chunk* drwav_find_chunk(drwav* pWav, const char* fourcc);
+
+// Reads the data of the given chunk, starting <offset> bytes into it.
+//
+// This does not affect the position of drwav_read() and friends. Returns the number of bytes read.
+size_t drwav_read_chunk_data(drwav* pWav, const drwav_chunk* pChunk, uint64_t offset, void* pBufferOut, size_t bytesToRead);
+
+// Retrieves the cue points stored in the "cue " chunk.
+//
+// Only the first <maxCount> cue points are read. <pCuePointsOut> can be null, in which case nothing is read beyond the count.
+//
+// Returns the total number of cue points in the file, or 0 if there is no "cue " chunk.
+uint32_t drwav_get_cue_points(drwav* pWav, drwav_cue_point* pCuePointsOut, uint32_t maxCount);
+
+// Retrieves the loops stored in the "smpl" chunk.
+//
+// This works the same way as drwav_get_cue_points(). Only the loop count and the requested loops are read from the file.
+uint32_t drwav_get_smpl_loops(drwav* pWav, drwav_smpl_loop* pLoopsOut, uint32_t maxCount);
+
+// Retrieves a string from the "INFO" list such as "INAM" (the title), "IART" (the artist) or "ICMT" (a comment).
+//
+// The string is always null terminated and is truncated if it doesn't fit in <pStringOut>.
+//
+// Returns the length of the string in the file, not including the null terminator, or 0 if it doesn't exist. <pStringOut>
+// can be null, in which case only the length is returned.
+//
+// This always returns 0 for Wave64 files. Their list chunks hold GUID based sub-chunks and there's no Wave64 equivalent of
+// the "INFO" list.
+size_t drwav_get_info_string(drwav* pWav, const char* infoId, char* pStringOut, size_t stringOutSize);
+
+// Retrieves the fixed size part of the broadcast extension ("bext") chunk.
+//
+// Returns 0 if the chunk doesn't exist or could not be read, non-zero on success.
+int drwav_get_bext(drwav* pWav, drwav_bext* pBextOut);
+
+
+// Initializes a pre-allocated drwav object for writing a wav file using the given callbacks.
+//
+// This does not allocate any memory, and as a result there is no write buffer. Every write is passed straight to onWrite().
+// See drwav_open_write() for details on the callbacks.
+//
+// Returns 0 on error, non-zero on success.
+int drwav_init_write(drwav* pWav, const drwav_data_format* pFormat, drwav_write_proc onWrite, drwav_seek_proc onSeek, void* pUserData);
+
+// Opens a wav file for writing using the given callbacks.
+//
+// <onSeek> is used to go back and write the RIFF and data chunk sizes, and the frame count of the "fact" chunk, when the file
+// is closed with drwav_close(). It can be null for outputs that can't be seeked, such as pipes, in which case they are left
+// at 0xFFFFFFFF which most readers take to mean "read to the end of the file". RF64 promotion is not possible without
+// <onSeek>.
+//
+// Writes are combined into an internal buffer of DR_WAV_WRITE_BUFFER_SIZE bytes which is allocated with the drwav object.
+//
+// Returns null on error.
+drwav* drwav_open_write(const drwav_data_format* pFormat, drwav_write_proc onWrite, drwav_seek_proc onSeek, void* pUserData);
+
+// Writes raw audio data.
+//
+// This is the lowest level function for writing audio data. The data is written as-is and must be in the format the file
+// was opened with. Returns the number of bytes written, which will be less than <bytesToWrite> if an error occurs. Because
+// writes are buffered, an error may not be reported until a later call.
+size_t drwav_write_raw(drwav* pWav, const void* pData, size_t bytesToWrite);
+
+// Writes audio data in the format the file was opened with.
+//
+// Returns the number of samples written.
+size_t drwav_write(drwav* pWav, size_t samplesToWrite, const void* pData);
+
+
 
 //// Convertion Utilities ////
 #ifndef DR_WAV_NO_CONVERSION_API
 
+// Reads a chunk of audio data and converts it to signed 16-bit PCM samples.
+//
+// Returns the number of samples actually read.
+//
+// If the return value is less than <samplesToRead> it means the end of the file has been reached.
+//
+// Where the internal format is no larger than the output format, the raw data is read straight into the tail of <pBufferOut>
+// in a single call to onRead() and then converted in place. <pBufferOut> must therefore be large enough to hold <samplesToRead>
+// samples.
+size_t drwav_read_s16(drwav* pWav, size_t samplesToRead, int16_t* pBufferOut);
+
+// Reads a chunk of audio data and converts it to signed 32-bit PCM samples.
+//
+// Returns the number of samples actually read.
+//
+// If the return value is less than <samplesToRead> it means the end of the file has been reached.
+size_t drwav_read_s32(drwav* pWav, size_t samplesToRead, int32_t* pBufferOut);
+
 // Reads a chunk of audio data and converts it to IEEE 32-bit floating point samples.
 //
 // Returns the number of samples actually read.
@@ -200,6 +632,80 @@ int drwav_seek(drwav* pWav, uint64_t sample);
 // If the return value is less than <samplesToRead> it means the end of the file has been reached.
 size_t drwav_read_f32(drwav* pWav, size_t samplesToRead, float* pBufferOut);
 
+// Reads a chunk of audio data, converts it to IEEE 32-bit floating point and mixes it down to mono or stereo in a single pass.
+//
+// <outputChannels> must be 1 or 2. <framesToRead> is the number of PCM frames to read, and <pBufferOut> must be large enough to
+// hold <framesToRead> * <outputChannels> samples. Returns the number of frames actually read, or 0 if the file has more than
+// 32 channels.
+//
+// The mix is derived from the channel mask of the file. When the file does not have a channel mask, the usual layout for the
+// channel count is assumed (5.1 for 6 channels, for example). Center channels contribute at -3dB to both sides, surrounds at
+// -3dB to their own side and the LFE channel is dropped. The result is scaled down, if necessary, so it can never clip.
+size_t drwav_read_f32_downmixed(drwav* pWav, unsigned int outputChannels, size_t framesToRead, float* pBufferOut);
+
+// Reads a chunk of audio data, converts it to IEEE 32-bit floating point and splits it into a separate buffer for each channel.
+//
+// <ppBufferOut> is an array of one pointer per channel, each of which must be large enough to hold <framesToRead> samples.
+// Returns the number of frames actually read.
+//
+// The data is split up as it's converted, a small block at a time, which avoids a separate pass over an interleaved buffer.
+// 2, 4, 6 and 8 channels are split with SSE2 when it's available.
+size_t drwav_read_f32_planar(drwav* pWav, size_t framesToRead, float** ppBufferOut);
+
+// Reads a chunk of audio data, converts it to signed 16-bit PCM and splits it into a separate buffer for each channel.
+//
+// This works the same way as drwav_read_f32_planar().
+size_t drwav_read_s16_planar(drwav* pWav, size_t framesToRead, int16_t** ppBufferOut);
+
+
+// The low-level conversion functions below walk forward through the input and never write past the input sample they are
+// currently reading. This means they can be used to convert in place so long as the input data sits at the tail of the
+// output buffer.
+
+// Low-level function for converting unsigned 8-bit PCM samples to signed 16-bit PCM samples.
+void drwav_u8PCM_to_s16(size_t totalSampleCount, const unsigned char* u8PCM, short* s16Out);
+
+// Low-level function for converting signed 24-bit PCM samples to signed 16-bit PCM samples.
+void drwav_s24PCM_to_s16(size_t totalSampleCount, const unsigned char* s24PCM, short* s16Out);
+
+// Low-level function for converting signed 32-bit PCM samples to signed 16-bit PCM samples.
+void drwav_s32PCM_to_s16(size_t totalSampleCount, const int* s32PCM, short* s16Out);
+
+// Low-level function for converting IEEE 32-bit floating point samples to signed 16-bit PCM samples.
+void drwav_f32_to_s16(size_t totalSampleCount, const float* f32In, short* s16Out);
+
+// Low-level function for converting IEEE 64-bit floating point samples to signed 16-bit PCM samples.
+void drwav_f64_to_s16(size_t totalSampleCount, const double* f64In, short* s16Out);
+
+// Low-level function for converting A-law samples to signed 16-bit PCM samples.
+void drwav_alaw_to_s16(size_t totalSampleCount, const unsigned char* alaw, short* s16Out);
+
+// Low-level function for converting u-law samples to signed 16-bit PCM samples.
+void drwav_ulaw_to_s16(size_t totalSampleCount, const unsigned char* ulaw, short* s16Out);
+
+
+// Low-level function for converting unsigned 8-bit PCM samples to signed 32-bit PCM samples.
+void drwav_u8PCM_to_s32(size_t totalSampleCount, const unsigned char* u8PCM, int* s32Out);
+
+// Low-level function for converting signed 16-bit PCM samples to signed 32-bit PCM samples.
+void drwav_s16PCM_to_s32(size_t totalSampleCount, const short* s16PCM, int* s32Out);
+
+// Low-level function for converting signed 24-bit PCM samples to signed 32-bit PCM samples.
+void drwav_s24PCM_to_s32(size_t totalSampleCount, const unsigned char* s24PCM, int* s32Out);
+
+// Low-level function for converting IEEE 32-bit floating point samples to signed 32-bit PCM samples.
+void drwav_f32_to_s32(size_t totalSampleCount, const float* f32In, int* s32Out);
+
+// Low-level function for converting IEEE 64-bit floating point samples to signed 32-bit PCM samples.
+void drwav_f64_to_s32(size_t totalSampleCount, const double* f64In, int* s32Out);
+
+// Low-level function for converting A-law samples to signed 32-bit PCM samples.
+void drwav_alaw_to_s32(size_t totalSampleCount, const unsigned char* alaw, int* s32Out);
+
+// Low-level function for converting u-law samples to signed 32-bit PCM samples.
+void drwav_ulaw_to_s32(size_t totalSampleCount, const unsigned char* ulaw, int* s32Out);
+
+
 // Low-level function for converting unsigned 8-bit PCM samples to IEEE 32-bit floating point samples.
 void drwav_u8PCM_to_f32(size_t totalSampleCount, const unsigned char* u8PCM, float* f32Out);
 
@@ -221,6 +727,69 @@ void drwav_alaw_to_f32(size_t totalSampleCount, const unsigned char* alaw, float
 // Low-level function for converting u-law samples to IEEE 32-bit floating point samples.
 void drwav_ulaw_to_f32(size_t totalSampleCount, const unsigned char* ulaw, float* f32Out);
 
+
+// Converts raw sample data in the internal format of the given wav file to signed 16-bit PCM samples.
+//
+// This is intended to be used with the pointer returned by drwav_get_raw_data_pointer(), but will work with any data in the
+// same format. <pRawData> can be at any alignment, and may be the same as <pBufferOut> under the same rules as the low-level
+// functions above. Unlike the raw data, <pBufferOut> needs to be aligned to the output sample type.
+//
+// Returns the number of samples converted. This will be 0 if the format is compressed or not supported.
+size_t drwav_convert_raw_to_s16(drwav* pWav, size_t sampleCount, const void* pRawData, int16_t* pBufferOut);
+
+// Converts raw sample data in the internal format of the given wav file to signed 32-bit PCM samples.
+size_t drwav_convert_raw_to_s32(drwav* pWav, size_t sampleCount, const void* pRawData, int32_t* pBufferOut);
+
+// Converts raw sample data in the internal format of the given wav file to IEEE 32-bit floating point samples.
+size_t drwav_convert_raw_to_f32(drwav* pWav, size_t sampleCount, const void* pRawData, float* pBufferOut);
+
+
+// Writes signed 16-bit PCM samples, converting them to the format the file was opened with.
+//
+// The samples are converted straight into the write buffer. Conversion is supported for signed 16-, 24- and 32-bit PCM and
+// IEEE 32-bit floating point. Use drwav_write() for anything else.
+//
+// Returns the number of samples written.
+size_t drwav_write_s16(drwav* pWav, size_t samplesToWrite, const int16_t* pData);
+
+// Writes signed 32-bit PCM samples, converting them to the format the file was opened with.
+size_t drwav_write_s32(drwav* pWav, size_t samplesToWrite, const int32_t* pData);
+
+// Writes IEEE 32-bit floating point samples, converting them to the format the file was opened with.
+//
+// Samples are rounded to the nearest integer unless dithering has been enabled with drwav_set_write_dither().
+size_t drwav_write_f32(drwav* pWav, size_t samplesToWrite, const float* pData);
+
+// Enables or disables TPDF dither in drwav_write_f32() for 16- and 24-bit PCM files. Dithering is disabled by default.
+//
+// Enabling dither resets the noise generator to a fixed seed so that the same input always produces the same file. Files
+// with 32-bit PCM or floating point samples are never dithered because their precision is already beyond that of a float.
+void drwav_set_write_dither(drwav* pWav, int enabled);
+
+
+// Low-level function for converting signed 16-bit PCM samples to signed 24-bit PCM samples.
+void drwav_s16PCM_to_s24(size_t totalSampleCount, const short* s16PCM, unsigned char* s24Out);
+
+// Low-level function for converting signed 32-bit PCM samples to signed 24-bit PCM samples.
+void drwav_s32PCM_to_s24(size_t totalSampleCount, const int* s32PCM, unsigned char* s24Out);
+
+// Low-level function for converting IEEE 32-bit floating point samples to signed 24-bit PCM samples.
+void drwav_f32_to_s24(size_t totalSampleCount, const float* f32In, unsigned char* s24Out);
+
+
+// Initializes the noise generator used by the dithering conversion functions. The same seed always produces the same noise.
+void drwav_dither_init(drwav_dither* pDither, uint32_t seed);
+
+// Low-level function for converting IEEE 32-bit floating point samples to signed 16-bit PCM samples with TPDF dither.
+//
+// Triangular noise spanning +/-1 LSB is added to each sample before it's rounded. <pDither> is updated so that consecutive
+// calls continue the noise sequence. The noise only depends on the seed and the position of the sample in the sequence, not
+// on how the samples are split between calls.
+void drwav_f32_to_s16_dithered(size_t totalSampleCount, const float* f32In, short* s16Out, drwav_dither* pDither);
+
+// Low-level function for converting IEEE 32-bit floating point samples to signed 24-bit PCM samples with TPDF dither.
+void drwav_f32_to_s24_dithered(size_t totalSampleCount, const float* f32In, unsigned char* s24Out, drwav_dither* pDither);
+
 #endif  //DR_WAV_NO_CONVERSION_API
 
 
@@ -228,14 +797,75 @@ void drwav_ulaw_to_f32(size_t totalSampleCount, const unsigned char* ulaw, float
 
 #ifndef DR_WAV_NO_STDIO
 
+// Helper for initializing a wave file using stdio.
+//
+// This holds the internal FILE object until drwav_uninit() is called. Keep this in mind if you're
+// employing caching.
+int drwav_init_file(drwav* pWav, const char* filename);
+
+// Helper for initializing a wave file for writing using stdio.
+//
+// This holds the internal FILE object until drwav_uninit() is called.
+int drwav_init_file_write(drwav* pWav, const char* filename, const drwav_data_format* pFormat);
+
+// Helper for initializing a wave file by mapping it into memory.
+//
+// The mapping is held until drwav_uninit() is called. Use drwav_get_raw_data_pointer() to access the sample data directly
+// without any copying. On platforms without mmap() the whole file is loaded into memory instead.
+int drwav_init_file_mapped(drwav* pWav, const char* filename);
+
 // Helper for opening a wave file using stdio.
 //
 // This holds the internal FILE object until drwav_close() is called. Keep this in mind if you're
 // employing caching.
 drwav* drwav_open_file(const char* filename);
 
+// Helper for opening a wave file for writing using stdio.
+//
+// This holds the internal FILE object until drwav_close() is called.
+drwav* drwav_open_file_write(const char* filename, const drwav_data_format* pFormat);
+
+// Helper for opening a wave file by mapping it into memory.
+//
+// The mapping is held until drwav_close() is called. Use drwav_get_raw_data_pointer() to access the sample data directly
+// without any copying. On platforms without mmap() the whole file is loaded into memory instead.
+drwav* drwav_open_file_mapped(const char* filename);
+
+#ifdef DRWAV_HAS_READ_AHEAD
+// Helper for initializing a wave file using stdio, with the file being read ahead of time on a background thread.
+//
+// The thread fills one half of a ring buffer of <bufferSizeInBytes> bytes while reads are served from the other half, so
+// drwav_read() and friends only ever do a memcpy() unless the thread has fallen behind. Use 0 for the default size of
+// DR_WAV_READ_AHEAD_BUFFER_SIZE. Seeking outside of the half currently being read restarts the read-ahead from the new
+// position.
+//
+// The thread, the buffer and the FILE object are held until drwav_uninit() is called.
+int drwav_init_file_read_ahead(drwav* pWav, const char* filename, size_t bufferSizeInBytes);
+
+// Helper for opening a wave file using stdio, with the file being read ahead of time on a background thread.
+//
+// This is the same as drwav_init_file_read_ahead(), except the drwav object is allocated on the heap. The thread, the
+// buffer and the FILE object are held until drwav_close() is called.
+drwav* drwav_open_file_read_ahead(const char* filename, size_t bufferSizeInBytes);
+
+// Retrieves the number of times a read had to wait for the background thread of a file opened with
+// drwav_open_file_read_ahead().
+//
+// The first read after opening or seeking always has to wait and is not counted. Returns 0 for files that were not opened
+// with read-ahead.
+uint32_t drwav_get_read_ahead_underrun_count(drwav* pWav);
+#endif
+
 #endif  //DR_WAV_NO_STDIO
 
+// Helper for initializing a wave file from a pre-allocated memory buffer.
+//
+// This does not create a copy of the data. It is up to the application to ensure the buffer remains valid for
+// the lifetime of the drwav object.
+//
+// The buffer should contain the contents of the entire wave file, not just the sample data.
+int drwav_init_memory(drwav* pWav, const void* data, size_t dataSize);
+
 // Helper for opening a file from a pre-allocated memory buffer.
 //
 // This does not create a copy of the data. It is up to the application to ensure the buffer remains valid for
@@ -244,6 +874,18 @@ drwav* drwav_open_file(const char* filename);
 // The buffer should contain the contents of the entire wave file, not just the sample data.
 drwav* drwav_open_memory(const void* data, size_t dataSize);
 
+// Retrieves a pointer to the first byte of the sample data of a wave file opened with drwav_open_memory() or
+// drwav_open_file_mapped().
+//
+// The samples are stored in the internal format described by <translatedFormatTag>, <bytesPerSample> and <channels>, and
+// can be converted with drwav_convert_raw_to_s16/s32/f32(). The pointer is not necessarily aligned to the sample size, so
+// don't cast it to a pointer to the sample type. The drwav_convert_raw_to_*() functions accept it at any alignment.
+//
+// <pFrameCountOut> receives the number of whole sample frames available from the pointer and can be null.
+//
+// Returns null if the wave file was not opened from memory, or if it's compressed.
+const void* drwav_get_raw_data_pointer(drwav* pWav, uint64_t* pFrameCountOut);
+
 
 
 /////////////////////////////////////////////////////
@@ -262,6 +904,44 @@ drwav* drwav_open_memory(const void* data, size_t dataSize);
 #include <stdio.h>
 #endif
 
+#ifdef DRWAV_HAS_READ_AHEAD
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
+#if !defined(DR_WAV_NO_STDIO) && !defined(DR_WAV_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#define DRWAV_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if !defined(DR_WAV_NO_SSE2) && ((defined(_MSC_VER) && defined(_M_X64)) || defined(__SSE2__))
+#define DRWAV_SUPPORTS_SSE2
+#if defined(__MINGW32__)
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
+#if !defined(DR_WAV_NO_AVX2) && defined(__AVX2__)
+#define DRWAV_SUPPORTS_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define DRWAV_INLINE __forceinline
+#else
+#define DRWAV_INLINE inline
+#endif
+
+// The value of <dataChunkDataSize> for streams that don't say how long they are.
+#define DRWAV_UNKNOWN_DATA_SIZE     UINT64_MAX
+
 static int drwav__is_little_endian()
 {
     int n = 1;
@@ -280,12 +960,38 @@ static unsigned short drwav__read_u16(const unsigned char* data)
 static unsigned int drwav__read_u32(const unsigned char* data)
 {
     if (drwav__is_little_endian()) {
-        return (data[0] << 0) | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+        return (data[0] << 0) | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
     } else {
-        return (data[3] << 0) | (data[2] << 8) | (data[1] << 16) | (data[0] << 24);
+        return (data[3] << 0) | (data[2] << 8) | (data[1] << 16) | ((unsigned int)data[0] << 24);
     }
 }
 
+static uint64_t drwav__read_u64(const unsigned char* data)
+{
+    return (uint64_t)drwav__read_u32(data + 0) | ((uint64_t)drwav__read_u32(data + 4) << 32);
+}
+
+static uint64_t drwav__adpcm_frame_count_from_data_size(drwav* pWav, uint64_t dataSize)
+{
+    unsigned int channels   = pWav->channels;
+    unsigned int blockAlign = pWav->fmt.blockAlign;
+    uint64_t frameCount = (dataSize / blockAlign) * pWav->compressed.framesPerBlock;
+
+    // The last block may not be whole.
+    uint64_t lastBlockSize = dataSize % blockAlign;
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_ADPCM) {
+        if (lastBlockSize >= 7*channels) {
+            frameCount += ((lastBlockSize - 7*channels) * 2) / channels + 2;
+        }
+    } else {
+        if (lastBlockSize >= 4*channels) {
+            frameCount += ((lastBlockSize - 4*channels) / (4*channels)) * 8 + 1;
+        }
+    }
+
+    return frameCount;
+}
+
 static void drwav__read_guid(const unsigned char* data, unsigned char* guid)
 {
     for (int i = 0; i < 16; ++i) {
@@ -293,45 +999,174 @@ static void drwav__read_guid(const unsigned char* data, unsigned char* guid)
     }
 }
 
-static int drwav__read_fmt(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData, drwav_fmt* fmtOut)
+static int drwav__seek_forward(drwav_read_proc onRead, drwav_seek_proc onSeek, uint64_t offset, void* pUserData)
 {
-    unsigned char fmt[24];
-    if (onRead(pUserData, fmt, sizeof(fmt)) != sizeof(fmt)) {
-        return 0;    // Failed to read data.
-    }
+    // Streams that can't be seeked are skipped by reading into a scratch buffer.
+    if (onSeek == NULL) {
+        unsigned char scratch[4096];
+        while (offset > 0)
+        {
+            size_t bytesToRead = (offset > sizeof(scratch)) ? sizeof(scratch) : (size_t)offset;
+            if (onRead(pUserData, scratch, bytesToRead) != bytesToRead) {
+                return 0;
+            }
 
-    if (fmt[0] != 'f' || fmt[1] != 'm' || fmt[2] != 't' || fmt[3] != ' ') {
-        return 0;    // Expecting "fmt " (lower case).
+            offset -= bytesToRead;
+        }
+
+        return 1;
+    }
+
+    while (offset > 0)
+    {
+        int64_t offset64 = ((offset > INT64_MAX) ? INT64_MAX : (int64_t)offset);
+        if (!onSeek(pUserData, offset64, drwav_seek_origin_current)) {
+            return 0;
+        }
+
+        offset -= offset64;
+    }
+
+    return 1;
+}
+
+
+// The GUIDs used by Sony Wave64 to identify it's chunks. The ones that correspond to a RIFF chunk are the FOURCC followed by
+// the same 12 bytes.
+static const unsigned char drwavGUID_W64_RIFF[16] = {0x72,0x69,0x66,0x66, 0x2E,0x91, 0xCF,0x11, 0xA5,0xD6, 0x28,0xDB,0x04,0xC1,0x00,0x00};    // 66666972-912E-11CF-A5D6-28DB04C10000
+static const unsigned char drwavGUID_W64_WAVE[16] = {0x77,0x61,0x76,0x65, 0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};    // 65766177-ACF3-11D3-8CD1-00C04F8EDB8A
+static const unsigned char drwavGUID_W64_FMT [16] = {0x66,0x6D,0x74,0x20, 0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};    // 20746D66-ACF3-11D3-8CD1-00C04F8EDB8A
+static const unsigned char drwavGUID_W64_FACT[16] = {0x66,0x61,0x63,0x74, 0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};    // 74636166-ACF3-11D3-8CD1-00C04F8EDB8A
+static const unsigned char drwavGUID_W64_DATA[16] = {0x64,0x61,0x74,0x61, 0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};    // 61746164-ACF3-11D3-8CD1-00C04F8EDB8A
+static const unsigned char drwavGUID_W64_LIST[16] = {0x6C,0x69,0x73,0x74, 0x2F,0x91, 0xCF,0x11, 0xA5,0xD6, 0x28,0xDB,0x04,0xC1,0x00,0x00};    // 7473696C-912F-11CF-A5D6-28DB04C10000
+
+static int drwav__guid_equal(const unsigned char* a, const unsigned char* b)
+{
+    for (int i = 0; i < 16; ++i) {
+        if (a[i] != b[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int drwav__fourcc_equal(const unsigned char* a, const char* b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+
+typedef struct
+{
+    union
+    {
+        unsigned char fourcc[4];
+        unsigned char guid[16];
+    } id;
+
+    // The size in bytes of the chunk's data, not including the header.
+    uint64_t sizeInBytes;
+
+    // RIFF chunks are padded to 2 bytes and Wave64 chunks to 8 bytes. This is the number of padding bytes following the data.
+    unsigned int paddingSize;
+
+} drwav__chunk_header;
+
+// Reads the header of the next chunk. Returns the size of the header in bytes, or 0 on failure.
+static unsigned int drwav__read_chunk_header(drwav_read_proc onRead, void* pUserData, drwav_container container, drwav__chunk_header* pHeaderOut)
+{
+    if (container == drwav_container_w64) {
+        unsigned char sizeInBytes[8];
+        if (onRead(pUserData, pHeaderOut->id.guid, 16) != 16 || onRead(pUserData, sizeInBytes, 8) != 8) {
+            return 0;
+        }
+
+        // Wave64 chunk sizes include the 24 byte header.
+        pHeaderOut->sizeInBytes = drwav__read_u64(sizeInBytes);
+        if (pHeaderOut->sizeInBytes < 24) {
+            return 0;
+        }
+
+        pHeaderOut->sizeInBytes -= 24;
+        pHeaderOut->paddingSize  = (unsigned int)((8 - (pHeaderOut->sizeInBytes % 8)) % 8);
+        return 24;
+    } else {
+        unsigned char sizeInBytes[4];
+        if (onRead(pUserData, pHeaderOut->id.fourcc, 4) != 4 || onRead(pUserData, sizeInBytes, 4) != 4) {
+            return 0;
+        }
+
+        pHeaderOut->sizeInBytes = drwav__read_u32(sizeInBytes);
+        pHeaderOut->paddingSize = (unsigned int)(pHeaderOut->sizeInBytes % 2);
+        return 8;
+    }
+}
+
+static int drwav__chunk_is(const drwav__chunk_header* pHeader, drwav_container container, const char* fourcc, const unsigned char* guid)
+{
+    if (container == drwav_container_w64) {
+        return drwav__guid_equal(pHeader->id.guid, guid);
+    } else {
+        return drwav__fourcc_equal(pHeader->id.fourcc, fourcc);
     }
+}
+
+
+static void drwav__init_chunk(drwav_chunk* pChunk, const drwav__chunk_header* pHeader, drwav_container container, uint64_t dataPos)
+{
+    memset(pChunk->id, 0, sizeof(pChunk->id));
+    memcpy(pChunk->id, pHeader->id.guid, (container == drwav_container_w64) ? 16 : 4);
+    pChunk->dataPos  = dataPos;
+    pChunk->dataSize = pHeader->sizeInBytes;
+}
+
+
+// Reads the data of a "fmt " chunk whose header has already been read. For formats other than WAVE_FORMAT_EXTENSIBLE the bytes
+// following cbSize are format specific (the ADPCM coefficient table, for example) and are returned via <pExtraOut>. Anything that
+// doesn't fit is skipped, as is the chunk's padding.
+static int drwav__read_fmt(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData, const drwav__chunk_header* pHeader, drwav_fmt* fmtOut, unsigned char* pExtraOut, unsigned int extraOutCapacity, unsigned int* pExtraSizeOut)
+{
+    *pExtraSizeOut = 0;
 
-    unsigned int chunkSize = drwav__read_u32(fmt + 4);
+    uint64_t chunkSize = pHeader->sizeInBytes;
     if (chunkSize < 16) {
         return 0;    // The fmt chunk should always be at least 16 bytes.
     }
 
-    if (chunkSize != 16 && chunkSize != 18 && chunkSize != 40) {
-        return 0;    // Unexpected chunk size.
+    unsigned char fmt[16];
+    if (onRead(pUserData, fmt, sizeof(fmt)) != sizeof(fmt)) {
+        return 0;    // Failed to read data.
     }
 
-    fmtOut->formatTag      = drwav__read_u16(fmt + 8);
-    fmtOut->channels       = drwav__read_u16(fmt + 10);
-    fmtOut->sampleRate     = drwav__read_u32(fmt + 12);
-    fmtOut->avgBytesPerSec = drwav__read_u32(fmt + 16);
-    fmtOut->blockAlign     = drwav__read_u16(fmt + 20);
-    fmtOut->bitsPerSample  = drwav__read_u16(fmt + 22);
+    fmtOut->formatTag          = drwav__read_u16(fmt + 0);
+    fmtOut->channels           = drwav__read_u16(fmt + 2);
+    fmtOut->sampleRate         = drwav__read_u32(fmt + 4);
+    fmtOut->avgBytesPerSec     = drwav__read_u32(fmt + 8);
+    fmtOut->blockAlign         = drwav__read_u16(fmt + 12);
+    fmtOut->bitsPerSample      = drwav__read_u16(fmt + 14);
+    fmtOut->extendedSize       = 0;
+    fmtOut->validBitsPerSample = 0;
+    fmtOut->channelMask        = 0;
+    memset(fmtOut->subFormat, 0, sizeof(fmtOut->subFormat));
 
-    if (chunkSize > 16) {
-        if (chunkSize == 18) {
-            return onSeek(pUserData, 2);
-        } else {
-            assert(chunkSize == 40);
+    uint64_t bytesRemaining = (chunkSize - 16) + pHeader->paddingSize;
 
-            unsigned char fmt_cbSize[2];
-            if (onRead(pUserData, fmt_cbSize, sizeof(fmt_cbSize)) != sizeof(fmt_cbSize)) {
-                return 0;    // Expecting more data.
-            }
+    if (chunkSize >= 18)
+    {
+        unsigned char fmt_cbSize[2];
+        if (onRead(pUserData, fmt_cbSize, sizeof(fmt_cbSize)) != sizeof(fmt_cbSize)) {
+            return 0;    // Expecting more data.
+        }
+        bytesRemaining -= 2;
+
+        fmtOut->extendedSize = drwav__read_u16(fmt_cbSize + 0);
+        if (fmtOut->extendedSize > chunkSize - 18) {
+            return 0;    // cbSize is larger than the chunk.
+        }
 
-            fmtOut->extendedSize = drwav__read_u16(fmt_cbSize + 0);
+        if (fmtOut->formatTag == DR_WAVE_FORMAT_EXTENSIBLE)
+        {
             if (fmtOut->extendedSize != 22) {
                 return 0;    // Expecting cbSize to equal 22.
             }
@@ -340,19 +1175,29 @@ static int drwav__read_fmt(drwav_read_proc onRead, drwav_seek_proc onSeek, void*
             if (onRead(pUserData, fmtext, sizeof(fmtext)) != sizeof(fmtext)) {
                 return 0;    // Expecting more data.
             }
+            bytesRemaining -= 22;
 
             fmtOut->validBitsPerSample = drwav__read_u16(fmtext + 0);
             fmtOut->channelMask        = drwav__read_u32(fmtext + 2);
             drwav__read_guid(fmtext + 6, fmtOut->subFormat);
         }
-    } else {
-        fmtOut->extendedSize       = 0;
-        fmtOut->validBitsPerSample = 0;
-        fmtOut->channelMask        = 0;
-        memset(fmtOut->subFormat, 0, sizeof(fmtOut->subFormat));
+        else
+        {
+            unsigned int extraSize = fmtOut->extendedSize;
+            if (extraSize > extraOutCapacity) {
+                extraSize = extraOutCapacity;
+            }
+
+            if (onRead(pUserData, pExtraOut, extraSize) != extraSize) {
+                return 0;    // Expecting more data.
+            }
+            bytesRemaining -= extraSize;
+
+            *pExtraSizeOut = extraSize;
+        }
     }
 
-    return 1;
+    return drwav__seek_forward(onRead, onSeek, bytesRemaining, pUserData);
 }
 
 
@@ -362,588 +1207,4163 @@ static size_t drwav__on_read_stdio(void* pUserData, void* pBufferOut, size_t byt
     return fread(pBufferOut, 1, bytesToRead, (FILE*)pUserData);
 }
 
-static int drwav__on_seek_stdio(void* pUserData, int offset)
+static int drwav__on_seek_stdio(void* pUserData, int64_t offset, drwav_seek_origin origin)
 {
-    return fseek((FILE*)pUserData, offset, SEEK_CUR) == 0;
+#ifdef _MSC_VER
+    return _fseeki64((FILE*)pUserData, offset, (origin == drwav_seek_origin_current) ? SEEK_CUR : SEEK_SET) == 0;
+#else
+    // fseek() takes a long which is only 32 bits on some platforms so large offsets need to be done in pieces.
+    if (offset >= LONG_MIN && offset <= LONG_MAX) {
+        return fseek((FILE*)pUserData, (long)offset, (origin == drwav_seek_origin_current) ? SEEK_CUR : SEEK_SET) == 0;
+    }
+
+    if (origin == drwav_seek_origin_start) {
+        if (offset < 0 || fseek((FILE*)pUserData, LONG_MAX, SEEK_SET) != 0) {
+            return 0;
+        }
+        offset -= LONG_MAX;
+    }
+
+    while (offset != 0)
+    {
+        long offsetThisIteration = (long)((offset > LONG_MAX) ? LONG_MAX : ((offset < -LONG_MAX) ? -LONG_MAX : offset));
+        if (fseek((FILE*)pUserData, offsetThisIteration, SEEK_CUR) != 0) {
+            return 0;
+        }
+
+        offset -= offsetThisIteration;
+    }
+
+    return 1;
+#endif
 }
 
-drwav* drwav_open_file(const char* filename)
+static FILE* drwav__fopen(const char* filename, const char* mode)
 {
     FILE* pFile;
 #ifdef _MSC_VER
-    if (fopen_s(&pFile, filename, "rb") != 0) {
-        return NULL;
+    if (fopen_s(&pFile, filename, mode) != 0) {
+        return 0;
     }
 #else
-    pFile = fopen(filename, "rb");
+    pFile = fopen(filename, mode);
+#endif
+
+    return pFile;
+}
+
+int drwav_init_file(drwav* pWav, const char* filename)
+{
+    FILE* pFile = drwav__fopen(filename, "rb");
     if (pFile == NULL) {
-        return NULL;
+        return 0;
     }
-#endif
 
-    return drwav_open(drwav__on_read_stdio, drwav__on_seek_stdio, pFile);
+    if (!drwav_init(pWav, drwav__on_read_stdio, drwav__on_seek_stdio, pFile)) {
+        fclose(pFile);
+        return 0;
+    }
+
+    return 1;
 }
-#endif  //DR_WAV_NO_STDIO
 
+drwav* drwav_open_file(const char* filename)
+{
+    drwav* pWav = malloc(sizeof(*pWav));
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    if (!drwav_init_file(pWav, filename)) {
+        free(pWav);
+        return 0;
+    }
+
+    return pWav;
+}
 
+#ifdef DRWAV_HAS_READ_AHEAD
+// The read-ahead ring is made up of two halves. The background thread fills whichever half is empty while the consumer reads
+// from the other one. Everything except the buffer contents is protected by <lock>. A half that is marked as full belongs to
+// the consumer, and one that is not belongs to the thread, so the buffers themselves are copied outside of the lock.
 typedef struct
 {
-    // A pointer to the beginning of the data. We use a char as the type here for easy offsetting.
-    const unsigned char* data;
+    FILE* pFile;
+    unsigned char* pBuffer;
+    size_t halfSize;
+
+    size_t halfDataSize[2];
+    int isHalfFull[2];
+    unsigned int readHalf;
+    size_t readOffset;
+    unsigned int fillHalf;
+
+    // The file position of the next byte the consumer will read, and the position the thread will fill from next.
+    uint64_t readPos;
+    uint64_t fillPos;
+
+    // Incremented on every seek that resets the ring so the thread knows to throw away a fill that was in progress.
+    uint32_t generation;
+
+    int atEnd;
+    int stop;
+    int isPrimed;
+    uint32_t underrunCount;
+
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cond;
+    HANDLE hThread;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+#endif
+} drwav__read_ahead;
 
-    // The size of the data.
-    size_t dataSize;
+#ifdef _WIN32
+static void drwav__ra_lock(drwav__read_ahead* pRA)      { EnterCriticalSection(&pRA->lock); }
+static void drwav__ra_unlock(drwav__read_ahead* pRA)    { LeaveCriticalSection(&pRA->lock); }
+static void drwav__ra_wait(drwav__read_ahead* pRA)      { SleepConditionVariableCS(&pRA->cond, &pRA->lock, INFINITE); }
+static void drwav__ra_broadcast(drwav__read_ahead* pRA) { WakeAllConditionVariable(&pRA->cond); }
+#else
+static void drwav__ra_lock(drwav__read_ahead* pRA)      { pthread_mutex_lock(&pRA->lock); }
+static void drwav__ra_unlock(drwav__read_ahead* pRA)    { pthread_mutex_unlock(&pRA->lock); }
+static void drwav__ra_wait(drwav__read_ahead* pRA)      { pthread_cond_wait(&pRA->cond, &pRA->lock); }
+static void drwav__ra_broadcast(drwav__read_ahead* pRA) { pthread_cond_broadcast(&pRA->cond); }
+#endif
 
-    // The position we're currently sitting at.
-    size_t currentReadPos;
+static void drwav__read_ahead_thread(drwav__read_ahead* pRA)
+{
+    uint64_t filePos = 0;
 
-} drwav_memory;
+    drwav__ra_lock(pRA);
+    for (;;)
+    {
+        while (!pRA->stop && (pRA->atEnd || pRA->isHalfFull[pRA->fillHalf])) {
+            drwav__ra_wait(pRA);
+        }
 
-static size_t drwav__on_read_memory(void* pUserData, void* pBufferOut, size_t bytesToRead)
-{
-    drwav_memory* memory = pUserData;
-    assert(memory != NULL);
-    assert(memory->dataSize >= memory->currentReadPos);
+        if (pRA->stop) {
+            break;
+        }
 
-    size_t bytesRemaining = memory->dataSize - memory->currentReadPos;
-    if (bytesToRead > bytesRemaining) {
-        bytesToRead = bytesRemaining;
-    }
+        unsigned int half = pRA->fillHalf;
+        uint32_t generation = pRA->generation;
+        uint64_t fillPos = pRA->fillPos;
+        drwav__ra_unlock(pRA);
 
-    if (bytesToRead > 0) {
-        memcpy(pBufferOut, memory->data + memory->currentReadPos, bytesToRead);
-        memory->currentReadPos += bytesToRead;
+        size_t bytesRead = 0;
+        if (filePos == fillPos || drwav__on_seek_stdio(pRA->pFile, (int64_t)fillPos, drwav_seek_origin_start)) {
+            bytesRead = fread(pRA->pBuffer + half*pRA->halfSize, 1, pRA->halfSize, pRA->pFile);
+            filePos = fillPos + bytesRead;
+        } else {
+            filePos = (uint64_t)-1; // Unknown.
+        }
+
+        drwav__ra_lock(pRA);
+        if (generation == pRA->generation) {
+            pRA->halfDataSize[half] = bytesRead;
+            pRA->isHalfFull[half] = 1;
+            pRA->fillHalf = half ^ 1;
+            pRA->fillPos += bytesRead;
+            if (bytesRead < pRA->halfSize) {
+                pRA->atEnd = 1;
+            }
+
+            drwav__ra_broadcast(pRA);
+        }
     }
+    drwav__ra_unlock(pRA);
+}
 
-    return bytesToRead;
+#ifdef _WIN32
+static DWORD WINAPI drwav__read_ahead_thread_win32(LPVOID pData)
+{
+    drwav__read_ahead_thread((drwav__read_ahead*)pData);
+    return 0;
 }
+#else
+static void* drwav__read_ahead_thread_posix(void* pData)
+{
+    drwav__read_ahead_thread((drwav__read_ahead*)pData);
+    return NULL;
+}
+#endif
 
-static int drwav__on_seek_memory(void* pUserData, int offset)
+static size_t drwav__on_read_ahead(void* pUserData, void* pBufferOut, size_t bytesToRead)
 {
-    drwav_memory* memory = pUserData;
-    assert(memory != NULL);
+    drwav__read_ahead* pRA = (drwav__read_ahead*)pUserData;
+    unsigned char* pRunningBufferOut = (unsigned char*)pBufferOut;
+    int hasUnderrun = 0;
 
-    if (offset > 0) {
-        if (memory->currentReadPos + offset > memory->dataSize) {
-            offset = (int)(memory->dataSize - memory->currentReadPos);      // Trying to seek too far forward.
+    size_t totalBytesRead = 0;
+    drwav__ra_lock(pRA);
+    while (totalBytesRead < bytesToRead)
+    {
+        unsigned int half = pRA->readHalf;
+        if (pRA->isHalfFull[half])
+        {
+            size_t bytesToCopy = pRA->halfDataSize[half] - pRA->readOffset;
+            if (bytesToCopy > bytesToRead - totalBytesRead) {
+                bytesToCopy = bytesToRead - totalBytesRead;
+            }
+
+            // The half is ours while it's marked as full so it can be copied without holding the lock.
+            size_t readOffset = pRA->readOffset;
+            drwav__ra_unlock(pRA);
+            memcpy(pRunningBufferOut, pRA->pBuffer + half*pRA->halfSize + readOffset, bytesToCopy);
+            drwav__ra_lock(pRA);
+
+            pRunningBufferOut += bytesToCopy;
+            totalBytesRead    += bytesToCopy;
+            pRA->readOffset   += bytesToCopy;
+            pRA->readPos      += bytesToCopy;
+
+            if (pRA->readOffset == pRA->halfDataSize[half]) {
+                // Hand the half back to the thread.
+                pRA->isHalfFull[half] = 0;
+                pRA->readHalf   = half ^ 1;
+                pRA->readOffset = 0;
+                drwav__ra_broadcast(pRA);
+
+                if (pRA->halfDataSize[half] < pRA->halfSize) {
+                    break;  // That was the end of the file.
+                }
+            }
+
+            continue;
         }
-    } else {
-        if (memory->currentReadPos < (size_t)-offset) {
-            offset = -(int)memory->currentReadPos;                          // Trying to seek too far backwards.
+
+        if (pRA->atEnd) {
+            break;
         }
-    }
 
-    // This will never underflow thanks to the clamps above.
-    memory->currentReadPos += offset;
+        // The thread hasn't caught up. This is only an underrun if the ring has been filled before - the first read after
+        // opening or seeking always has to wait.
+        if (pRA->isPrimed && !hasUnderrun) {
+            pRA->underrunCount += 1;
+            hasUnderrun = 1;
+        }
 
-    return 1;
-}
+        drwav__ra_wait(pRA);
+    }
 
-drwav* drwav_open_memory(const void* data, size_t dataSize)
-{
-    drwav_memory* pUserData = malloc(sizeof(*pUserData));
-    if (pUserData == NULL) {
-        return NULL;
+    if (totalBytesRead > 0) {
+        pRA->isPrimed = 1;
     }
+    drwav__ra_unlock(pRA);
 
-    pUserData->data = data;
-    pUserData->dataSize = dataSize;
-    pUserData->currentReadPos = 0;
-    return drwav_open(drwav__on_read_memory, drwav__on_seek_memory, pUserData);
+    return totalBytesRead;
 }
 
-
-drwav* drwav_open(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData)
+static int drwav__on_seek_read_ahead(void* pUserData, int64_t offset, drwav_seek_origin origin)
 {
-    if (onRead == NULL || onSeek == NULL) {
-        return NULL;
-    }
+    drwav__read_ahead* pRA = (drwav__read_ahead*)pUserData;
 
+    drwav__ra_lock(pRA);
 
-    // The first 12 bytes should be the RIFF chunk.
-    unsigned char riff[12];
-    if (onRead(pUserData, riff, sizeof(riff)) != sizeof(riff)) {
-        return NULL;    // Failed to read data.
+    int64_t targetPos = offset;
+    if (origin == drwav_seek_origin_current) {
+        targetPos = (int64_t)pRA->readPos + offset;
     }
 
-    if (riff[0] != 'R' || riff[1] != 'I' || riff[2] != 'F' || riff[3] != 'F') {
-        return NULL;    // Expecting "RIFF".
+    if (targetPos < 0) {
+        drwav__ra_unlock(pRA);
+        return 0;
     }
 
-    unsigned int chunkSize = drwav__read_u32(riff + 4);
-    if (chunkSize < 36) {
-        return NULL;    // Chunk size should always be at least 36 bytes.
+    // Seeks that land inside the half currently being read, such as skipping over small chunks, don't need to touch the file.
+    unsigned int half = pRA->readHalf;
+    uint64_t halfStartPos = pRA->readPos - pRA->readOffset;
+    if (pRA->isHalfFull[half] && (uint64_t)targetPos >= halfStartPos && (uint64_t)targetPos < halfStartPos + pRA->halfDataSize[half]) {
+        pRA->readOffset = (size_t)((uint64_t)targetPos - halfStartPos);
+        pRA->readPos    = (uint64_t)targetPos;
+        drwav__ra_unlock(pRA);
+        return 1;
     }
 
-    if (riff[8] != 'W' || riff[9] != 'A' || riff[10] != 'V' || riff[11] != 'E') {
-        return NULL;    // Expecting "WAVE".
-    }
+    // Anything else resets the ring and the thread starts filling from the new position.
+    pRA->generation   += 1;
+    pRA->isHalfFull[0] = 0;
+    pRA->isHalfFull[1] = 0;
+    pRA->readHalf      = 0;
+    pRA->readOffset    = 0;
+    pRA->fillHalf      = 0;
+    pRA->readPos       = (uint64_t)targetPos;
+    pRA->fillPos       = (uint64_t)targetPos;
+    pRA->atEnd         = 0;
+    pRA->isPrimed      = 0;
+    drwav__ra_broadcast(pRA);
+
+    drwav__ra_unlock(pRA);
+    return 1;
+}
 
+static void drwav__read_ahead_uninit(drwav__read_ahead* pRA)
+{
+    drwav__ra_lock(pRA);
+    pRA->stop = 1;
+    drwav__ra_broadcast(pRA);
+    drwav__ra_unlock(pRA);
+
+#ifdef _WIN32
+    WaitForSingleObject(pRA->hThread, INFINITE);
+    CloseHandle(pRA->hThread);
+    DeleteCriticalSection(&pRA->lock);
+#else
+    pthread_join(pRA->thread, NULL);
+    pthread_cond_destroy(&pRA->cond);
+    pthread_mutex_destroy(&pRA->lock);
+#endif
 
+    fclose(pRA->pFile);
+    free(pRA);
+}
 
-    // The next 24 bytes should be the "fmt " chunk.
-    drwav_fmt fmt;
-    if (!drwav__read_fmt(onRead, onSeek, pUserData, &fmt)) {
-        return NULL;    // Failed to read the "fmt " chunk.
+int drwav_init_file_read_ahead(drwav* pWav, const char* filename, size_t bufferSizeInBytes)
+{
+    if (pWav == NULL) {
+        return 0;
     }
 
-
-    // Translate the internal format.
-    unsigned short translatedFormatTag = fmt.formatTag;
-    if (translatedFormatTag == DR_WAVE_FORMAT_EXTENSIBLE) {
-        translatedFormatTag = drwav__read_u16(fmt.subFormat + 0);
+    if (bufferSizeInBytes == 0) {
+        bufferSizeInBytes = DR_WAV_READ_AHEAD_BUFFER_SIZE;
     }
 
+    size_t halfSize = bufferSizeInBytes / 2;
+    if (halfSize == 0) {
+        halfSize = 1;
+    }
 
-    // The next chunk we care about is the "data" chunk. This is not necessarily the next chunk so we'll need to loop.
-    uint64_t dataSize;
-    for (;;)
-    {
-        unsigned char chunk[8];
-        if (onRead(pUserData, chunk, sizeof(chunk)) != sizeof(chunk)) {
-            return NULL;    // Failed to read data. Probably reached the end.
-        }
+    // The ring buffer is allocated with the state so it can all be freed in one go.
+    drwav__read_ahead* pRA = (drwav__read_ahead*)calloc(1, sizeof(*pRA) + halfSize*2);
+    if (pRA == NULL) {
+        return 0;
+    }
 
-        dataSize = drwav__read_u32(chunk + 4);
-        if (chunk[0] == 'd' && chunk[1] == 'a' && chunk[2] == 't' && chunk[3] == 'a') {
-            break;  // We found the data chunk.
-        }
+    pRA->pBuffer  = (unsigned char*)(pRA + 1);
+    pRA->halfSize = halfSize;
 
-        // If we get here it means we didn't find the "data" chunk. Seek past it.
+    pRA->pFile = drwav__fopen(filename, "rb");
+    if (pRA->pFile == NULL) {
+        free(pRA);
+        return 0;
+    }
 
-        // Make sure we seek past the pad byte.
-        if (dataSize % 2 != 0) {
-            dataSize += 1;
-        }
+#ifdef _WIN32
+    InitializeCriticalSection(&pRA->lock);
+    InitializeConditionVariable(&pRA->cond);
+    pRA->hThread = CreateThread(NULL, 0, drwav__read_ahead_thread_win32, pRA, 0, NULL);
+    if (pRA->hThread == NULL) {
+        DeleteCriticalSection(&pRA->lock);
+        fclose(pRA->pFile);
+        free(pRA);
+        return 0;
+    }
+#else
+    if (pthread_mutex_init(&pRA->lock, NULL) != 0) {
+        fclose(pRA->pFile);
+        free(pRA);
+        return 0;
+    }
 
-        uint64_t bytesRemainingToSeek = dataSize;
-        while (bytesRemainingToSeek > 0) {
-            if (bytesRemainingToSeek > 0x7FFFFFFF) {
-                if (!onSeek(pUserData, 0x7FFFFFFF)) {
-                    return NULL;
-                }
+    if (pthread_cond_init(&pRA->cond, NULL) != 0) {
+        pthread_mutex_destroy(&pRA->lock);
+        fclose(pRA->pFile);
+        free(pRA);
+        return 0;
+    }
 
-                bytesRemainingToSeek -= 0x7FFFFFFF;
-            } else {
-                if (!onSeek(pUserData, (int)bytesRemainingToSeek)) {
-                    return NULL;
-                }
+    if (pthread_create(&pRA->thread, NULL, drwav__read_ahead_thread_posix, pRA) != 0) {
+        pthread_cond_destroy(&pRA->cond);
+        pthread_mutex_destroy(&pRA->lock);
+        fclose(pRA->pFile);
+        free(pRA);
+        return 0;
+    }
+#endif
 
-                bytesRemainingToSeek = 0;
-            }
-        }
+    if (!drwav_init(pWav, drwav__on_read_ahead, drwav__on_seek_read_ahead, pRA)) {
+        drwav__read_ahead_uninit(pRA);
+        return 0;
     }
 
-    // At this point we should be sitting on the first byte of the raw audio data.
+    return 1;
+}
 
+drwav* drwav_open_file_read_ahead(const char* filename, size_t bufferSizeInBytes)
+{
     drwav* pWav = malloc(sizeof(*pWav));
     if (pWav == NULL) {
-        return NULL;
+        return 0;
     }
 
-    pWav->onRead              = onRead;
-    pWav->onSeek              = onSeek;
-    pWav->pUserData           = pUserData;
-    pWav->fmt                 = fmt;
-    pWav->sampleRate          = fmt.sampleRate;
-    pWav->channels            = fmt.channels;
-    pWav->bitsPerSample       = fmt.bitsPerSample;
-    pWav->bytesPerSample      = (unsigned int)(fmt.blockAlign / fmt.channels);
-    pWav->translatedFormatTag = translatedFormatTag;
-    pWav->totalSampleCount    = dataSize / pWav->bytesPerSample;
-    pWav->bytesRemaining      = dataSize;
+    if (!drwav_init_file_read_ahead(pWav, filename, bufferSizeInBytes)) {
+        free(pWav);
+        return 0;
+    }
 
     return pWav;
 }
 
-void drwav_close(drwav* pWav)
+uint32_t drwav_get_read_ahead_underrun_count(drwav* pWav)
 {
-    if (pWav == NULL) {
-        return;
+    if (pWav == NULL || pWav->onRead != drwav__on_read_ahead) {
+        return 0;
     }
 
-#ifndef DR_WAV_NO_STDIO
-    // If we opened the file with drwav_open_file() we will want to close the file handle. We can know whether or not drwav_open_file()
-    // was used by looking at the onRead and onSeek callbacks.
-    if (pWav->onRead == drwav__on_read_stdio && pWav->onSeek == drwav__on_seek_stdio) {
-        fclose((FILE*)pWav->pUserData);
+    drwav__read_ahead* pRA = (drwav__read_ahead*)pWav->pUserData;
+    drwav__ra_lock(pRA);
+    uint32_t underrunCount = pRA->underrunCount;
+    drwav__ra_unlock(pRA);
+
+    return underrunCount;
+}
+#endif  //DRWAV_HAS_READ_AHEAD
+
+static size_t drwav__on_write_stdio(void* pUserData, const void* pData, size_t bytesToWrite)
+{
+    return fwrite(pData, 1, bytesToWrite, (FILE*)pUserData);
+}
+
+int drwav_init_file_write(drwav* pWav, const char* filename, const drwav_data_format* pFormat)
+{
+    FILE* pFile = drwav__fopen(filename, "wb");
+    if (pFile == NULL) {
+        return 0;
+    }
+
+    if (!drwav_init_write(pWav, pFormat, drwav__on_write_stdio, drwav__on_seek_stdio, pFile)) {
+        fclose(pFile);
+        return 0;
+    }
+
+    return 1;
+}
+
+drwav* drwav_open_file_write(const char* filename, const drwav_data_format* pFormat)
+{
+    FILE* pFile = drwav__fopen(filename, "wb");
+    if (pFile == NULL) {
+        return 0;
+    }
+
+    drwav* pWav = drwav_open_write(pFormat, drwav__on_write_stdio, drwav__on_seek_stdio, pFile);
+    if (pWav == NULL) {
+        fclose(pFile);
+        return 0;
+    }
+
+    return pWav;
+}
+#endif  //DR_WAV_NO_STDIO
+
+
+
+static size_t drwav__on_read_memory(void* pUserData, void* pBufferOut, size_t bytesToRead)
+{
+    drwav_memory* memory = pUserData;
+    assert(memory != NULL);
+    assert(memory->dataSize >= memory->currentReadPos);
+
+    size_t bytesRemaining = memory->dataSize - memory->currentReadPos;
+    if (bytesToRead > bytesRemaining) {
+        bytesToRead = bytesRemaining;
+    }
+
+    if (bytesToRead > 0) {
+        memcpy(pBufferOut, memory->data + memory->currentReadPos, bytesToRead);
+        memory->currentReadPos += bytesToRead;
+    }
+
+    return bytesToRead;
+}
+
+static int drwav__on_seek_memory(void* pUserData, int64_t offset, drwav_seek_origin origin)
+{
+    drwav_memory* memory = pUserData;
+    assert(memory != NULL);
+
+    if (origin == drwav_seek_origin_start) {
+        if (offset < 0) {
+            return 0;
+        }
+
+        if ((uint64_t)offset > memory->dataSize) {
+            memory->currentReadPos = memory->dataSize;                     // Trying to seek too far forward.
+        } else {
+            memory->currentReadPos = (size_t)offset;
+        }
+
+        return 1;
+    }
+
+    if (offset > 0) {
+        if ((uint64_t)offset > memory->dataSize - memory->currentReadPos) {
+            offset = (int64_t)(memory->dataSize - memory->currentReadPos);  // Trying to seek too far forward.
+        }
+    } else {
+        if ((uint64_t)-offset > memory->currentReadPos) {
+            offset = -(int64_t)memory->currentReadPos;                      // Trying to seek too far backwards.
+        }
+    }
+
+    // This will never underflow thanks to the clamps above.
+    memory->currentReadPos = (size_t)(memory->currentReadPos + offset);
+
+    return 1;
+}
+
+int drwav_init_memory(drwav* pWav, const void* data, size_t dataSize)
+{
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    pWav->memoryStream.data = data;
+    pWav->memoryStream.dataSize = dataSize;
+    pWav->memoryStream.currentReadPos = 0;
+    pWav->memoryStream.ownership = drwav_memory_ownership_none;
+    return drwav_init(pWav, drwav__on_read_memory, drwav__on_seek_memory, &pWav->memoryStream);
+}
+
+drwav* drwav_open_memory(const void* data, size_t dataSize)
+{
+    drwav* pWav = malloc(sizeof(*pWav));
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    if (!drwav_init_memory(pWav, data, dataSize)) {
+        free(pWav);
+        return 0;
+    }
+
+    return pWav;
+}
+
+static void drwav__free_memory(drwav_memory* memory)
+{
+    switch (memory->ownership)
+    {
+#ifdef DRWAV_HAS_MMAP
+        case drwav_memory_ownership_mmap:   munmap((void*)memory->data, memory->dataSize); break;
+#endif
+        case drwav_memory_ownership_malloc: free((void*)memory->data);                     break;
+        default: break;
+    }
+
+    memory->ownership = drwav_memory_ownership_none;
+}
+
+#ifndef DR_WAV_NO_STDIO
+int drwav_init_file_mapped(drwav* pWav, const char* filename)
+{
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    drwav_memory* pUserData = &pWav->memoryStream;
+
+#ifdef DRWAV_HAS_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return 0;
+    }
+
+    void* pData = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping holds it's own reference to the file.
+
+    if (pData == MAP_FAILED) {
+        return 0;
+    }
+
+    pUserData->data = pData;
+    pUserData->dataSize = (size_t)info.st_size;
+    pUserData->ownership = drwav_memory_ownership_mmap;
+#else
+    // No mmap() so just load the whole file.
+    FILE* pFile = drwav__fopen(filename, "rb");
+    if (pFile == NULL) {
+        return 0;
+    }
+
+    long fileSize = -1;
+    if (fseek(pFile, 0, SEEK_END) == 0) {
+        fileSize = ftell(pFile);
+    }
+
+    void* pData = (fileSize > 0) ? malloc((size_t)fileSize) : NULL;
+    if (pData == NULL || fseek(pFile, 0, SEEK_SET) != 0 || fread(pData, 1, (size_t)fileSize, pFile) != (size_t)fileSize) {
+        fclose(pFile);
+        free(pData);
+        return 0;
+    }
+
+    fclose(pFile);
+
+    pUserData->data = pData;
+    pUserData->dataSize = (size_t)fileSize;
+    pUserData->ownership = drwav_memory_ownership_malloc;
+#endif
+
+    pUserData->currentReadPos = 0;
+
+    if (!drwav_init(pWav, drwav__on_read_memory, drwav__on_seek_memory, pUserData)) {
+        drwav__free_memory(pUserData);
+        return 0;
+    }
+
+    return 1;
+}
+
+drwav* drwav_open_file_mapped(const char* filename)
+{
+    drwav* pWav = malloc(sizeof(*pWav));
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    if (!drwav_init_file_mapped(pWav, filename)) {
+        free(pWav);
+        return 0;
+    }
+
+    return pWav;
+}
+#endif  //DR_WAV_NO_STDIO
+
+const void* drwav_get_raw_data_pointer(drwav* pWav, uint64_t* pFrameCountOut)
+{
+    if (pFrameCountOut != NULL) {
+        *pFrameCountOut = 0;
+    }
+
+    if (pWav == NULL || pWav->onRead != drwav__on_read_memory || pWav->bytesPerSample == 0) {
+        return 0;
+    }
+
+    drwav_memory* memory = &pWav->memoryStream;
+    if (pWav->dataChunkDataPos > memory->dataSize) {
+        return 0;
+    }
+
+    if (pFrameCountOut != NULL) {
+        // The data chunk may be truncated.
+        uint64_t dataSize = memory->dataSize - pWav->dataChunkDataPos;
+        if (dataSize > pWav->dataChunkDataSize) {
+            dataSize = pWav->dataChunkDataSize;
+        }
+
+        *pFrameCountOut = dataSize / (pWav->bytesPerSample * pWav->channels);
+    }
+
+    return memory->data + pWav->dataChunkDataPos;
+}
+
+
+int drwav_init(drwav* pWav, drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData)
+{
+    if (pWav == NULL || onRead == NULL) {
+        return 0;
+    }
+
+
+    // The first 4 bytes identify the container. Standard RIFF files start with "RIFF", Wave64 files start with a GUID beginning
+    // with "riff" and RF64/BW64 files start with "RF64" or "BW64".
+    drwav_container container;
+    unsigned char riff[40];
+    if (onRead(pUserData, riff, 4) != 4) {
+        return 0;    // Failed to read data.
+    }
+
+    if (drwav__fourcc_equal(riff, "RIFF")) {
+        container = drwav_container_riff;
+    } else if (drwav__fourcc_equal(riff, "riff")) {
+        container = drwav_container_w64;
+    } else if (drwav__fourcc_equal(riff, "RF64") || drwav__fourcc_equal(riff, "BW64")) {
+        container = drwav_container_rf64;
+    } else {
+        return 0;    // Unknown container.
+    }
+
+    // The number of bytes that have been read from the start of the file. This is used to determine the position of the data chunk.
+    uint64_t cursor;
+    if (container == drwav_container_w64) {
+        // The rest of the "riff" GUID, the 8 byte size and then the "wave" GUID.
+        if (onRead(pUserData, riff + 4, 36) != 36) {
+            return 0;    // Failed to read data.
+        }
+
+        if (!drwav__guid_equal(riff, drwavGUID_W64_RIFF)) {
+            return 0;    // Expecting the "riff" GUID.
+        }
+
+        if (drwav__read_u64(riff + 16) < 80) {
+            return 0;    // Chunk size should always be at least 80 bytes.
+        }
+
+        if (!drwav__guid_equal(riff + 24, drwavGUID_W64_WAVE)) {
+            return 0;    // Expecting the "wave" GUID.
+        }
+
+        cursor = 40;
+    } else {
+        if (onRead(pUserData, riff + 4, 8) != 8) {
+            return 0;    // Failed to read data.
+        }
+
+        // RF64 files store their size in the "ds64" chunk instead.
+        if (container == drwav_container_riff && drwav__read_u32(riff + 4) < 36) {
+            return 0;    // Chunk size should always be at least 36 bytes.
+        }
+
+        if (!drwav__fourcc_equal(riff + 8, "WAVE")) {
+            return 0;    // Expecting "WAVE".
+        }
+
+        cursor = 12;
+    }
+
+
+    // RF64 files must have a "ds64" chunk straight after the header. This is where the real size of the data chunk is stored.
+    uint64_t ds64DataSize = 0;
+    if (container == drwav_container_rf64) {
+        drwav__chunk_header header;
+        unsigned int headerSize = drwav__read_chunk_header(onRead, pUserData, container, &header);
+        if (headerSize == 0 || !drwav__fourcc_equal(header.id.fourcc, "ds64") || header.sizeInBytes < 24) {
+            return 0;    // Expecting "ds64".
+        }
+
+        unsigned char ds64[24];
+        if (onRead(pUserData, ds64, sizeof(ds64)) != sizeof(ds64)) {
+            return 0;
+        }
+
+        ds64DataSize = drwav__read_u64(ds64 + 8);
+
+        // Skip past the remainder of the chunk which includes the table of sizes for other chunks. We don't need it.
+        if (!drwav__seek_forward(onRead, onSeek, (header.sizeInBytes - 24) + header.paddingSize, pUserData)) {
+            return 0;
+        }
+
+        cursor += headerSize + header.sizeInBytes + header.paddingSize;
+    }
+
+
+    // We need to find the "fmt " and "data" chunks, with the "fmt " chunk coming first. These are not necessarily next to each
+    // other so we'll need to loop. Compressed formats will also have a "fact" chunk somewhere before the "data" chunk which holds
+    // the number of sample frames.
+    drwav_fmt fmt;
+    unsigned char fmtExtra[4 + DRWAV_MAX_MSADPCM_COEFFS*4];
+    unsigned int fmtExtraSize = 0;
+    int hasFmtChunk = 0;
+    uint64_t dataSize;
+    uint64_t factFrameCount = 0;
+    int hasFactChunk = 0;
+    drwav_chunk chunks[DRWAV_MAX_CHUNKS];
+    unsigned int chunkCount = 0;
+    for (;;)
+    {
+        drwav__chunk_header header;
+        unsigned int headerSize = drwav__read_chunk_header(onRead, pUserData, container, &header);
+        if (headerSize == 0) {
+            return 0;    // Failed to read data. Probably reached the end.
+        }
+
+        cursor += headerSize;
+
+        int isDataChunk = drwav__chunk_is(&header, container, "data", drwavGUID_W64_DATA);
+        if (isDataChunk && container == drwav_container_rf64 && header.sizeInBytes == 0xFFFFFFFF) {
+            header.sizeInBytes = ds64DataSize;
+        }
+
+        if (chunkCount < DRWAV_MAX_CHUNKS) {
+            drwav__init_chunk(&chunks[chunkCount++], &header, container, cursor);
+        }
+
+        if (isDataChunk) {
+            dataSize = header.sizeInBytes;
+
+            // Files that are streamed out as they're written, to a pipe for example, can't go back and fill in the size of the
+            // data chunk. These use 0xFFFFFFFF (or all bits set for Wave64 and RF64) and the data runs to the end of the file.
+            if ((container == drwav_container_riff && dataSize == 0xFFFFFFFF) || dataSize > INT64_MAX) {
+                dataSize = DRWAV_UNKNOWN_DATA_SIZE;
+            }
+
+            break;  // We found the data chunk.
+        }
+
+        if (drwav__chunk_is(&header, container, "fmt ", drwavGUID_W64_FMT)) {
+            if (!drwav__read_fmt(onRead, onSeek, pUserData, &header, &fmt, fmtExtra, sizeof(fmtExtra), &fmtExtraSize)) {
+                return 0;    // Failed to read the "fmt " chunk.
+            }
+
+            hasFmtChunk = 1;
+            cursor += header.sizeInBytes + header.paddingSize;
+            continue;
+        }
+
+        // If we get here it means we didn't find the "data" chunk. Seek past it, making sure we seek past the padding.
+        uint64_t bytesToSkip = header.sizeInBytes + header.paddingSize;
+        cursor += bytesToSkip;
+
+        if (drwav__chunk_is(&header, container, "fact", drwavGUID_W64_FACT) && header.sizeInBytes >= 4) {
+            // Wave64 stores the frame count as 64 bits.
+            unsigned char fact[8];
+            unsigned int factSize = (container == drwav_container_w64 && header.sizeInBytes >= 8) ? 8 : 4;
+            if (onRead(pUserData, fact, factSize) != factSize) {
+                return 0;
+            }
+
+            factFrameCount = (factSize == 8) ? drwav__read_u64(fact) : drwav__read_u32(fact);
+            hasFactChunk = 1;
+            bytesToSkip -= factSize;
+        }
+
+        if (!drwav__seek_forward(onRead, onSeek, bytesToSkip, pUserData)) {
+            return 0;
+        }
+    }
+
+    if (!hasFmtChunk) {
+        return 0;    // The "data" chunk came before the "fmt " chunk.
+    }
+
+    if (fmt.channels == 0) {
+        return 0;    // Invalid channel count.
+    }
+
+
+    // Translate the internal format.
+    unsigned short translatedFormatTag = fmt.formatTag;
+    if (translatedFormatTag == DR_WAVE_FORMAT_EXTENSIBLE) {
+        translatedFormatTag = drwav__read_u16(fmt.subFormat + 0);
+    }
+
+    int isADPCM = translatedFormatTag == DR_WAVE_FORMAT_ADPCM || translatedFormatTag == DR_WAVE_FORMAT_DVI_ADPCM;
+    if (isADPCM) {
+        if (fmt.channels > 2) {
+            return 0;    // Only mono and stereo ADPCM is supported.
+        }
+
+        unsigned int headerSize = ((translatedFormatTag == DR_WAVE_FORMAT_ADPCM) ? 7 : 4) * fmt.channels;
+        if (fmt.blockAlign <= headerSize) {
+            return 0;    // The block is not large enough to hold it's own header.
+        }
+    }
+
+    // At this point we should be sitting on the first byte of the raw audio data.
+
+    pWav->onRead              = onRead;
+    pWav->onSeek              = onSeek;
+    pWav->onWrite             = NULL;
+    pWav->pUserData           = pUserData;
+    pWav->container           = container;
+    pWav->fmt                 = fmt;
+    pWav->sampleRate          = fmt.sampleRate;
+    pWav->channels            = fmt.channels;
+    pWav->bitsPerSample       = fmt.bitsPerSample;
+    pWav->bytesPerSample      = (unsigned int)(fmt.blockAlign / fmt.channels);
+    pWav->translatedFormatTag = translatedFormatTag;
+    pWav->totalSampleCount    = (pWav->bytesPerSample > 0 && dataSize != DRWAV_UNKNOWN_DATA_SIZE) ? dataSize / pWav->bytesPerSample : 0;
+    pWav->bytesRemaining      = dataSize;
+    pWav->dataChunkDataSize   = dataSize;
+    pWav->dataChunkDataPos    = cursor;
+    pWav->chunkCount          = chunkCount;
+    pWav->isChunkIndexComplete = 0;
+    memcpy(pWav->chunks, chunks, chunkCount * sizeof(*chunks));
+    pWav->pWriteBuffer        = NULL;
+    pWav->writeBufferCapacity = 0;
+    pWav->writeBufferSize     = 0;
+    pWav->writeFailed         = 0;
+    pWav->isWriteDitherEnabled = 0;
+    memset(&pWav->compressed, 0, sizeof(pWav->compressed));
+
+    if (isADPCM)
+    {
+        pWav->bytesPerSample = 0;
+
+        if (translatedFormatTag == DR_WAVE_FORMAT_ADPCM) {
+            pWav->compressed.framesPerBlock = ((fmt.blockAlign - 7*fmt.channels) * 2) / fmt.channels + 2;
+
+            // The coefficient table follows the samples-per-block and coefficient count. Fall back to the standard table if
+            // it's missing.
+            unsigned int coeffCount = (fmtExtraSize >= 4) ? drwav__read_u16(fmtExtra + 2) : 0;
+            if (coeffCount > (fmtExtraSize - 4) / 4) {
+                coeffCount = (fmtExtraSize - 4) / 4;
+            }
+
+            if (coeffCount == 0) {
+                static const short standardCoeffs[7][2] = {{256, 0}, {512, -256}, {0, 0}, {192, 64}, {240, 0}, {460, -208}, {392, -232}};
+                memcpy(pWav->compressed.coeffTable, standardCoeffs, sizeof(standardCoeffs));
+                pWav->compressed.coeffCount = 7;
+            } else {
+                for (unsigned int iCoeff = 0; iCoeff < coeffCount; ++iCoeff) {
+                    pWav->compressed.coeffTable[iCoeff][0] = (short)drwav__read_u16(fmtExtra + 4 + iCoeff*4 + 0);
+                    pWav->compressed.coeffTable[iCoeff][1] = (short)drwav__read_u16(fmtExtra + 4 + iCoeff*4 + 2);
+                }
+                pWav->compressed.coeffCount = (unsigned short)coeffCount;
+            }
+        } else {
+            pWav->compressed.framesPerBlock = ((fmt.blockAlign - 4*fmt.channels) / (4*fmt.channels)) * 8 + 1;
+        }
+
+        if (hasFactChunk) {
+            pWav->totalSampleCount = factFrameCount * fmt.channels;
+        } else if (dataSize != DRWAV_UNKNOWN_DATA_SIZE) {
+            pWav->totalSampleCount = drwav__adpcm_frame_count_from_data_size(pWav, dataSize) * fmt.channels;
+        }
+    }
+
+    return 1;
+}
+
+drwav* drwav_open(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserData)
+{
+    drwav* pWav = malloc(sizeof(*pWav));
+    if (pWav == NULL) {
+        return 0;
+    }
+
+    if (!drwav_init(pWav, onRead, onSeek, pUserData)) {
+        free(pWav);
+        return 0;
+    }
+
+    return pWav;
+}
+
+static void drwav__finish_write(drwav* pWav);
+
+void drwav_uninit(drwav* pWav)
+{
+    if (pWav == NULL) {
+        return;
+    }
+
+    if (pWav->onWrite != NULL) {
+        drwav__finish_write(pWav);
+    }
+
+#ifndef DR_WAV_NO_STDIO
+    // If we opened the file with drwav_init_file() or drwav_init_file_write() we will want to close the file handle. We can know
+    // whether or not they were used by looking at the callbacks.
+    if ((pWav->onRead == drwav__on_read_stdio || pWav->onWrite == drwav__on_write_stdio) && pWav->onSeek == drwav__on_seek_stdio) {
+        fclose((FILE*)pWav->pUserData);
+    }
+#endif
+
+#ifdef DRWAV_HAS_READ_AHEAD
+    if (pWav->onRead == drwav__on_read_ahead && pWav->onSeek == drwav__on_seek_read_ahead) {
+        drwav__read_ahead_uninit((drwav__read_ahead*)pWav->pUserData);
+    }
+#endif
+
+    // If we opened the file with drwav_init_file_mapped() we will want to unmap the file, or free it.
+    if (pWav->onRead == drwav__on_read_memory && pWav->onSeek == drwav__on_seek_memory) {
+        drwav__free_memory(&pWav->memoryStream);
+    }
+}
+
+void drwav_close(drwav* pWav)
+{
+    drwav_uninit(pWav);
+    free(pWav);
+}
+
+
+size_t drwav_read_raw(drwav* pWav, void* pBufferOut, size_t bytesToRead)
+{
+    if (pWav == NULL || pWav->onRead == NULL || bytesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (bytesToRead > pWav->bytesRemaining) {
+        bytesToRead = (size_t)pWav->bytesRemaining;
+    }
+
+    size_t bytesRead = pWav->onRead(pWav->pUserData, pBufferOut, bytesToRead);
+
+    pWav->bytesRemaining -= bytesRead;
+    return bytesRead;
+}
+
+size_t drwav_read(drwav* pWav, size_t samplesToRead, void* pBufferOut, size_t bufferOutSize)
+{
+    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    // Variable sized samples (ADPCM) can't be read with this function.
+    if (pWav->bytesPerSample == 0) {
+        return 0;
+    }
+
+    size_t maxSamples = bufferOutSize / pWav->bytesPerSample;
+    if (samplesToRead > maxSamples) {
+        samplesToRead = maxSamples;
+    }
+
+    size_t bytesRead = drwav_read_raw(pWav, pBufferOut, samplesToRead * pWav->bytesPerSample);
+
+    return bytesRead / pWav->bytesPerSample;
+}
+
+static int drwav__seek_to_data_byte(drwav* pWav, uint64_t targetBytePos)
+{
+    assert(pWav->dataChunkDataSize >= pWav->bytesRemaining);
+    assert(pWav->dataChunkDataSize >= targetBytePos);
+
+    uint64_t currentBytePos = pWav->dataChunkDataSize - pWav->bytesRemaining;
+    if (currentBytePos == targetBytePos) {
+        return 1;
+    }
+
+    if (!pWav->onSeek(pWav->pUserData, (int64_t)(pWav->dataChunkDataPos + targetBytePos), drwav_seek_origin_start)) {
+        return 0;
+    }
+
+    pWav->bytesRemaining = pWav->dataChunkDataSize - targetBytePos;
+    return 1;
+}
+
+#ifndef DR_WAV_NO_CONVERSION_API
+static int drwav__seek_adpcm(drwav* pWav, uint64_t sample);
+#endif
+
+int drwav_seek(drwav* pWav, uint64_t sample)
+{
+    // Seeking should be compatible with wave files > 2GB.
+
+    if (pWav == NULL || pWav->onSeek == NULL || pWav->onWrite != NULL) {
+        return 0;
+    }
+
+    // Without a known length there's nothing to clamp against. Seeking past the end is fine - reading will just return 0.
+    if (pWav->totalSampleCount == 0 && pWav->dataChunkDataSize == DRWAV_UNKNOWN_DATA_SIZE) {
+        if (pWav->bytesPerSample == 0 || sample > (uint64_t)(INT64_MAX - pWav->dataChunkDataPos) / pWav->bytesPerSample) {
+            return 0;   // Compressed formats need to know where the last block ends.
+        }
+
+        return drwav__seek_to_data_byte(pWav, sample * pWav->bytesPerSample);
+    }
+
+    // If there are no samples, just return true without doing anything.
+    if (pWav->totalSampleCount == 0) {
+        return 1;
+    }
+
+    // Make sure the sample is clamped.
+    if (sample >= pWav->totalSampleCount) {
+        sample = pWav->totalSampleCount - 1;
+    }
+
+    // Compressed formats need to seek to the start of a block and then decode up to the sample.
+    if (pWav->bytesPerSample == 0) {
+#ifndef DR_WAV_NO_CONVERSION_API
+        return drwav__seek_adpcm(pWav, sample);
+#else
+        return 0;
+#endif
+    }
+
+    return drwav__seek_to_data_byte(pWav, sample * pWav->bytesPerSample);
+}
+
+
+static uint64_t drwav__current_file_pos(drwav* pWav)
+{
+    return pWav->dataChunkDataPos + (pWav->dataChunkDataSize - pWav->bytesRemaining);
+}
+
+// Scans the chunks following the "data" chunk and adds them to the index. The read position is restored afterwards.
+static void drwav__complete_chunk_index(drwav* pWav)
+{
+    pWav->isChunkIndexComplete = 1;
+
+    // Streams of unknown length have nothing after the data chunk that we can find.
+    if (pWav->onSeek == NULL || pWav->onRead == NULL || pWav->chunkCount == DRWAV_MAX_CHUNKS || pWav->dataChunkDataSize == DRWAV_UNKNOWN_DATA_SIZE) {
+        return;
+    }
+
+    unsigned int padding = (unsigned int)((pWav->container == drwav_container_w64) ? ((8 - (pWav->dataChunkDataSize % 8)) % 8) : (pWav->dataChunkDataSize % 2));
+    uint64_t cursor = pWav->dataChunkDataPos + pWav->dataChunkDataSize + padding;
+    uint64_t originalPos = drwav__current_file_pos(pWav);
+
+    if (cursor <= INT64_MAX && pWav->onSeek(pWav->pUserData, (int64_t)cursor, drwav_seek_origin_start)) {
+        while (pWav->chunkCount < DRWAV_MAX_CHUNKS)
+        {
+            drwav__chunk_header header;
+            unsigned int headerSize = drwav__read_chunk_header(pWav->onRead, pWav->pUserData, pWav->container, &header);
+            if (headerSize == 0) {
+                break;  // Reached the end.
+            }
+
+            cursor += headerSize;
+            drwav__init_chunk(&pWav->chunks[pWav->chunkCount++], &header, pWav->container, cursor);
+
+            cursor += header.sizeInBytes + header.paddingSize;
+            if (!drwav__seek_forward(pWav->onRead, pWav->onSeek, header.sizeInBytes + header.paddingSize, pWav->pUserData)) {
+                break;
+            }
+        }
+    }
+
+    pWav->onSeek(pWav->pUserData, (int64_t)originalPos, drwav_seek_origin_start);
+}
+
+const drwav_chunk* drwav_find_chunk(drwav* pWav, const char* fourcc)
+{
+    if (pWav == NULL || fourcc == NULL) {
+        return 0;
+    }
+
+    // Chunk IDs are stored padded with zeros to 16 bytes so they can always be compared in full.
+    unsigned char id[16];
+    memset(id, 0, sizeof(id));
+    if (pWav->container == drwav_container_w64) {
+        if (drwav__fourcc_equal((const unsigned char*)"LIST", fourcc)) {
+            memcpy(id, drwavGUID_W64_LIST, 16);
+        } else {
+            memcpy(id, fourcc, 4);
+            memcpy(id + 4, drwavGUID_W64_FMT + 4, 12);
+        }
+    } else {
+        memcpy(id, fourcc, 4);
+    }
+
+    for (;;)
+    {
+        for (unsigned int iChunk = 0; iChunk < pWav->chunkCount; ++iChunk) {
+            if (drwav__guid_equal(pWav->chunks[iChunk].id, id)) {
+                return &pWav->chunks[iChunk];
+            }
+        }
+
+        if (pWav->isChunkIndexComplete) {
+            return 0;
+        }
+
+        drwav__complete_chunk_index(pWav);
+    }
+}
+
+size_t drwav_read_chunk_data(drwav* pWav, const drwav_chunk* pChunk, uint64_t offset, void* pBufferOut, size_t bytesToRead)
+{
+    if (pWav == NULL || pWav->onRead == NULL || pWav->onSeek == NULL || pChunk == NULL || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (offset >= pChunk->dataSize) {
+        return 0;
+    }
+
+    if (bytesToRead > pChunk->dataSize - offset) {
+        bytesToRead = (size_t)(pChunk->dataSize - offset);
+    }
+
+    uint64_t originalPos = drwav__current_file_pos(pWav);
+    if (!pWav->onSeek(pWav->pUserData, (int64_t)(pChunk->dataPos + offset), drwav_seek_origin_start)) {
+        return 0;
+    }
+
+    size_t bytesRead = pWav->onRead(pWav->pUserData, pBufferOut, bytesToRead);
+
+    pWav->onSeek(pWav->pUserData, (int64_t)originalPos, drwav_seek_origin_start);
+    return bytesRead;
+}
+
+uint32_t drwav_get_cue_points(drwav* pWav, drwav_cue_point* pCuePointsOut, uint32_t maxCount)
+{
+    const drwav_chunk* pChunk = drwav_find_chunk(pWav, "cue ");
+    if (pChunk == NULL) {
+        return 0;
+    }
+
+    unsigned char header[4];
+    if (drwav_read_chunk_data(pWav, pChunk, 0, header, sizeof(header)) != sizeof(header)) {
+        return 0;
+    }
+
+    uint32_t count = drwav__read_u32(header);
+    if (pCuePointsOut == NULL) {
+        return count;
+    }
+
+    uint32_t countToRead = (count < maxCount) ? count : maxCount;
+    for (uint32_t iCuePoint = 0; iCuePoint < countToRead; ++iCuePoint) {
+        unsigned char cue[24];
+        if (drwav_read_chunk_data(pWav, pChunk, 4 + iCuePoint*24, cue, sizeof(cue)) != sizeof(cue)) {
+            return iCuePoint;
+        }
+
+        pCuePointsOut[iCuePoint].id           = drwav__read_u32(cue + 0);
+        pCuePointsOut[iCuePoint].position     = drwav__read_u32(cue + 4);
+        memcpy(pCuePointsOut[iCuePoint].dataChunkId, cue + 8, 4);
+        pCuePointsOut[iCuePoint].chunkStart   = drwav__read_u32(cue + 12);
+        pCuePointsOut[iCuePoint].blockStart   = drwav__read_u32(cue + 16);
+        pCuePointsOut[iCuePoint].sampleOffset = drwav__read_u32(cue + 20);
+    }
+
+    return count;
+}
+
+uint32_t drwav_get_smpl_loops(drwav* pWav, drwav_smpl_loop* pLoopsOut, uint32_t maxCount)
+{
+    const drwav_chunk* pChunk = drwav_find_chunk(pWav, "smpl");
+    if (pChunk == NULL) {
+        return 0;
+    }
+
+    // The loop count is the 8th field of the 36 byte header, followed by the size of the sampler specific data which comes after
+    // the loops.
+    unsigned char header[8];
+    if (drwav_read_chunk_data(pWav, pChunk, 28, header, sizeof(header)) != sizeof(header)) {
+        return 0;
+    }
+
+    uint32_t count = drwav__read_u32(header);
+    if (pLoopsOut == NULL) {
+        return count;
+    }
+
+    uint32_t countToRead = (count < maxCount) ? count : maxCount;
+    for (uint32_t iLoop = 0; iLoop < countToRead; ++iLoop) {
+        unsigned char loop[24];
+        if (drwav_read_chunk_data(pWav, pChunk, 36 + iLoop*24, loop, sizeof(loop)) != sizeof(loop)) {
+            return iLoop;
+        }
+
+        pLoopsOut[iLoop].cuePointId = drwav__read_u32(loop + 0);
+        pLoopsOut[iLoop].type       = drwav__read_u32(loop + 4);
+        pLoopsOut[iLoop].start      = drwav__read_u32(loop + 8);
+        pLoopsOut[iLoop].end        = drwav__read_u32(loop + 12);
+        pLoopsOut[iLoop].fraction   = drwav__read_u32(loop + 16);
+        pLoopsOut[iLoop].playCount  = drwav__read_u32(loop + 20);
+    }
+
+    return count;
+}
+
+size_t drwav_get_info_string(drwav* pWav, const char* infoId, char* pStringOut, size_t stringOutSize)
+{
+    if (pStringOut != NULL && stringOutSize > 0) {
+        pStringOut[0] = '\0';
+    }
+
+    if (pWav == NULL || infoId == NULL || pWav->container == drwav_container_w64) {
+        return 0;
+    }
+
+    // There can be more than one LIST chunk, but "INFO" is the only list type we care about. We only look at the first one.
+    const drwav_chunk* pChunk = drwav_find_chunk(pWav, "LIST");
+    if (pChunk == NULL) {
+        return 0;
+    }
+
+    unsigned char listType[4];
+    if (drwav_read_chunk_data(pWav, pChunk, 0, listType, sizeof(listType)) != sizeof(listType) || !drwav__fourcc_equal(listType, "INFO")) {
+        return 0;
+    }
+
+    // Only the sub-chunk headers are read until we find the one we're looking for.
+    uint64_t offset = 4;
+    while (offset + 8 <= pChunk->dataSize)
+    {
+        unsigned char subchunk[8];
+        if (drwav_read_chunk_data(pWav, pChunk, offset, subchunk, sizeof(subchunk)) != sizeof(subchunk)) {
+            return 0;
+        }
+
+        uint32_t subchunkSize = drwav__read_u32(subchunk + 4);
+        if (drwav__fourcc_equal(subchunk, infoId)) {
+            // Strings are normally null terminated in the file. The terminator is not included in the length.
+            size_t length = subchunkSize;
+            while (length > 0) {
+                char c;
+                if (drwav_read_chunk_data(pWav, pChunk, offset + 8 + length - 1, &c, 1) != 1 || c != '\0') {
+                    break;
+                }
+                length -= 1;
+            }
+
+            if (pStringOut != NULL && stringOutSize > 0) {
+                size_t bytesToRead = (length < stringOutSize - 1) ? length : stringOutSize - 1;
+                size_t bytesRead = drwav_read_chunk_data(pWav, pChunk, offset + 8, pStringOut, bytesToRead);
+                pStringOut[bytesRead] = '\0';
+            }
+
+            return length;
+        }
+
+        offset += 8 + subchunkSize + (subchunkSize % 2);
+    }
+
+    return 0;
+}
+
+static void drwav__copy_bext_string(char* pDst, const unsigned char* pSrc, size_t maxLength)
+{
+    size_t i = 0;
+    for (; i < maxLength && pSrc[i] != '\0'; ++i) {
+        pDst[i] = (char)pSrc[i];
+    }
+    pDst[i] = '\0';
+}
+
+int drwav_get_bext(drwav* pWav, drwav_bext* pBextOut)
+{
+    if (pBextOut == NULL) {
+        return 0;
+    }
+
+    memset(pBextOut, 0, sizeof(*pBextOut));
+
+    const drwav_chunk* pChunk = drwav_find_chunk(pWav, "bext");
+    if (pChunk == NULL || pChunk->dataSize < 602) {
+        return 0;
+    }
+
+    unsigned char bext[602];
+    if (drwav_read_chunk_data(pWav, pChunk, 0, bext, sizeof(bext)) != sizeof(bext)) {
+        return 0;
+    }
+
+    drwav__copy_bext_string(pBextOut->description,         bext +   0, 256);
+    drwav__copy_bext_string(pBextOut->originator,          bext + 256, 32);
+    drwav__copy_bext_string(pBextOut->originatorReference, bext + 288, 32);
+    drwav__copy_bext_string(pBextOut->originationDate,     bext + 320, 10);
+    drwav__copy_bext_string(pBextOut->originationTime,     bext + 330, 8);
+    pBextOut->timeReference = drwav__read_u64(bext + 338);
+    pBextOut->version       = drwav__read_u16(bext + 346);
+    memcpy(pBextOut->umid, bext + 348, 64);
+    pBextOut->loudnessValue        = (short)drwav__read_u16(bext + 412);
+    pBextOut->loudnessRange        = (short)drwav__read_u16(bext + 414);
+    pBextOut->maxTruePeakLevel     = (short)drwav__read_u16(bext + 416);
+    pBextOut->maxMomentaryLoudness = (short)drwav__read_u16(bext + 418);
+    pBextOut->maxShortTermLoudness = (short)drwav__read_u16(bext + 420);
+    pBextOut->codingHistoryOffset  = 602;
+    pBextOut->codingHistorySize    = pChunk->dataSize - 602;
+
+    return 1;
+}
+
+
+static void drwav__put_u16(unsigned char* data, unsigned int value)
+{
+    data[0] = (unsigned char)((value >> 0) & 0xFF);
+    data[1] = (unsigned char)((value >> 8) & 0xFF);
+}
+
+static void drwav__put_u32(unsigned char* data, unsigned int value)
+{
+    data[0] = (unsigned char)((value >>  0) & 0xFF);
+    data[1] = (unsigned char)((value >>  8) & 0xFF);
+    data[2] = (unsigned char)((value >> 16) & 0xFF);
+    data[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+static void drwav__put_u64(unsigned char* data, uint64_t value)
+{
+    drwav__put_u32(data + 0, (unsigned int)(value & 0xFFFFFFFF));
+    drwav__put_u32(data + 4, (unsigned int)(value >> 32));
+}
+
+// The channel mask to assume for files that don't specify one.
+static unsigned int drwav__default_channel_mask(unsigned int channels)
+{
+    switch (channels)
+    {
+        case 1: return DR_WAVE_SPEAKER_FRONT_CENTER;
+        case 2: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT;
+        case 3: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_FRONT_CENTER;
+        case 4: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_BACK_LEFT | DR_WAVE_SPEAKER_BACK_RIGHT;
+        case 5: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_FRONT_CENTER | DR_WAVE_SPEAKER_BACK_LEFT | DR_WAVE_SPEAKER_BACK_RIGHT;
+        case 6: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_FRONT_CENTER | DR_WAVE_SPEAKER_LOW_FREQUENCY | DR_WAVE_SPEAKER_BACK_LEFT | DR_WAVE_SPEAKER_BACK_RIGHT;
+        case 7: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_FRONT_CENTER | DR_WAVE_SPEAKER_LOW_FREQUENCY | DR_WAVE_SPEAKER_BACK_CENTER | DR_WAVE_SPEAKER_SIDE_LEFT | DR_WAVE_SPEAKER_SIDE_RIGHT;
+        case 8: return DR_WAVE_SPEAKER_FRONT_LEFT | DR_WAVE_SPEAKER_FRONT_RIGHT | DR_WAVE_SPEAKER_FRONT_CENTER | DR_WAVE_SPEAKER_LOW_FREQUENCY | DR_WAVE_SPEAKER_BACK_LEFT | DR_WAVE_SPEAKER_BACK_RIGHT | DR_WAVE_SPEAKER_SIDE_LEFT | DR_WAVE_SPEAKER_SIDE_RIGHT;
+        default: return 0;
+    }
+}
+
+// The size of the data in the placeholder chunk that is written in front of the "fmt " chunk of RIFF files. This is exactly the
+// size of a "ds64" chunk without a table so that it can be replaced in place if the file needs to be promoted to RF64.
+#define DRWAV_DS64_DATA_SIZE    28
+
+int drwav_init_write(drwav* pWav, const drwav_data_format* pFormat, drwav_write_proc onWrite, drwav_seek_proc onSeek, void* pUserData)
+{
+    if (pWav == NULL || pFormat == NULL || onWrite == NULL) {
+        return 0;
+    }
+
+    if (pFormat->channels == 0 || pFormat->channels > 0xFFFF || pFormat->bitsPerSample == 0 || (pFormat->bitsPerSample % 8) != 0) {
+        return 0;    // Invalid format.
+    }
+
+    if (pFormat->format != DR_WAVE_FORMAT_PCM && pFormat->format != DR_WAVE_FORMAT_IEEE_FLOAT && pFormat->format != DR_WAVE_FORMAT_ALAW && pFormat->format != DR_WAVE_FORMAT_MULAW) {
+        return 0;    // Only uncompressed formats can be written.
+    }
+
+    unsigned int blockAlign = pFormat->channels * (pFormat->bitsPerSample / 8);
+    if (blockAlign > 0xFFFF) {
+        return 0;
+    }
+
+    // Non-PCM formats need the cbSize member, and WAVE_FORMAT_EXTENSIBLE needs another 22 bytes on top of that.
+    int isExtensible = pFormat->channels > 2 || (pFormat->format == DR_WAVE_FORMAT_PCM && pFormat->bitsPerSample > 16);
+    unsigned int formatTag = isExtensible ? DR_WAVE_FORMAT_EXTENSIBLE : pFormat->format;
+    unsigned int fmtSize = isExtensible ? 40 : ((pFormat->format == DR_WAVE_FORMAT_PCM) ? 16 : 18);
+    unsigned int channelMask = isExtensible ? drwav__default_channel_mask(pFormat->channels) : 0;
+
+    unsigned char header[256];
+    size_t headerSize = 0;
+    if (pFormat->container == drwav_container_w64) {
+        memcpy(header + 0, drwavGUID_W64_RIFF, 16);
+        drwav__put_u64(header + 16, 0xFFFFFFFFFFFFFFFFULL); // Set when the file is closed.
+        memcpy(header + 24, drwavGUID_W64_WAVE, 16);
+        memcpy(header + 40, drwavGUID_W64_FMT, 16);
+        drwav__put_u64(header + 56, 24 + fmtSize);
+        headerSize = 64;
+    } else {
+        memcpy(header + 0, "RIFF", 4);
+        drwav__put_u32(header + 4, 0xFFFFFFFF);             // Set when the file is closed.
+        memcpy(header + 8, "WAVE", 4);
+        memcpy(header + 12, "JUNK", 4);
+        drwav__put_u32(header + 16, DRWAV_DS64_DATA_SIZE);
+        memset(header + 20, 0, DRWAV_DS64_DATA_SIZE);
+        memcpy(header + 20 + DRWAV_DS64_DATA_SIZE, "fmt ", 4);
+        drwav__put_u32(header + 24 + DRWAV_DS64_DATA_SIZE, fmtSize);
+        headerSize = 28 + DRWAV_DS64_DATA_SIZE;
+    }
+
+    size_t fmtPos = headerSize;
+    drwav__put_u16(header + headerSize +  0, formatTag);
+    drwav__put_u16(header + headerSize +  2, pFormat->channels);
+    drwav__put_u32(header + headerSize +  4, pFormat->sampleRate);
+    drwav__put_u32(header + headerSize +  8, pFormat->sampleRate * blockAlign);
+    drwav__put_u16(header + headerSize + 12, blockAlign);
+    drwav__put_u16(header + headerSize + 14, pFormat->bitsPerSample);
+    if (fmtSize >= 18) {
+        drwav__put_u16(header + headerSize + 16, fmtSize - 18);
+    }
+    if (isExtensible) {
+        // The sub-format is the format tag followed by the rest of the KSDATAFORMAT_SUBTYPE_PCM GUID.
+        static const unsigned char subFormat[14] = {0x00,0x00, 0x00,0x00, 0x10,0x00, 0x80,0x00, 0x00,0xAA,0x00,0x38,0x9B,0x71};
+        drwav__put_u16(header + headerSize + 18, pFormat->bitsPerSample);
+        drwav__put_u32(header + headerSize + 20, channelMask);
+        drwav__put_u16(header + headerSize + 24, pFormat->format);
+        memcpy(header + headerSize + 26, subFormat, sizeof(subFormat));
+    }
+    headerSize += fmtSize;
+
+    // The frame count in the "fact" chunk is set when the file is closed.
+    uint64_t factFrameCountPos = 0;
+    if (pFormat->format != DR_WAVE_FORMAT_PCM) {
+        if (pFormat->container == drwav_container_w64) {
+            while (headerSize % 8 != 0) {
+                header[headerSize++] = 0;
+            }
+
+            memcpy(header + headerSize, drwavGUID_W64_FACT, 16);
+            drwav__put_u64(header + headerSize + 16, 24 + 8);
+            drwav__put_u64(header + headerSize + 24, 0xFFFFFFFFFFFFFFFFULL);
+            factFrameCountPos = headerSize + 24;
+            headerSize += 32;
+        } else {
+            memcpy(header + headerSize, "fact", 4);
+            drwav__put_u32(header + headerSize + 4, 4);
+            drwav__put_u32(header + headerSize + 8, 0xFFFFFFFF);
+            factFrameCountPos = headerSize + 8;
+            headerSize += 12;
+        }
+    }
+
+    if (pFormat->container == drwav_container_w64) {
+        // Wave64 chunks are aligned to 8 bytes.
+        while (headerSize % 8 != 0) {
+            header[headerSize++] = 0;
+        }
+
+        memcpy(header + headerSize, drwavGUID_W64_DATA, 16);
+        drwav__put_u64(header + headerSize + 16, 0xFFFFFFFFFFFFFFFFULL);
+        headerSize += 24;
+    } else {
+        memcpy(header + headerSize, "data", 4);
+        drwav__put_u32(header + headerSize + 4, 0xFFFFFFFF);
+        headerSize += 8;
+    }
+
+    if (onWrite(pUserData, header, headerSize) != headerSize) {
+        return 0;
+    }
+
+
+    memset(pWav, 0, sizeof(*pWav));
+    pWav->onWrite                 = onWrite;
+    pWav->onSeek                  = onSeek;
+    pWav->pUserData               = pUserData;
+    pWav->container               = pFormat->container;
+    pWav->fmt.formatTag           = (unsigned short)formatTag;
+    pWav->fmt.channels            = (unsigned short)pFormat->channels;
+    pWav->fmt.sampleRate          = pFormat->sampleRate;
+    pWav->fmt.avgBytesPerSec      = pFormat->sampleRate * blockAlign;
+    pWav->fmt.blockAlign          = (unsigned short)blockAlign;
+    pWav->fmt.bitsPerSample       = (unsigned short)pFormat->bitsPerSample;
+    pWav->fmt.extendedSize        = (unsigned short)((fmtSize > 16) ? fmtSize - 18 : 0);
+    pWav->fmt.validBitsPerSample  = (unsigned short)(isExtensible ? pFormat->bitsPerSample : 0);
+    pWav->fmt.channelMask         = channelMask;
+    if (isExtensible) {
+        memcpy(pWav->fmt.subFormat, header + fmtPos + 24, 16);
+    }
+    pWav->sampleRate              = pFormat->sampleRate;
+    pWav->channels                = (unsigned short)pFormat->channels;
+    pWav->bitsPerSample           = (unsigned short)pFormat->bitsPerSample;
+    pWav->bytesPerSample          = (unsigned short)(pFormat->bitsPerSample / 8);
+    pWav->translatedFormatTag     = (unsigned short)pFormat->format;
+    pWav->dataChunkDataPos        = headerSize;
+    pWav->factFrameCountPos       = factFrameCountPos;
+    pWav->isChunkIndexComplete    = 1;
+
+    return 1;
+}
+
+drwav* drwav_open_write(const drwav_data_format* pFormat, drwav_write_proc onWrite, drwav_seek_proc onSeek, void* pUserData)
+{
+    // The write buffer is allocated with the drwav object.
+    drwav* pWav = malloc(sizeof(*pWav) + DR_WAV_WRITE_BUFFER_SIZE);
+    if (pWav == NULL) {
+        return NULL;
+    }
+
+    if (!drwav_init_write(pWav, pFormat, onWrite, onSeek, pUserData)) {
+        free(pWav);
+        return NULL;
+    }
+
+    pWav->pWriteBuffer        = (unsigned char*)(pWav + 1);
+    pWav->writeBufferCapacity = DR_WAV_WRITE_BUFFER_SIZE;
+
+    return pWav;
+}
+
+static int drwav__flush_write_buffer(drwav* pWav)
+{
+    if (pWav->writeBufferSize > 0) {
+        size_t bytesWritten = pWav->onWrite(pWav->pUserData, pWav->pWriteBuffer, pWav->writeBufferSize);
+        if (bytesWritten != pWav->writeBufferSize) {
+            pWav->writeFailed = 1;
+        }
+
+        pWav->writeBufferSize = 0;
+    }
+
+    return !pWav->writeFailed;
+}
+
+// Writes through the write buffer without counting anything towards the sample data.
+static size_t drwav__write_buffered(drwav* pWav, const void* pData, size_t bytesToWrite)
+{
+    const unsigned char* pRunningData = pData;
+    size_t bytesWritten = 0;
+    while (bytesWritten < bytesToWrite)
+    {
+        // Large writes go straight to the client when there's nothing buffered.
+        size_t bytesRemaining = bytesToWrite - bytesWritten;
+        if (pWav->writeBufferSize == 0 && bytesRemaining >= pWav->writeBufferCapacity) {
+            size_t bytesWrittenThisIteration = pWav->onWrite(pWav->pUserData, pRunningData, bytesRemaining);
+            bytesWritten += bytesWrittenThisIteration;
+            if (bytesWrittenThisIteration != bytesRemaining) {
+                pWav->writeFailed = 1;
+            }
+            break;
+        }
+
+        size_t bytesToCopy = pWav->writeBufferCapacity - pWav->writeBufferSize;
+        if (bytesToCopy > bytesRemaining) {
+            bytesToCopy = bytesRemaining;
+        }
+
+        memcpy(pWav->pWriteBuffer + pWav->writeBufferSize, pRunningData, bytesToCopy);
+        pWav->writeBufferSize += bytesToCopy;
+        pRunningData += bytesToCopy;
+        bytesWritten += bytesToCopy;
+
+        if (pWav->writeBufferSize == pWav->writeBufferCapacity) {
+            if (!drwav__flush_write_buffer(pWav)) {
+                break;
+            }
+        }
+    }
+
+    return bytesWritten;
+}
+
+size_t drwav_write_raw(drwav* pWav, const void* pData, size_t bytesToWrite)
+{
+    if (pWav == NULL || pWav->onWrite == NULL || pData == NULL || pWav->writeFailed) {
+        return 0;
+    }
+
+    size_t bytesWritten = drwav__write_buffered(pWav, pData, bytesToWrite);
+
+    // The sample count is derived from the size of the data so that it stays right when the data is written in pieces that
+    // don't line up with samples.
+    pWav->dataChunkDataSize += bytesWritten;
+    pWav->totalSampleCount   = pWav->dataChunkDataSize / pWav->bytesPerSample;
+    return bytesWritten;
+}
+
+size_t drwav_write(drwav* pWav, size_t samplesToWrite, const void* pData)
+{
+    if (pWav == NULL || pWav->bytesPerSample == 0) {
+        return 0;
+    }
+
+    size_t bytesWritten = drwav_write_raw(pWav, pData, samplesToWrite * pWav->bytesPerSample);
+    return bytesWritten / pWav->bytesPerSample;
+}
+
+static void drwav__finish_write(drwav* pWav)
+{
+    assert(pWav->onWrite != NULL);
+
+    // Chunks need to be padded. This is done through the buffer, but it's not part of the sample data.
+    unsigned char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    unsigned int paddingSize;
+    if (pWav->container == drwav_container_w64) {
+        paddingSize = (unsigned int)((8 - (pWav->dataChunkDataSize % 8)) % 8);
+    } else {
+        paddingSize = (unsigned int)(pWav->dataChunkDataSize % 2);
+    }
+
+    if (!pWav->writeFailed) {
+        drwav__write_buffered(pWav, padding, paddingSize);
+    }
+
+    if (!drwav__flush_write_buffer(pWav) || pWav->onSeek == NULL) {
+        return;
+    }
+
+    uint64_t dataChunkDataSize = pWav->dataChunkDataSize;
+    uint64_t fileSize = pWav->dataChunkDataPos + dataChunkDataSize + paddingSize;
+
+    // Only whole frames count, even if drwav_write_raw() was used to write a partial one at the end.
+    uint64_t frameCount = dataChunkDataSize / pWav->fmt.blockAlign;
+
+    unsigned char sizes[8];
+    if (pWav->container == drwav_container_w64) {
+        drwav__put_u64(sizes, fileSize);
+        if (pWav->onSeek(pWav->pUserData, 16, drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, sizes, 8);
+        }
+
+        drwav__put_u64(sizes, dataChunkDataSize + 24);
+        if (pWav->onSeek(pWav->pUserData, (int64_t)(pWav->dataChunkDataPos - 8), drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, sizes, 8);
+        }
+
+        drwav__put_u64(sizes, frameCount);
+        if (pWav->factFrameCountPos != 0 && pWav->onSeek(pWav->pUserData, (int64_t)pWav->factFrameCountPos, drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, sizes, 8);
+        }
+
+        return;
+    }
+
+    // The "fact" chunk of RIFF and RF64 files only has room for 32 bits. RF64 files have the full frame count in the "ds64"
+    // chunk, and readers look there when the "fact" chunk says 0xFFFFFFFF.
+    drwav__put_u32(sizes, (frameCount > 0xFFFFFFFF) ? 0xFFFFFFFF : (unsigned int)frameCount);
+    if (pWav->factFrameCountPos != 0 && pWav->onSeek(pWav->pUserData, (int64_t)pWav->factFrameCountPos, drwav_seek_origin_start)) {
+        pWav->onWrite(pWav->pUserData, sizes, 4);
+    }
+
+    if (pWav->container == drwav_container_rf64 || fileSize - 8 > 0xFFFFFFFF) {
+        // Promote to RF64 by replacing the placeholder chunk with a "ds64" chunk. The RIFF and data chunk sizes are left at
+        // 0xFFFFFFFF which tells readers to use the values in the "ds64" chunk.
+        unsigned char ds64[20 + DRWAV_DS64_DATA_SIZE];
+        memcpy(ds64 + 0, "RF64", 4);
+        drwav__put_u32(ds64 + 4, 0xFFFFFFFF);
+        memcpy(ds64 + 8, "WAVE", 4);
+        memcpy(ds64 + 12, "ds64", 4);
+        drwav__put_u32(ds64 + 16, DRWAV_DS64_DATA_SIZE);
+        drwav__put_u64(ds64 + 20, fileSize - 8);
+        drwav__put_u64(ds64 + 28, dataChunkDataSize);
+        drwav__put_u64(ds64 + 36, frameCount);
+        drwav__put_u32(ds64 + 44, 0);
+        if (pWav->onSeek(pWav->pUserData, 0, drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, ds64, sizeof(ds64));
+        }
+
+        pWav->container = drwav_container_rf64;
+    } else {
+        drwav__put_u32(sizes, (unsigned int)(fileSize - 8));
+        if (pWav->onSeek(pWav->pUserData, 4, drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, sizes, 4);
+        }
+
+        drwav__put_u32(sizes, (unsigned int)dataChunkDataSize);
+        if (pWav->onSeek(pWav->pUserData, (int64_t)(pWav->dataChunkDataPos - 4), drwav_seek_origin_start)) {
+            pWav->onWrite(pWav->pUserData, sizes, 4);
+        }
+    }
+}
+
+
+#ifndef DR_WAV_NO_CONVERSION_API
+static short drwav__clamp_and_round_s16(float x)
+{
+    x = x * 32768.0f;
+    if (x < -32768.0f) {
+        return -32768;
+    }
+    if (x > 32767.0f) {
+        return 32767;
+    }
+
+    return (short)((x >= 0) ? (x + 0.5f) : (x - 0.5f));
+}
+
+static int drwav__clamp_and_round_s32(double x)
+{
+    x = x * 2147483648.0;
+    if (x < -2147483648.0) {
+        return INT_MIN;
+    }
+    if (x > 2147483647.0) {
+        return INT_MAX;
+    }
+
+    return (int)((x >= 0) ? (x + 0.5) : (x - 0.5));
+}
+
+static int drwav__clamp_and_round_s24(double x)
+{
+    x = x * 8388608.0;
+    if (x < -8388608.0) {
+        return -8388608;
+    }
+    if (x > 8388607.0) {
+        return 8388607;
+    }
+
+    return (int)((x >= 0) ? (x + 0.5) : (x - 0.5));
+}
+
+// The noise generator for dithering. Each lane of drwav_dither is an xorshift32 generator. Sample i of a conversion uses
+// lane i % 4, so the SIMD and scalar paths produce exactly the same noise.
+static DRWAV_INLINE uint32_t drwav__xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Rotates the lanes after a conversion that didn't end on a multiple of 4 so that the next conversion picks up with the lane
+// that comes next. This makes the noise independent of how the samples are split between calls.
+static void drwav__dither_rotate(drwav_dither* pDither, size_t samplesConverted)
+{
+    uint32_t state[4];
+    for (size_t i = 0; i < 4; ++i) {
+        state[i] = pDither->state[(i + samplesConverted) & 3];
+    }
+
+    memcpy(pDither->state, state, sizeof(state));
+}
+
+// Converts a random number to triangular noise in the range (-1, 1) by taking the difference of its two 16-bit halves.
+static DRWAV_INLINE float drwav__dither_noise(uint32_t r)
+{
+    return (float)((int)(r >> 16) - (int)(r & 0xFFFF)) * (1.0f / 65536.0f);
+}
+
+#ifdef DRWAV_SUPPORTS_SSE2
+static DRWAV_INLINE __m128i drwav__xorshift32_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    return x;
+}
+
+static DRWAV_INLINE __m128 drwav__dither_noise_sse2(__m128i r)
+{
+    __m128i d = _mm_sub_epi32(_mm_srli_epi32(r, 16), _mm_and_si128(r, _mm_set1_epi32(0xFFFF)));
+    return _mm_mul_ps(_mm_cvtepi32_ps(d), _mm_set1_ps(1.0f / 65536.0f));
+}
+
+// Rounds halves away from zero using single precision, the same as drwav__clamp_and_round_s16(). <x> must already be clamped.
+static DRWAV_INLINE __m128i drwav__round_ps_sse2(__m128 x)
+{
+    __m128 half = _mm_or_ps(_mm_and_ps(x, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(x, half));
+}
+
+// Rounds halves away from zero without the error of adding 0.5 at single precision. This matches the double precision
+// rounding of drwav__clamp_and_round_s24() and drwav__clamp_and_round_s32() exactly. <x> must already be clamped.
+static DRWAV_INLINE __m128i drwav__round_exact_ps_sse2(__m128 x)
+{
+    __m128i r = _mm_cvttps_epi32(x);
+    __m128 frac = _mm_sub_ps(x, _mm_cvtepi32_ps(r));
+    r = _mm_sub_epi32(r, _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps( 0.5f))));
+    r = _mm_add_epi32(r, _mm_castps_si128(_mm_cmple_ps(frac, _mm_set1_ps(-0.5f))));
+    return r;
+}
+
+// The SSE2 conversion paths below return the number of samples they converted, which is always a multiple of 4. The caller
+// converts the rest. <pDither> can be NULL, in which case no dither is applied. Everything is loaded before it's stored so
+// conversions can be done in place. The s16 and s32 paths take their input as bytes because they're also used for raw sample
+// data, which can be at any alignment. _mm_loadu_ps() doesn't care about either alignment or the type of the buffer.
+static size_t drwav__f32_to_s16_sse2(size_t totalSampleCount, const unsigned char* f32In, short* s16Out, drwav_dither* pDither)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lo    = _mm_set1_ps(-32768.0f);
+    const __m128 hi    = _mm_set1_ps( 32767.0f);
+    const __m128 noiseScale = _mm_set1_ps(1.0f / 32768.0f);
+    __m128i state = (pDither != NULL) ? _mm_loadu_si128((const __m128i*)pDither->state) : _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= totalSampleCount; i += 8) {
+        __m128 x0 = _mm_loadu_ps((const float*)(f32In + (i + 0)*4));
+        __m128 x1 = _mm_loadu_ps((const float*)(f32In + (i + 4)*4));
+        if (pDither != NULL) {
+            state = drwav__xorshift32_sse2(state);
+            x0 = _mm_add_ps(x0, _mm_mul_ps(drwav__dither_noise_sse2(state), noiseScale));
+            state = drwav__xorshift32_sse2(state);
+            x1 = _mm_add_ps(x1, _mm_mul_ps(drwav__dither_noise_sse2(state), noiseScale));
+        }
+
+        // _mm_max_ps() returns the second operand for NaN, so NaN becomes -32768 rather than anything undefined.
+        x0 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(x0, scale), lo), hi);
+        x1 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(x1, scale), lo), hi);
+        _mm_storeu_si128((__m128i*)(s16Out + i), _mm_packs_epi32(drwav__round_ps_sse2(x0), drwav__round_ps_sse2(x1)));
+    }
+
+    if (pDither != NULL) {
+        _mm_storeu_si128((__m128i*)pDither->state, state);
+    }
+
+    return i;
+}
+
+static size_t drwav__f32_to_s32_sse2(size_t totalSampleCount, const unsigned char* f32In, int* s32Out)
+{
+    // 2147483647 can't be represented as a float, so anything that reaches 2^31 is clamped separately.
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    const __m128 lo    = _mm_set1_ps(-2147483648.0f);
+    const __m128i maxInt = _mm_set1_epi32(INT_MAX);
+
+    size_t i = 0;
+    for (; i + 4 <= totalSampleCount; i += 4) {
+        __m128 x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps((const float*)(f32In + i*4)), scale), lo);
+        __m128i over = _mm_castps_si128(_mm_cmpge_ps(x, scale));
+        __m128i r = drwav__round_exact_ps_sse2(x);
+        r = _mm_or_si128(_mm_andnot_si128(over, r), _mm_and_si128(over, maxInt));
+        _mm_storeu_si128((__m128i*)(s32Out + i), r);
+    }
+
+    return i;
+}
+
+static size_t drwav__f32_to_s24_sse2(size_t totalSampleCount, const float* f32In, unsigned char* s24Out, drwav_dither* pDither)
+{
+    const __m128 scale = _mm_set1_ps(8388608.0f);
+    const __m128 lo    = _mm_set1_ps(-8388608.0f);
+    const __m128 hi    = _mm_set1_ps( 8388607.0f);
+    const __m128 noiseScale = _mm_set1_ps(1.0f / 8388608.0f);
+    const __m128i mask24 = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+    const __m128i maskHi = _mm_set_epi32(0x00FFFFFF, 0, 0x00FFFFFF, 0);
+    const __m128i maskLo64 = _mm_set_epi32(0, 0, -1, -1);
+    __m128i state = (pDither != NULL) ? _mm_loadu_si128((const __m128i*)pDither->state) : _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= totalSampleCount; i += 4) {
+        __m128 x = _mm_loadu_ps(f32In + i);
+        if (pDither != NULL) {
+            state = drwav__xorshift32_sse2(state);
+            x = _mm_add_ps(x, _mm_mul_ps(drwav__dither_noise_sse2(state), noiseScale));
+        }
+
+        x = _mm_min_ps(_mm_max_ps(_mm_mul_ps(x, scale), lo), hi);
+        __m128i r = drwav__round_exact_ps_sse2(x);
+
+        // Pack the low 3 bytes of each lane together. The samples are joined in pairs within each 64-bit half first, and then
+        // the upper pair is shifted down against the lower one, giving 12 contiguous bytes.
+        __m128i pairs  = _mm_or_si128(_mm_and_si128(r, mask24), _mm_srli_epi64(_mm_and_si128(r, maskHi), 8));
+        __m128i packed = _mm_or_si128(_mm_and_si128(pairs, maskLo64), _mm_srli_si128(_mm_andnot_si128(maskLo64, pairs), 2));
+        _mm_storel_epi64((__m128i*)(s24Out + i*3), packed);
+
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+        memcpy(s24Out + i*3 + 8, &last, 4);
+    }
+
+    if (pDither != NULL) {
+        _mm_storeu_si128((__m128i*)pDither->state, state);
+    }
+
+    return i;
+}
+#endif
+
+// A-law and u-law lookup tables, generated with the G.711 reference expansion. The s16 tables have an extra entry so that the
+// AVX2 path can gather 32 bits at a time without reading past the end.
+static const short drwav__alaw_table_s16[256 + 1] = {
+     -5504,  -5248,  -6016,  -5760,  -4480,  -4224,  -4992,  -4736,  -7552,  -7296,  -8064,  -7808,  -6528,  -6272,  -7040,  -6784,
+     -2752,  -2624,  -3008,  -2880,  -2240,  -2112,  -2496,  -2368,  -3776,  -3648,  -4032,  -3904,  -3264,  -3136,  -3520,  -3392,
+    -22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944, -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+    -11008, -10496, -12032, -11520,  -8960,  -8448,  -9984,  -9472, -15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+      -344,   -328,   -376,   -360,   -280,   -264,   -312,   -296,   -472,   -456,   -504,   -488,   -408,   -392,   -440,   -424,
+       -88,    -72,   -120,   -104,    -24,     -8,    -56,    -40,   -216,   -200,   -248,   -232,   -152,   -136,   -184,   -168,
+     -1376,  -1312,  -1504,  -1440,  -1120,  -1056,  -1248,  -1184,  -1888,  -1824,  -2016,  -1952,  -1632,  -1568,  -1760,  -1696,
+      -688,   -656,   -752,   -720,   -560,   -528,   -624,   -592,   -944,   -912,  -1008,   -976,   -816,   -784,   -880,   -848,
+      5504,   5248,   6016,   5760,   4480,   4224,   4992,   4736,   7552,   7296,   8064,   7808,   6528,   6272,   7040,   6784,
+      2752,   2624,   3008,   2880,   2240,   2112,   2496,   2368,   3776,   3648,   4032,   3904,   3264,   3136,   3520,   3392,
+     22016,  20992,  24064,  23040,  17920,  16896,  19968,  18944,  30208,  29184,  32256,  31232,  26112,  25088,  28160,  27136,
+     11008,  10496,  12032,  11520,   8960,   8448,   9984,   9472,  15104,  14592,  16128,  15616,  13056,  12544,  14080,  13568,
+       344,    328,    376,    360,    280,    264,    312,    296,    472,    456,    504,    488,    408,    392,    440,    424,
+        88,     72,    120,    104,     24,      8,     56,     40,    216,    200,    248,    232,    152,    136,    184,    168,
+      1376,   1312,   1504,   1440,   1120,   1056,   1248,   1184,   1888,   1824,   2016,   1952,   1632,   1568,   1760,   1696,
+       688,    656,    752,    720,    560,    528,    624,    592,    944,    912,   1008,    976,    816,    784,    880,    848,
+};
+
+static const short drwav__ulaw_table_s16[256 + 1] = {
+    -32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956, -23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+    -15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412, -11900, -11388, -10876, -10364,  -9852,  -9340,  -8828,  -8316,
+     -7932,  -7676,  -7420,  -7164,  -6908,  -6652,  -6396,  -6140,  -5884,  -5628,  -5372,  -5116,  -4860,  -4604,  -4348,  -4092,
+     -3900,  -3772,  -3644,  -3516,  -3388,  -3260,  -3132,  -3004,  -2876,  -2748,  -2620,  -2492,  -2364,  -2236,  -2108,  -1980,
+     -1884,  -1820,  -1756,  -1692,  -1628,  -1564,  -1500,  -1436,  -1372,  -1308,  -1244,  -1180,  -1116,  -1052,   -988,   -924,
+      -876,   -844,   -812,   -780,   -748,   -716,   -684,   -652,   -620,   -588,   -556,   -524,   -492,   -460,   -428,   -396,
+      -372,   -356,   -340,   -324,   -308,   -292,   -276,   -260,   -244,   -228,   -212,   -196,   -180,   -164,   -148,   -132,
+      -120,   -112,   -104,    -96,    -88,    -80,    -72,    -64,    -56,    -48,    -40,    -32,    -24,    -16,     -8,      0,
+     32124,  31100,  30076,  29052,  28028,  27004,  25980,  24956,  23932,  22908,  21884,  20860,  19836,  18812,  17788,  16764,
+     15996,  15484,  14972,  14460,  13948,  13436,  12924,  12412,  11900,  11388,  10876,  10364,   9852,   9340,   8828,   8316,
+      7932,   7676,   7420,   7164,   6908,   6652,   6396,   6140,   5884,   5628,   5372,   5116,   4860,   4604,   4348,   4092,
+      3900,   3772,   3644,   3516,   3388,   3260,   3132,   3004,   2876,   2748,   2620,   2492,   2364,   2236,   2108,   1980,
+      1884,   1820,   1756,   1692,   1628,   1564,   1500,   1436,   1372,   1308,   1244,   1180,   1116,   1052,    988,    924,
+       876,    844,    812,    780,    748,    716,    684,    652,    620,    588,    556,    524,    492,    460,    428,    396,
+       372,    356,    340,    324,    308,    292,    276,    260,    244,    228,    212,    196,    180,    164,    148,    132,
+       120,    112,    104,     96,     88,     80,     72,     64,     56,     48,     40,     32,     24,     16,      8,      0,
+};
+
+static const float drwav__alaw_table_f32[256] = {
+    -0.16796875f, -0.16015625f, -0.18359375f, -0.17578125f, -0.13671875f, -0.12890625f, -0.15234375f, -0.14453125f,
+    -0.23046875f, -0.22265625f, -0.24609375f, -0.23828125f, -0.19921875f, -0.19140625f, -0.21484375f, -0.20703125f,
+    -0.083984375f, -0.080078125f, -0.091796875f, -0.087890625f, -0.068359375f, -0.064453125f, -0.076171875f, -0.072265625f,
+    -0.115234375f, -0.111328125f, -0.123046875f, -0.119140625f, -0.099609375f, -0.095703125f, -0.107421875f, -0.103515625f,
+    -0.671875f, -0.640625f, -0.734375f, -0.703125f, -0.546875f, -0.515625f, -0.609375f, -0.578125f,
+    -0.921875f, -0.890625f, -0.984375f, -0.953125f, -0.796875f, -0.765625f, -0.859375f, -0.828125f,
+    -0.3359375f, -0.3203125f, -0.3671875f, -0.3515625f, -0.2734375f, -0.2578125f, -0.3046875f, -0.2890625f,
+    -0.4609375f, -0.4453125f, -0.4921875f, -0.4765625f, -0.3984375f, -0.3828125f, -0.4296875f, -0.4140625f,
+    -0.010498046875f, -0.010009765625f, -0.011474609375f, -0.010986328125f, -0.008544921875f, -0.008056640625f, -0.009521484375f, -0.009033203125f,
+    -0.014404296875f, -0.013916015625f, -0.015380859375f, -0.014892578125f, -0.012451171875f, -0.011962890625f, -0.013427734375f, -0.012939453125f,
+    -0.002685546875f, -0.002197265625f, -0.003662109375f, -0.003173828125f, -0.000732421875f, -0.000244140625f, -0.001708984375f, -0.001220703125f,
+    -0.006591796875f, -0.006103515625f, -0.007568359375f, -0.007080078125f, -0.004638671875f, -0.004150390625f, -0.005615234375f, -0.005126953125f,
+    -0.0419921875f, -0.0400390625f, -0.0458984375f, -0.0439453125f, -0.0341796875f, -0.0322265625f, -0.0380859375f, -0.0361328125f,
+    -0.0576171875f, -0.0556640625f, -0.0615234375f, -0.0595703125f, -0.0498046875f, -0.0478515625f, -0.0537109375f, -0.0517578125f,
+    -0.02099609375f, -0.02001953125f, -0.02294921875f, -0.02197265625f, -0.01708984375f, -0.01611328125f, -0.01904296875f, -0.01806640625f,
+    -0.02880859375f, -0.02783203125f, -0.03076171875f, -0.02978515625f, -0.02490234375f, -0.02392578125f, -0.02685546875f, -0.02587890625f,
+    0.16796875f, 0.16015625f, 0.18359375f, 0.17578125f, 0.13671875f, 0.12890625f, 0.15234375f, 0.14453125f,
+    0.23046875f, 0.22265625f, 0.24609375f, 0.23828125f, 0.19921875f, 0.19140625f, 0.21484375f, 0.20703125f,
+    0.083984375f, 0.080078125f, 0.091796875f, 0.087890625f, 0.068359375f, 0.064453125f, 0.076171875f, 0.072265625f,
+    0.115234375f, 0.111328125f, 0.123046875f, 0.119140625f, 0.099609375f, 0.095703125f, 0.107421875f, 0.103515625f,
+    0.671875f, 0.640625f, 0.734375f, 0.703125f, 0.546875f, 0.515625f, 0.609375f, 0.578125f,
+    0.921875f, 0.890625f, 0.984375f, 0.953125f, 0.796875f, 0.765625f, 0.859375f, 0.828125f,
+    0.3359375f, 0.3203125f, 0.3671875f, 0.3515625f, 0.2734375f, 0.2578125f, 0.3046875f, 0.2890625f,
+    0.4609375f, 0.4453125f, 0.4921875f, 0.4765625f, 0.3984375f, 0.3828125f, 0.4296875f, 0.4140625f,
+    0.010498046875f, 0.010009765625f, 0.011474609375f, 0.010986328125f, 0.008544921875f, 0.008056640625f, 0.009521484375f, 0.009033203125f,
+    0.014404296875f, 0.013916015625f, 0.015380859375f, 0.014892578125f, 0.012451171875f, 0.011962890625f, 0.013427734375f, 0.012939453125f,
+    0.002685546875f, 0.002197265625f, 0.003662109375f, 0.003173828125f, 0.000732421875f, 0.000244140625f, 0.001708984375f, 0.001220703125f,
+    0.006591796875f, 0.006103515625f, 0.007568359375f, 0.007080078125f, 0.004638671875f, 0.004150390625f, 0.005615234375f, 0.005126953125f,
+    0.0419921875f, 0.0400390625f, 0.0458984375f, 0.0439453125f, 0.0341796875f, 0.0322265625f, 0.0380859375f, 0.0361328125f,
+    0.0576171875f, 0.0556640625f, 0.0615234375f, 0.0595703125f, 0.0498046875f, 0.0478515625f, 0.0537109375f, 0.0517578125f,
+    0.02099609375f, 0.02001953125f, 0.02294921875f, 0.02197265625f, 0.01708984375f, 0.01611328125f, 0.01904296875f, 0.01806640625f,
+    0.02880859375f, 0.02783203125f, 0.03076171875f, 0.02978515625f, 0.02490234375f, 0.02392578125f, 0.02685546875f, 0.02587890625f,
+};
+
+static const float drwav__ulaw_table_f32[256] = {
+    -0.9803466796875f, -0.9490966796875f, -0.9178466796875f, -0.8865966796875f, -0.8553466796875f, -0.8240966796875f, -0.7928466796875f, -0.7615966796875f,
+    -0.7303466796875f, -0.6990966796875f, -0.6678466796875f, -0.6365966796875f, -0.6053466796875f, -0.5740966796875f, -0.5428466796875f, -0.5115966796875f,
+    -0.4881591796875f, -0.4725341796875f, -0.4569091796875f, -0.4412841796875f, -0.4256591796875f, -0.4100341796875f, -0.3944091796875f, -0.3787841796875f,
+    -0.3631591796875f, -0.3475341796875f, -0.3319091796875f, -0.3162841796875f, -0.3006591796875f, -0.2850341796875f, -0.2694091796875f, -0.2537841796875f,
+    -0.2420654296875f, -0.2342529296875f, -0.2264404296875f, -0.2186279296875f, -0.2108154296875f, -0.2030029296875f, -0.1951904296875f, -0.1873779296875f,
+    -0.1795654296875f, -0.1717529296875f, -0.1639404296875f, -0.1561279296875f, -0.1483154296875f, -0.1405029296875f, -0.1326904296875f, -0.1248779296875f,
+    -0.1190185546875f, -0.1151123046875f, -0.1112060546875f, -0.1072998046875f, -0.1033935546875f, -0.0994873046875f, -0.0955810546875f, -0.0916748046875f,
+    -0.0877685546875f, -0.0838623046875f, -0.0799560546875f, -0.0760498046875f, -0.0721435546875f, -0.0682373046875f, -0.0643310546875f, -0.0604248046875f,
+    -0.0574951171875f, -0.0555419921875f, -0.0535888671875f, -0.0516357421875f, -0.0496826171875f, -0.0477294921875f, -0.0457763671875f, -0.0438232421875f,
+    -0.0418701171875f, -0.0399169921875f, -0.0379638671875f, -0.0360107421875f, -0.0340576171875f, -0.0321044921875f, -0.0301513671875f, -0.0281982421875f,
+    -0.0267333984375f, -0.0257568359375f, -0.0247802734375f, -0.0238037109375f, -0.0228271484375f, -0.0218505859375f, -0.0208740234375f, -0.0198974609375f,
+    -0.0189208984375f, -0.0179443359375f, -0.0169677734375f, -0.0159912109375f, -0.0150146484375f, -0.0140380859375f, -0.0130615234375f, -0.0120849609375f,
+    -0.0113525390625f, -0.0108642578125f, -0.0103759765625f, -0.0098876953125f, -0.0093994140625f, -0.0089111328125f, -0.0084228515625f, -0.0079345703125f,
+    -0.0074462890625f, -0.0069580078125f, -0.0064697265625f, -0.0059814453125f, -0.0054931640625f, -0.0050048828125f, -0.0045166015625f, -0.0040283203125f,
+    -0.003662109375f, -0.00341796875f, -0.003173828125f, -0.0029296875f, -0.002685546875f, -0.00244140625f, -0.002197265625f, -0.001953125f,
+    -0.001708984375f, -0.00146484375f, -0.001220703125f, -0.0009765625f, -0.000732421875f, -0.00048828125f, -0.000244140625f, 0.0f,
+    0.9803466796875f, 0.9490966796875f, 0.9178466796875f, 0.8865966796875f, 0.8553466796875f, 0.8240966796875f, 0.7928466796875f, 0.7615966796875f,
+    0.7303466796875f, 0.6990966796875f, 0.6678466796875f, 0.6365966796875f, 0.6053466796875f, 0.5740966796875f, 0.5428466796875f, 0.5115966796875f,
+    0.4881591796875f, 0.4725341796875f, 0.4569091796875f, 0.4412841796875f, 0.4256591796875f, 0.4100341796875f, 0.3944091796875f, 0.3787841796875f,
+    0.3631591796875f, 0.3475341796875f, 0.3319091796875f, 0.3162841796875f, 0.3006591796875f, 0.2850341796875f, 0.2694091796875f, 0.2537841796875f,
+    0.2420654296875f, 0.2342529296875f, 0.2264404296875f, 0.2186279296875f, 0.2108154296875f, 0.2030029296875f, 0.1951904296875f, 0.1873779296875f,
+    0.1795654296875f, 0.1717529296875f, 0.1639404296875f, 0.1561279296875f, 0.1483154296875f, 0.1405029296875f, 0.1326904296875f, 0.1248779296875f,
+    0.1190185546875f, 0.1151123046875f, 0.1112060546875f, 0.1072998046875f, 0.1033935546875f, 0.0994873046875f, 0.0955810546875f, 0.0916748046875f,
+    0.0877685546875f, 0.0838623046875f, 0.0799560546875f, 0.0760498046875f, 0.0721435546875f, 0.0682373046875f, 0.0643310546875f, 0.0604248046875f,
+    0.0574951171875f, 0.0555419921875f, 0.0535888671875f, 0.0516357421875f, 0.0496826171875f, 0.0477294921875f, 0.0457763671875f, 0.0438232421875f,
+    0.0418701171875f, 0.0399169921875f, 0.0379638671875f, 0.0360107421875f, 0.0340576171875f, 0.0321044921875f, 0.0301513671875f, 0.0281982421875f,
+    0.0267333984375f, 0.0257568359375f, 0.0247802734375f, 0.0238037109375f, 0.0228271484375f, 0.0218505859375f, 0.0208740234375f, 0.0198974609375f,
+    0.0189208984375f, 0.0179443359375f, 0.0169677734375f, 0.0159912109375f, 0.0150146484375f, 0.0140380859375f, 0.0130615234375f, 0.0120849609375f,
+    0.0113525390625f, 0.0108642578125f, 0.0103759765625f, 0.0098876953125f, 0.0093994140625f, 0.0089111328125f, 0.0084228515625f, 0.0079345703125f,
+    0.0074462890625f, 0.0069580078125f, 0.0064697265625f, 0.0059814453125f, 0.0054931640625f, 0.0050048828125f, 0.0045166015625f, 0.0040283203125f,
+    0.003662109375f, 0.00341796875f, 0.003173828125f, 0.0029296875f, 0.002685546875f, 0.00244140625f, 0.002197265625f, 0.001953125f,
+    0.001708984375f, 0.00146484375f, 0.001220703125f, 0.0009765625f, 0.000732421875f, 0.00048828125f, 0.000244140625f, 0.0f,
+};
+
+#ifdef DRWAV_SUPPORTS_AVX2
+// These look up 8 or 16 samples at a time and return how many were done. All loads for a group happen before its stores, so
+// they're safe to use for in place conversions like the scalar loops.
+static size_t drwav__table_lookup_f32_avx2(size_t totalSampleCount, const unsigned char* pIn, const float* pTable, float* pOut)
+{
+    size_t i = 0;
+    for (; i + 8 <= totalSampleCount; i += 8)
+    {
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pIn + i)));
+        _mm256_storeu_ps(pOut + i, _mm256_i32gather_ps(pTable, indices, 4));
+    }
+
+    return i;
+}
+
+static size_t drwav__table_lookup_s16_avx2(size_t totalSampleCount, const unsigned char* pIn, const short* pTable, short* pOut)
+{
+    size_t i = 0;
+    for (; i + 16 <= totalSampleCount; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(pIn + i));
+
+        // Each gather reads 32 bits starting at the 16-bit entry, so the sample is in the low half.
+        __m256i lo = _mm256_i32gather_epi32((const int*)pTable, _mm256_cvtepu8_epi32(bytes), 2);
+        __m256i hi = _mm256_i32gather_epi32((const int*)pTable, _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), 2);
+        lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+        hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+
+        // Packing works within 128-bit lanes so the middle two quarters need to be swapped back.
+        _mm256_storeu_si256((__m256i*)(pOut + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8));
+    }
+
+    return i;
+}
+
+static size_t drwav__table_lookup_s32_avx2(size_t totalSampleCount, const unsigned char* pIn, const short* pTable, int* pOut)
+{
+    size_t i = 0;
+    for (; i + 8 <= totalSampleCount; i += 8)
+    {
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pIn + i)));
+        __m256i samples = _mm256_i32gather_epi32((const int*)pTable, indices, 2);
+        _mm256_storeu_si256((__m256i*)(pOut + i), _mm256_slli_epi32(samples, 16));
+    }
+
+    return i;
+}
+#endif
+
+// Raw sample data is read into whatever buffer is at hand, which is often an output buffer of a different type, and it can
+// be at any alignment when it comes from drwav_get_raw_data_pointer(). It's therefore only ever loaded with memcpy(), which
+// compilers turn into a plain load.
+static DRWAV_INLINE short drwav__load_s16(const unsigned char* p)
+{
+    short x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static DRWAV_INLINE int drwav__load_s32(const unsigned char* p)
+{
+    int x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static DRWAV_INLINE float drwav__load_f32(const unsigned char* p)
+{
+    float x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static DRWAV_INLINE double drwav__load_f64(const unsigned char* p)
+{
+    double x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static int drwav__pcm_to_s32_generic(size_t totalSampleCount, const unsigned char* pPCM, unsigned short bytesPerSample, int* s32Out)
+{
+    // Generic, slow converter for sample sizes that don't have a dedicated kernel. Only the most significant 32 bits are kept.
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        unsigned int sample = 0;
+        unsigned int shift  = 32;
+        for (unsigned short j = bytesPerSample; j > 0 && shift > 0; --j) {
+            shift  -= 8;
+            sample |= (unsigned int)(pPCM[j-1]) << shift;
+        }
+
+        pPCM += bytesPerSample;
+        *s32Out++ = (int)sample;
+    }
+
+    return 1;
+}
+
+static int drwav__pcm_to_f32(size_t totalSampleCount, const unsigned char* pPCM, unsigned short bytesPerSample, float* f32Out)
+{
+    if (pPCM == NULL || f32Out == NULL) {
+        return 0;
+    }
+
+    // Special case for 8-bit sample data because it's treated as unsigned.
+    if (bytesPerSample == 1) {
+        drwav_u8PCM_to_f32(totalSampleCount, pPCM, f32Out);
+        return 1;
+    }
+
+
+    // Slightly more optimal implementation for common formats.
+    if (bytesPerSample == 2) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            f32Out[i] = drwav__load_s16(pPCM + i*2) / 32768.0f;
+        }
+        return 1;
+    }
+    if (bytesPerSample == 3) {
+        drwav_s24PCM_to_f32(totalSampleCount, pPCM, f32Out);
+        return 1;
+    }
+    if (bytesPerSample == 4) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            f32Out[i] = (float)(drwav__load_s32(pPCM + i*4) / 2147483648.0);
+        }
+        return 1;
+    }
+
+
+    // Generic, slow converter. This is only ever hit for sample sizes larger than 4 bytes so the output is never larger than
+    // the input, which means converting through an int is safe to do in place.
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        int sample;
+        drwav__pcm_to_s32_generic(1, pPCM, bytesPerSample, &sample);
+
+        pPCM += bytesPerSample;
+        *f32Out++ = (float)(sample / 2147483648.0);
+    }
+
+    return 1;
+}
+
+static int drwav__pcm_to_s16(size_t totalSampleCount, const unsigned char* pPCM, unsigned short bytesPerSample, short* s16Out)
+{
+    if (pPCM == NULL || s16Out == NULL) {
+        return 0;
+    }
+
+    if (bytesPerSample == 1) {
+        drwav_u8PCM_to_s16(totalSampleCount, pPCM, s16Out);
+        return 1;
+    }
+    if (bytesPerSample == 2) {
+        if ((const void*)pPCM != (const void*)s16Out) {
+            memmove(s16Out, pPCM, totalSampleCount * sizeof(short));
+        }
+        return 1;
+    }
+    if (bytesPerSample == 3) {
+        drwav_s24PCM_to_s16(totalSampleCount, pPCM, s16Out);
+        return 1;
+    }
+    if (bytesPerSample == 4) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            s16Out[i] = (short)(drwav__load_s32(pPCM + i*4) >> 16);
+        }
+        return 1;
+    }
+
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        int sample;
+        drwav__pcm_to_s32_generic(1, pPCM, bytesPerSample, &sample);
+
+        pPCM += bytesPerSample;
+        *s16Out++ = (short)(sample >> 16);
+    }
+
+    return 1;
+}
+
+static int drwav__pcm_to_s32(size_t totalSampleCount, const unsigned char* pPCM, unsigned short bytesPerSample, int* s32Out)
+{
+    if (pPCM == NULL || s32Out == NULL) {
+        return 0;
+    }
+
+    if (bytesPerSample == 1) {
+        drwav_u8PCM_to_s32(totalSampleCount, pPCM, s32Out);
+        return 1;
+    }
+    if (bytesPerSample == 2) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            s32Out[i] = (int)((unsigned int)drwav__load_s16(pPCM + i*2) << 16);
+        }
+        return 1;
+    }
+    if (bytesPerSample == 3) {
+        drwav_s24PCM_to_s32(totalSampleCount, pPCM, s32Out);
+        return 1;
+    }
+    if (bytesPerSample == 4) {
+        if ((const void*)pPCM != (const void*)s32Out) {
+            memmove(s32Out, pPCM, totalSampleCount * sizeof(int));
+        }
+        return 1;
+    }
+
+    return drwav__pcm_to_s32_generic(totalSampleCount, pPCM, bytesPerSample, s32Out);
+}
+
+static int drwav__ieee_to_f32(size_t totalSampleCount, const unsigned char* pDataIn, unsigned short bytesPerSample, float* f32Out)
+{
+    if (pDataIn == NULL || f32Out == NULL) {
+        return 0;
+    }
+
+    if (bytesPerSample == 4) {
+        if ((const void*)pDataIn != (const void*)f32Out) {
+            memmove(f32Out, pDataIn, totalSampleCount * sizeof(float));
+        }
+        return 1;
+    }
+    if (bytesPerSample == 8) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            f32Out[i] = (float)drwav__load_f64(pDataIn + i*8);
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+static int drwav__ieee_to_s16(size_t totalSampleCount, const unsigned char* pDataIn, unsigned short bytesPerSample, short* s16Out)
+{
+    if (pDataIn == NULL || s16Out == NULL) {
+        return 0;
+    }
+
+    if (bytesPerSample == 4) {
+        size_t i = 0;
+#ifdef DRWAV_SUPPORTS_SSE2
+        i = drwav__f32_to_s16_sse2(totalSampleCount, pDataIn, s16Out, NULL);
+#endif
+        for (; i < totalSampleCount; ++i) {
+            s16Out[i] = drwav__clamp_and_round_s16(drwav__load_f32(pDataIn + i*4));
+        }
+        return 1;
+    }
+    if (bytesPerSample == 8) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            s16Out[i] = drwav__clamp_and_round_s16((float)drwav__load_f64(pDataIn + i*8));
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+static int drwav__ieee_to_s32(size_t totalSampleCount, const unsigned char* pDataIn, unsigned short bytesPerSample, int* s32Out)
+{
+    if (pDataIn == NULL || s32Out == NULL) {
+        return 0;
+    }
+
+    if (bytesPerSample == 4) {
+        size_t i = 0;
+#ifdef DRWAV_SUPPORTS_SSE2
+        i = drwav__f32_to_s32_sse2(totalSampleCount, pDataIn, s32Out);
+#endif
+        for (; i < totalSampleCount; ++i) {
+            s32Out[i] = drwav__clamp_and_round_s32(drwav__load_f32(pDataIn + i*4));
+        }
+        return 1;
+    }
+    if (bytesPerSample == 8) {
+        for (size_t i = 0; i < totalSampleCount; ++i) {
+            s32Out[i] = drwav__clamp_and_round_s32(drwav__load_f64(pDataIn + i*8));
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Converts raw sample data in the internal format of the given wav file to one of the output formats.
+typedef void (* drwav__convert_proc)(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut);
+
+static void drwav__convert_to_s16(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    switch (pWav->translatedFormatTag)
+    {
+        case DR_WAVE_FORMAT_PCM:        drwav__pcm_to_s16(totalSampleCount, pDataIn, pWav->bytesPerSample, (short*)pDataOut);  break;
+        case DR_WAVE_FORMAT_IEEE_FLOAT: drwav__ieee_to_s16(totalSampleCount, pDataIn, pWav->bytesPerSample, (short*)pDataOut); break;
+        case DR_WAVE_FORMAT_ALAW:       drwav_alaw_to_s16(totalSampleCount, pDataIn, (short*)pDataOut);                        break;
+        case DR_WAVE_FORMAT_MULAW:      drwav_ulaw_to_s16(totalSampleCount, pDataIn, (short*)pDataOut);                        break;
+        default: break;
+    }
+}
+
+static void drwav__convert_to_s32(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    switch (pWav->translatedFormatTag)
+    {
+        case DR_WAVE_FORMAT_PCM:        drwav__pcm_to_s32(totalSampleCount, pDataIn, pWav->bytesPerSample, (int*)pDataOut);  break;
+        case DR_WAVE_FORMAT_IEEE_FLOAT: drwav__ieee_to_s32(totalSampleCount, pDataIn, pWav->bytesPerSample, (int*)pDataOut); break;
+        case DR_WAVE_FORMAT_ALAW:       drwav_alaw_to_s32(totalSampleCount, pDataIn, (int*)pDataOut);                        break;
+        case DR_WAVE_FORMAT_MULAW:      drwav_ulaw_to_s32(totalSampleCount, pDataIn, (int*)pDataOut);                        break;
+        default: break;
+    }
+}
+
+static void drwav__convert_to_f32(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    switch (pWav->translatedFormatTag)
+    {
+        case DR_WAVE_FORMAT_PCM:        drwav__pcm_to_f32(totalSampleCount, pDataIn, pWav->bytesPerSample, (float*)pDataOut);  break;
+        case DR_WAVE_FORMAT_IEEE_FLOAT: drwav__ieee_to_f32(totalSampleCount, pDataIn, pWav->bytesPerSample, (float*)pDataOut); break;
+        case DR_WAVE_FORMAT_ALAW:       drwav_alaw_to_f32(totalSampleCount, pDataIn, (float*)pDataOut);                        break;
+        case DR_WAVE_FORMAT_MULAW:      drwav_ulaw_to_f32(totalSampleCount, pDataIn, (float*)pDataOut);                        break;
+        default: break;
+    }
+}
+
+static int drwav__is_conversion_supported(drwav* pWav)
+{
+    if (pWav->bytesPerSample == 0) {
+        return 0;
+    }
+
+    switch (pWav->translatedFormatTag)
+    {
+        case DR_WAVE_FORMAT_PCM:        return 1;
+        case DR_WAVE_FORMAT_IEEE_FLOAT: return pWav->bytesPerSample == 4 || pWav->bytesPerSample == 8;
+        case DR_WAVE_FORMAT_ALAW:       return pWav->bytesPerSample == 1;
+        case DR_WAVE_FORMAT_MULAW:      return pWav->bytesPerSample == 1;
+        default: return 0;
+    }
+}
+
+static size_t drwav__convert_raw(drwav* pWav, size_t sampleCount, const void* pRawData, void* pBufferOut, drwav__convert_proc onConvert)
+{
+    if (pWav == NULL || pRawData == NULL || pBufferOut == NULL || !drwav__is_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    onConvert(pWav, sampleCount, pRawData, pBufferOut);
+    return sampleCount;
+}
+
+size_t drwav_convert_raw_to_s16(drwav* pWav, size_t sampleCount, const void* pRawData, int16_t* pBufferOut)
+{
+    return drwav__convert_raw(pWav, sampleCount, pRawData, pBufferOut, drwav__convert_to_s16);
+}
+
+size_t drwav_convert_raw_to_s32(drwav* pWav, size_t sampleCount, const void* pRawData, int32_t* pBufferOut)
+{
+    return drwav__convert_raw(pWav, sampleCount, pRawData, pBufferOut, drwav__convert_to_s32);
+}
+
+size_t drwav_convert_raw_to_f32(drwav* pWav, size_t sampleCount, const void* pRawData, float* pBufferOut)
+{
+    return drwav__convert_raw(pWav, sampleCount, pRawData, pBufferOut, drwav__convert_to_f32);
+}
+
+
+static void drwav__convert_from_s16(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    const short* s16In = (const short*)pDataIn;
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
+        drwav_s16PCM_to_f32(totalSampleCount, s16In, (float*)pDataOut);
+        return;
+    }
+
+    switch (pWav->bytesPerSample)
+    {
+        case 2: memcpy(pDataOut, s16In, totalSampleCount * sizeof(short));                 break;
+        case 3: drwav_s16PCM_to_s24(totalSampleCount, s16In, (unsigned char*)pDataOut);   break;
+        case 4: drwav_s16PCM_to_s32(totalSampleCount, s16In, (int*)pDataOut);             break;
+        default: break;
+    }
+}
+
+static void drwav__convert_from_s32(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    const int* s32In = (const int*)pDataIn;
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
+        drwav_s32PCM_to_f32(totalSampleCount, s32In, (float*)pDataOut);
+        return;
+    }
+
+    switch (pWav->bytesPerSample)
+    {
+        case 2: drwav_s32PCM_to_s16(totalSampleCount, s32In, (short*)pDataOut);           break;
+        case 3: drwav_s32PCM_to_s24(totalSampleCount, s32In, (unsigned char*)pDataOut);   break;
+        case 4: memcpy(pDataOut, s32In, totalSampleCount * sizeof(int));                   break;
+        default: break;
+    }
+}
+
+static void drwav__convert_from_f32(drwav* pWav, size_t totalSampleCount, const unsigned char* pDataIn, void* pDataOut)
+{
+    const float* f32In = (const float*)pDataIn;
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
+        memcpy(pDataOut, f32In, totalSampleCount * sizeof(float));
+        return;
+    }
+
+    if (pWav->isWriteDitherEnabled) {
+        switch (pWav->bytesPerSample)
+        {
+            case 2: drwav_f32_to_s16_dithered(totalSampleCount, f32In, (short*)pDataOut, &pWav->writeDither);          return;
+            case 3: drwav_f32_to_s24_dithered(totalSampleCount, f32In, (unsigned char*)pDataOut, &pWav->writeDither);  return;
+            default: break;
+        }
+    }
+
+    switch (pWav->bytesPerSample)
+    {
+        case 2: drwav_f32_to_s16(totalSampleCount, f32In, (short*)pDataOut);              break;
+        case 3: drwav_f32_to_s24(totalSampleCount, f32In, (unsigned char*)pDataOut);      break;
+        case 4: drwav_f32_to_s32(totalSampleCount, f32In, (int*)pDataOut);                break;
+        default: break;
+    }
+}
+
+static int drwav__is_write_conversion_supported(drwav* pWav)
+{
+    switch (pWav->translatedFormatTag)
+    {
+        case DR_WAVE_FORMAT_PCM:        return pWav->bytesPerSample >= 2 && pWav->bytesPerSample <= 4;
+        case DR_WAVE_FORMAT_IEEE_FLOAT: return pWav->bytesPerSample == 4;
+        default: return 0;
+    }
+}
+
+// Converts samples straight into the write buffer, flushing it whenever it fills up.
+static size_t drwav__convert_and_write(drwav* pWav, size_t samplesToWrite, const void* pData, unsigned int bytesPerSampleIn, drwav__convert_proc onConvert)
+{
+    if (pWav == NULL || pWav->onWrite == NULL || pData == NULL || pWav->writeFailed) {
+        return 0;
+    }
+
+    if (!drwav__is_write_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    // The conversion kernels need the output to be aligned, which it won't be if drwav_write_raw() has been used to write
+    // a partial sample.
+    if ((pWav->writeBufferSize % pWav->bytesPerSample) != 0) {
+        if (!drwav__flush_write_buffer(pWav)) {
+            return 0;
+        }
+    }
+
+    const unsigned char* pRunningData = pData;
+    size_t samplesWritten = 0;
+
+    // Without a write buffer the samples are converted through a temporary buffer on the stack instead.
+    if (pWav->writeBufferCapacity == 0) {
+        while (samplesWritten < samplesToWrite)
+        {
+            unsigned char converted[4096];
+            size_t samplesThisIteration = sizeof(converted) / pWav->bytesPerSample;
+            if (samplesThisIteration > samplesToWrite - samplesWritten) {
+                samplesThisIteration = samplesToWrite - samplesWritten;
+            }
+
+            onConvert(pWav, samplesThisIteration, pRunningData, converted);
+            size_t samplesWrittenThisIteration = drwav_write(pWav, samplesThisIteration, converted);
+            samplesWritten += samplesWrittenThisIteration;
+            if (samplesWrittenThisIteration != samplesThisIteration) {
+                break;
+            }
+
+            pRunningData += samplesThisIteration * bytesPerSampleIn;
+        }
+
+        return samplesWritten;
+    }
+
+    while (samplesWritten < samplesToWrite)
+    {
+        size_t samplesThisIteration = (pWav->writeBufferCapacity - pWav->writeBufferSize) / pWav->bytesPerSample;
+        if (samplesThisIteration > samplesToWrite - samplesWritten) {
+            samplesThisIteration = samplesToWrite - samplesWritten;
+        }
+
+        onConvert(pWav, samplesThisIteration, pRunningData, pWav->pWriteBuffer + pWav->writeBufferSize);
+        pWav->writeBufferSize += samplesThisIteration * pWav->bytesPerSample;
+        pRunningData += samplesThisIteration * bytesPerSampleIn;
+        samplesWritten += samplesThisIteration;
+
+        if (pWav->writeBufferCapacity - pWav->writeBufferSize < pWav->bytesPerSample) {
+            if (!drwav__flush_write_buffer(pWav)) {
+                break;
+            }
+        }
+    }
+
+    pWav->dataChunkDataSize += samplesWritten * pWav->bytesPerSample;
+    pWav->totalSampleCount   = pWav->dataChunkDataSize / pWav->bytesPerSample;
+    return samplesWritten;
+}
+
+size_t drwav_write_s16(drwav* pWav, size_t samplesToWrite, const int16_t* pData)
+{
+    return drwav__convert_and_write(pWav, samplesToWrite, pData, sizeof(int16_t), drwav__convert_from_s16);
+}
+
+size_t drwav_write_s32(drwav* pWav, size_t samplesToWrite, const int32_t* pData)
+{
+    return drwav__convert_and_write(pWav, samplesToWrite, pData, sizeof(int32_t), drwav__convert_from_s32);
+}
+
+size_t drwav_write_f32(drwav* pWav, size_t samplesToWrite, const float* pData)
+{
+    return drwav__convert_and_write(pWav, samplesToWrite, pData, sizeof(float), drwav__convert_from_f32);
+}
+
+void drwav_set_write_dither(drwav* pWav, int enabled)
+{
+    if (pWav == NULL) {
+        return;
+    }
+
+    pWav->isWriteDitherEnabled = enabled;
+    drwav_dither_init(&pWav->writeDither, 0);
+}
+
+static size_t drwav__read_and_convert(drwav* pWav, size_t samplesToRead, void* pBufferOut, unsigned int bytesPerSampleOut, drwav__convert_proc onConvert)
+{
+    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (!drwav__is_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    unsigned char* pRunningBufferOut = pBufferOut;
+    unsigned int bytesPerSampleIn = pWav->bytesPerSample;
+
+    // The raw data is positioned based on the number of samples being read so we can't request more than what's available.
+    if (samplesToRead > pWav->bytesRemaining / bytesPerSampleIn) {
+        samplesToRead = (size_t)(pWav->bytesRemaining / bytesPerSampleIn);
+        if (samplesToRead == 0) {
+            return 0;
+        }
+    }
+
+    // If the raw data is no larger than the converted data we can read everything straight into the tail of the output buffer
+    // with a single call to onRead() and then convert in place. The conversion kernels walk forward, and because the input
+    // is packed into the tail, the output sample they write never reaches an input sample that hasn't yet been read.
+    if (bytesPerSampleIn <= bytesPerSampleOut) {
+        size_t tailOffset = samplesToRead * (bytesPerSampleOut - bytesPerSampleIn);
+        size_t samplesRead = drwav_read(pWav, samplesToRead, pRunningBufferOut + tailOffset, samplesToRead * bytesPerSampleIn);
+        if (samplesRead > 0) {
+            onConvert(pWav, samplesRead, pRunningBufferOut + tailOffset, pRunningBufferOut);
+        }
+
+        return samplesRead;
+    }
+
+
+    // If we get here it means the raw data is larger than the converted data (reading a 24-bit file as s16, for example). In
+    // this case we read as many samples as will fit in the part of the output buffer that hasn't yet been filled, and convert
+    // them in place from the front. Each iteration fills a fixed fraction of what's left, so only a handful of reads are
+    // needed. The last few samples don't fit and go through a small stack buffer.
+    size_t totalSamplesRead = 0;
+    while (samplesToRead > 0)
+    {
+        unsigned char sampleData[4096];
+        if (samplesToRead * bytesPerSampleIn <= sizeof(sampleData))
+        {
+            size_t samplesRead = drwav_read(pWav, samplesToRead, sampleData, sizeof(sampleData));
+            if (samplesRead > 0) {
+                onConvert(pWav, samplesRead, sampleData, pRunningBufferOut);
+            }
+
+            totalSamplesRead += samplesRead;
+            break;
+        }
+
+        size_t samplesThisIteration = (samplesToRead * bytesPerSampleOut) / bytesPerSampleIn;
+        size_t samplesRead = drwav_read(pWav, samplesThisIteration, pRunningBufferOut, samplesThisIteration * bytesPerSampleIn);
+        if (samplesRead == 0) {
+            break;
+        }
+
+        onConvert(pWav, samplesRead, pRunningBufferOut, pRunningBufferOut);
+
+        pRunningBufferOut += samplesRead * bytesPerSampleOut;
+        samplesToRead     -= samplesRead;
+        totalSamplesRead  += samplesRead;
+
+        if (samplesRead < samplesThisIteration) {
+            break;  // Reached the end.
+        }
+    }
+
+    return totalSamplesRead;
+}
+
+
+//// ADPCM ////
+
+static int drwav__is_adpcm(drwav* pWav)
+{
+    return pWav->translatedFormatTag == DR_WAVE_FORMAT_ADPCM || pWav->translatedFormatTag == DR_WAVE_FORMAT_DVI_ADPCM;
+}
+
+static const int drwav__msadpcm_adaptation_table[16] = {
+    230, 230, 230, 230, 307, 409, 512, 614,
+    768, 614, 512, 409, 307, 230, 230, 230
+};
+
+static const int drwav__ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int drwav__ima_step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static DRWAV_INLINE int drwav__clamp_s16(int x)
+{
+    if (x < -32768) {
+        return -32768;
+    }
+    if (x > 32767) {
+        return 32767;
+    }
+
+    return x;
+}
+
+static DRWAV_INLINE int drwav__msadpcm_decode_nibble(int nibble, int* pPrevSamples, int* pDelta, const int* pCoeff)
+{
+    int signedNibble = (nibble & 0x08) ? nibble - 16 : nibble;
+    int predictor = ((pPrevSamples[0] * pCoeff[0]) + (pPrevSamples[1] * pCoeff[1])) >> 8;
+    int sample = drwav__clamp_s16(predictor + signedNibble * (*pDelta));
+
+    pPrevSamples[1] = pPrevSamples[0];
+    pPrevSamples[0] = sample;
+
+    *pDelta = (drwav__msadpcm_adaptation_table[nibble] * (*pDelta)) >> 8;
+    if (*pDelta < 16) {
+        *pDelta = 16;
+    }
+
+    return sample;
+}
+
+static DRWAV_INLINE int drwav__ima_decode_nibble(int nibble, int* pPredictor, int* pStepIndex)
+{
+    int step = drwav__ima_step_table[*pStepIndex];
+
+    int diff = step >> 3;
+    if (nibble & 1) diff += step >> 2;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 4) diff += step;
+    if (nibble & 8) diff  = -diff;
+
+    *pPredictor = drwav__clamp_s16(*pPredictor + diff);
+
+    *pStepIndex += drwav__ima_index_table[nibble];
+    if (*pStepIndex < 0) {
+        *pStepIndex = 0;
+    }
+    if (*pStepIndex > 88) {
+        *pStepIndex = 88;
+    }
+
+    return *pPredictor;
+}
+
+// Decodes whole bytes of Microsoft ADPCM data. Each byte decodes to two samples, high nibble first. For stereo streams the high
+// nibble belongs to the left channel and the low nibble to the right.
+//
+// This walks forward and writes the two samples for a byte only after it has been read, so <pCompressed> can sit at the tail of
+// <pSamplesOut>.
+static void drwav__msadpcm_decode_bytes(drwav* pWav, const unsigned char* pCompressed, size_t byteCount, int16_t* pSamplesOut)
+{
+    // The decoder state is pulled into locals for the duration of the loop.
+    int prev0[2] = {pWav->compressed.prevSamples[0][0], pWav->compressed.prevSamples[0][1]};
+    int prev1[2] = {pWav->compressed.prevSamples[1][0], pWav->compressed.prevSamples[1][1]};
+    int delta0 = pWav->compressed.delta[0];
+    int delta1 = pWav->compressed.delta[1];
+    const int* pCoeff0 = pWav->compressed.coeff[0];
+    const int* pCoeff1 = pWav->compressed.coeff[1];
+
+    if (pWav->channels == 1) {
+        for (size_t i = 0; i < byteCount; ++i) {
+            unsigned char b = pCompressed[i];
+            int s0 = drwav__msadpcm_decode_nibble((b >> 4) & 0x0F, prev0, &delta0, pCoeff0);
+            int s1 = drwav__msadpcm_decode_nibble((b >> 0) & 0x0F, prev0, &delta0, pCoeff0);
+            pSamplesOut[i*2 + 0] = (int16_t)s0;
+            pSamplesOut[i*2 + 1] = (int16_t)s1;
+        }
+    } else {
+        for (size_t i = 0; i < byteCount; ++i) {
+            unsigned char b = pCompressed[i];
+            int s0 = drwav__msadpcm_decode_nibble((b >> 4) & 0x0F, prev0, &delta0, pCoeff0);
+            int s1 = drwav__msadpcm_decode_nibble((b >> 0) & 0x0F, prev1, &delta1, pCoeff1);
+            pSamplesOut[i*2 + 0] = (int16_t)s0;
+            pSamplesOut[i*2 + 1] = (int16_t)s1;
+        }
+    }
+
+    pWav->compressed.prevSamples[0][0] = prev0[0];
+    pWav->compressed.prevSamples[0][1] = prev0[1];
+    pWav->compressed.prevSamples[1][0] = prev1[0];
+    pWav->compressed.prevSamples[1][1] = prev1[1];
+    pWav->compressed.delta[0] = delta0;
+    pWav->compressed.delta[1] = delta1;
+}
+
+// Decodes whole groups of IMA ADPCM data. A group is 4 bytes per channel, with the bytes of each channel stored one after the
+// other, and decodes to 8 sample frames. The low nibble of each byte comes first.
+//
+// An entire group is read before any of it's samples are written, so <pCompressed> can sit at the tail of <pSamplesOut>.
+static void drwav__ima_decode_groups(drwav* pWav, const unsigned char* pCompressed, size_t groupCount, int16_t* pSamplesOut)
+{
+    unsigned int channels = pWav->channels;
+
+    for (size_t iGroup = 0; iGroup < groupCount; ++iGroup) {
+        unsigned char group[8];
+        memcpy(group, pCompressed, 4*channels);
+        pCompressed += 4*channels;
+
+        for (unsigned int ch = 0; ch < channels; ++ch) {
+            int predictor = pWav->compressed.prevSamples[ch][0];
+            int stepIndex = pWav->compressed.stepIndex[ch];
+
+            for (unsigned int iByte = 0; iByte < 4; ++iByte) {
+                unsigned char b = group[ch*4 + iByte];
+                pSamplesOut[((iByte*2) + 0)*channels + ch] = (int16_t)drwav__ima_decode_nibble((b >> 0) & 0x0F, &predictor, &stepIndex);
+                pSamplesOut[((iByte*2) + 1)*channels + ch] = (int16_t)drwav__ima_decode_nibble((b >> 4) & 0x0F, &predictor, &stepIndex);
+            }
+
+            pWav->compressed.prevSamples[ch][0] = predictor;
+            pWav->compressed.stepIndex[ch] = stepIndex;
+        }
+
+        pSamplesOut += 8*channels;
+    }
+}
+
+static int drwav__adpcm_load_block_header(drwav* pWav)
+{
+    unsigned int channels = pWav->channels;
+    unsigned int headerSize = ((pWav->translatedFormatTag == DR_WAVE_FORMAT_ADPCM) ? 7 : 4) * channels;
+
+    unsigned char header[14];
+    if (drwav_read_raw(pWav, header, headerSize) != headerSize) {
+        return 0;
+    }
+
+    int16_t* pCachedSamples;
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_ADPCM) {
+        // The header stores the predictor index for each channel, followed by the delta, the most recent sample and the
+        // sample before that. The two samples are the first two frames of the block, oldest first.
+        pWav->compressed.cachedSampleCount = 2*channels;
+        pCachedSamples = pWav->compressed.cachedSamples + (16 - pWav->compressed.cachedSampleCount);
+
+        for (unsigned int ch = 0; ch < channels; ++ch) {
+            unsigned int predictor = header[ch];
+            if (predictor >= pWav->compressed.coeffCount) {
+                pWav->compressed.cachedSampleCount = 0;
+                return 0;   // Invalid predictor.
+            }
+
+            pWav->compressed.coeff[ch][0]       = pWav->compressed.coeffTable[predictor][0];
+            pWav->compressed.coeff[ch][1]       = pWav->compressed.coeffTable[predictor][1];
+            pWav->compressed.delta[ch]          = (int16_t)drwav__read_u16(header + channels*1 + ch*2);
+            pWav->compressed.prevSamples[ch][0] = (int16_t)drwav__read_u16(header + channels*3 + ch*2);
+            pWav->compressed.prevSamples[ch][1] = (int16_t)drwav__read_u16(header + channels*5 + ch*2);
+
+            pCachedSamples[0*channels + ch] = (int16_t)pWav->compressed.prevSamples[ch][1];
+            pCachedSamples[1*channels + ch] = (int16_t)pWav->compressed.prevSamples[ch][0];
+        }
+    } else {
+        // The header stores the initial predictor and step index for each channel. The predictor is the first frame.
+        pWav->compressed.cachedSampleCount = channels;
+        pCachedSamples = pWav->compressed.cachedSamples + (16 - pWav->compressed.cachedSampleCount);
+
+        for (unsigned int ch = 0; ch < channels; ++ch) {
+            int stepIndex = header[ch*4 + 2];
+            if (stepIndex > 88) {
+                stepIndex = 88;
+            }
+
+            pWav->compressed.prevSamples[ch][0] = (int16_t)drwav__read_u16(header + ch*4 + 0);
+            pWav->compressed.stepIndex[ch]      = stepIndex;
+
+            pCachedSamples[ch] = (int16_t)pWav->compressed.prevSamples[ch][0];
+        }
+    }
+
+    uint64_t bytesRemainingInBlock = pWav->fmt.blockAlign - headerSize;
+    if (bytesRemainingInBlock > pWav->bytesRemaining) {
+        bytesRemainingInBlock = pWav->bytesRemaining;   // The last block is not whole.
+    }
+
+    pWav->compressed.bytesRemainingInBlock = (unsigned int)bytesRemainingInBlock;
+    return 1;
+}
+
+static size_t drwav__read_s16_adpcm(drwav* pWav, size_t samplesToRead, int16_t* pBufferOut)
+{
+    assert(pWav != NULL);
+    assert(pBufferOut != NULL);
+
+    // The last block is usually padded so we need to make sure we stop at the sample count. When the length isn't known we
+    // just decode until the data runs out.
+    if (pWav->totalSampleCount > 0 || pWav->dataChunkDataSize != DRWAV_UNKNOWN_DATA_SIZE) {
+        if (pWav->compressed.iCurrentSample >= pWav->totalSampleCount) {
+            return 0;
+        }
+        if (samplesToRead > pWav->totalSampleCount - pWav->compressed.iCurrentSample) {
+            samplesToRead = (size_t)(pWav->totalSampleCount - pWav->compressed.iCurrentSample);
+        }
+    }
+
+    unsigned int channels = pWav->channels;
+    int isMS = pWav->translatedFormatTag == DR_WAVE_FORMAT_ADPCM;
+
+    size_t totalSamplesRead = 0;
+    while (samplesToRead > 0)
+    {
+        // Left over samples from the block header or a previous partial decode always come first.
+        if (pWav->compressed.cachedSampleCount > 0)
+        {
+            size_t samplesToCopy = pWav->compressed.cachedSampleCount;
+            if (samplesToCopy > samplesToRead) {
+                samplesToCopy = samplesToRead;
+            }
+
+            memcpy(pBufferOut, pWav->compressed.cachedSamples + (16 - pWav->compressed.cachedSampleCount), samplesToCopy * sizeof(int16_t));
+            pWav->compressed.cachedSampleCount -= (unsigned int)samplesToCopy;
+
+            pBufferOut       += samplesToCopy;
+            samplesToRead    -= samplesToCopy;
+            totalSamplesRead += samplesToCopy;
+            continue;
+        }
+
+        if (pWav->compressed.bytesRemainingInBlock == 0)
+        {
+            if (!drwav__adpcm_load_block_header(pWav)) {
+                break;
+            }
+            continue;
+        }
+
+
+        // Whole bytes (or IMA groups) are decoded straight into the output buffer. The compressed data is read into the tail of
+        // the part of the output buffer it decodes into with a single read, and decoded forward in place.
+        size_t bytesPerUnit   = isMS ? 1 : 4*channels;
+        size_t samplesPerUnit = isMS ? 2 : 8*channels;
+
+        if (pWav->compressed.bytesRemainingInBlock < bytesPerUnit)
+        {
+            // This is left over padding at the end of an IMA block that doesn't make up a whole group. It needs to be skipped.
+            unsigned char padding[8];
+            drwav_read_raw(pWav, padding, pWav->compressed.bytesRemainingInBlock);
+            pWav->compressed.bytesRemainingInBlock = 0;
+            continue;
+        }
+
+        size_t unitsToDecode = samplesToRead / samplesPerUnit;
+        if (unitsToDecode > pWav->compressed.bytesRemainingInBlock / bytesPerUnit) {
+            unitsToDecode = pWav->compressed.bytesRemainingInBlock / bytesPerUnit;
+        }
+
+        if (unitsToDecode == 0)
+        {
+            // Fewer samples were requested than a single unit decodes to. Decode it into the cache.
+            unsigned char unit[8];
+            if (drwav_read_raw(pWav, unit, bytesPerUnit) != bytesPerUnit) {
+                pWav->compressed.bytesRemainingInBlock = 0;
+                break;
+            }
+
+            pWav->compressed.bytesRemainingInBlock -= (unsigned int)bytesPerUnit;
+
+            int16_t* pCachedSamples = pWav->compressed.cachedSamples + (16 - samplesPerUnit);
+            if (isMS) {
+                drwav__msadpcm_decode_bytes(pWav, unit, 1, pCachedSamples);
+            } else {
+                drwav__ima_decode_groups(pWav, unit, 1, pCachedSamples);
+            }
+
+            pWav->compressed.cachedSampleCount = (unsigned int)samplesPerUnit;
+            continue;
+        }
+
+        size_t bytesToDecode = unitsToDecode * bytesPerUnit;
+        unsigned char* pCompressed = (unsigned char*)(pBufferOut + unitsToDecode*samplesPerUnit) - bytesToDecode;
+
+        size_t bytesRead = drwav_read_raw(pWav, pCompressed, bytesToDecode);
+        size_t unitsRead = bytesRead / bytesPerUnit;
+        if (isMS) {
+            drwav__msadpcm_decode_bytes(pWav, pCompressed, unitsRead, pBufferOut);
+        } else {
+            drwav__ima_decode_groups(pWav, pCompressed, unitsRead, pBufferOut);
+        }
+
+        pWav->compressed.bytesRemainingInBlock -= (unsigned int)bytesRead;
+
+        pBufferOut       += unitsRead * samplesPerUnit;
+        samplesToRead    -= unitsRead * samplesPerUnit;
+        totalSamplesRead += unitsRead * samplesPerUnit;
+
+        if (bytesRead < bytesToDecode) {
+            pWav->compressed.bytesRemainingInBlock = 0;
+            break;  // Reached the end of the data.
+        }
+    }
+
+    pWav->compressed.iCurrentSample += totalSamplesRead;
+    return totalSamplesRead;
+}
+
+static int drwav__seek_adpcm(drwav* pWav, uint64_t sample)
+{
+    uint64_t samplesPerBlock   = (uint64_t)pWav->compressed.framesPerBlock * pWav->channels;
+    uint64_t targetBlockIndex  = sample / samplesPerBlock;
+    uint64_t currentBlockIndex = pWav->compressed.iCurrentSample / samplesPerBlock;
+
+    // If the sample is further into the block we're currently decoding we can just decode forward. Otherwise we need to move to
+    // the start of it's block.
+    if (targetBlockIndex != currentBlockIndex || sample < pWav->compressed.iCurrentSample)
+    {
+        if (!drwav__seek_to_data_byte(pWav, targetBlockIndex * pWav->fmt.blockAlign)) {
+            return 0;
+        }
+
+        pWav->compressed.bytesRemainingInBlock = 0;
+        pWav->compressed.cachedSampleCount     = 0;
+        pWav->compressed.iCurrentSample        = targetBlockIndex * samplesPerBlock;
+    }
+
+    // Decode and discard up to the target sample.
+    while (pWav->compressed.iCurrentSample < sample)
+    {
+        int16_t discarded[2048];
+
+        uint64_t samplesToDiscard = sample - pWav->compressed.iCurrentSample;
+        if (samplesToDiscard > sizeof(discarded)/sizeof(discarded[0])) {
+            samplesToDiscard = sizeof(discarded)/sizeof(discarded[0]);
+        }
+
+        if (drwav__read_s16_adpcm(pWav, (size_t)samplesToDiscard, discarded) == 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+size_t drwav_read_s16(drwav* pWav, size_t samplesToRead, int16_t* pBufferOut)
+{
+    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (drwav__is_adpcm(pWav)) {
+        return drwav__read_s16_adpcm(pWav, samplesToRead, pBufferOut);
+    }
+
+    // Fast path.
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_PCM && pWav->bytesPerSample == 2) {
+        return drwav_read(pWav, samplesToRead, pBufferOut, samplesToRead * sizeof(int16_t));
+    }
+
+    return drwav__read_and_convert(pWav, samplesToRead, pBufferOut, sizeof(int16_t), drwav__convert_to_s16);
+}
+
+size_t drwav_read_s32(drwav* pWav, size_t samplesToRead, int32_t* pBufferOut)
+{
+    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (drwav__is_adpcm(pWav)) {
+        // Decode to s16 into the second half of the output buffer and then convert in place.
+        int16_t* pS16 = (int16_t*)(pBufferOut + samplesToRead) - samplesToRead;
+        size_t samplesRead = drwav__read_s16_adpcm(pWav, samplesToRead, pS16);
+        drwav_s16PCM_to_s32(samplesRead, pS16, pBufferOut);
+        return samplesRead;
+    }
+
+    // Fast path.
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_PCM && pWav->bytesPerSample == 4) {
+        return drwav_read(pWav, samplesToRead, pBufferOut, samplesToRead * sizeof(int32_t));
+    }
+
+    return drwav__read_and_convert(pWav, samplesToRead, pBufferOut, sizeof(int32_t), drwav__convert_to_s32);
+}
+
+size_t drwav_read_f32(drwav* pWav, size_t samplesToRead, float* pBufferOut)
+{
+    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    if (drwav__is_adpcm(pWav)) {
+        // Decode to s16 into the second half of the output buffer and then convert in place.
+        int16_t* pS16 = (int16_t*)(pBufferOut + samplesToRead) - samplesToRead;
+        size_t samplesRead = drwav__read_s16_adpcm(pWav, samplesToRead, pS16);
+        drwav_s16PCM_to_f32(samplesRead, pS16, pBufferOut);
+        return samplesRead;
+    }
+
+    // Fast path.
+    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT && pWav->bytesPerSample == 4) {
+        return drwav_read(pWav, samplesToRead, pBufferOut, samplesToRead * sizeof(float));
+    }
+
+    return drwav__read_and_convert(pWav, samplesToRead, pBufferOut, sizeof(float), drwav__convert_to_f32);
+}
+
+#define DRWAV_MAX_DOWNMIX_CHANNELS  32
+
+// Retrieves how much of the given speaker goes to the left and right side of a stereo mix.
+static void drwav__get_speaker_weights(unsigned int speaker, float* pLeft, float* pRight)
+{
+    const float h = 0.70710678f;    // -3dB
+
+    switch (speaker)
+    {
+        case DR_WAVE_SPEAKER_FRONT_LEFT:
+        case DR_WAVE_SPEAKER_FRONT_LEFT_OF_CENTER:  *pLeft = 1; *pRight = 0; break;
+        case DR_WAVE_SPEAKER_FRONT_RIGHT:
+        case DR_WAVE_SPEAKER_FRONT_RIGHT_OF_CENTER: *pLeft = 0; *pRight = 1; break;
+        case DR_WAVE_SPEAKER_FRONT_CENTER:          *pLeft = h; *pRight = h; break;
+        case DR_WAVE_SPEAKER_LOW_FREQUENCY:         *pLeft = 0; *pRight = 0; break;
+        case DR_WAVE_SPEAKER_BACK_LEFT:
+        case DR_WAVE_SPEAKER_SIDE_LEFT:
+        case DR_WAVE_SPEAKER_TOP_FRONT_LEFT:
+        case DR_WAVE_SPEAKER_TOP_BACK_LEFT:         *pLeft = h; *pRight = 0; break;
+        case DR_WAVE_SPEAKER_BACK_RIGHT:
+        case DR_WAVE_SPEAKER_SIDE_RIGHT:
+        case DR_WAVE_SPEAKER_TOP_FRONT_RIGHT:
+        case DR_WAVE_SPEAKER_TOP_BACK_RIGHT:        *pLeft = 0; *pRight = h; break;
+
+        // Everything else, including channels that aren't covered by the channel mask, is spread evenly between both sides.
+        default:                                    *pLeft = 0.5f; *pRight = 0.5f; break;
+    }
+}
+
+// Fills <pWeights> with the mixing matrix, where pWeights[c*outputChannels + o] is the weight of input channel c in output
+// channel o.
+static int drwav__build_downmix_matrix(drwav* pWav, unsigned int outputChannels, float* pWeights)
+{
+    unsigned int channels = pWav->channels;
+    if (channels == 0 || channels > DRWAV_MAX_DOWNMIX_CHANNELS || (outputChannels != 1 && outputChannels != 2)) {
+        return 0;
+    }
+
+    if (channels == 1) {
+        for (unsigned int o = 0; o < outputChannels; ++o) {
+            pWeights[o] = 1;
+        }
+        return 1;
+    }
+
+    unsigned int channelMask = pWav->fmt.channelMask;
+    if (channelMask == 0) {
+        channelMask = drwav__default_channel_mask(channels);
+    }
+
+    // Channels are stored in the order of the bits in the mask.
+    for (unsigned int c = 0; c < channels; ++c)
+    {
+        unsigned int speaker = channelMask & (~channelMask + 1);
+        channelMask &= ~speaker;
+
+        float left;
+        float right;
+        drwav__get_speaker_weights(speaker, &left, &right);
+
+        if (outputChannels == 1) {
+            pWeights[c] = (left + right) * 0.5f;
+        } else {
+            pWeights[c*2 + 0] = left;
+            pWeights[c*2 + 1] = right;
+        }
+    }
+
+    // Scale everything down if a full scale signal on every channel could clip.
+    float maxSum = 0;
+    for (unsigned int o = 0; o < outputChannels; ++o)
+    {
+        float sum = 0;
+        for (unsigned int c = 0; c < channels; ++c) {
+            sum += pWeights[c*outputChannels + o];
+        }
+
+        if (maxSum < sum) {
+            maxSum = sum;
+        }
+    }
+
+    if (maxSum > 1) {
+        for (unsigned int i = 0; i < channels*outputChannels; ++i) {
+            pWeights[i] /= maxSum;
+        }
+    }
+
+    return 1;
+}
+
+// Mixes interleaved samples. pWeights[c*outputChannels + o] is the weight of input channel c in output channel o. This is
+// always inlined so that the common channel counts get their own copy with the inner loops fully unrolled.
+static DRWAV_INLINE void drwav__downmix_f32__inline(size_t frameCount, unsigned int channels, unsigned int outputChannels, const float* pWeights, const float* pIn, float* pOut)
+{
+    // A local copy so the weights can stay in registers. Otherwise they'd be reloaded after every store to <pOut>.
+    float weights[DRWAV_MAX_DOWNMIX_CHANNELS * 2];
+    for (unsigned int i = 0; i < channels*outputChannels; ++i) {
+        weights[i] = pWeights[i];
+    }
+
+    for (size_t iFrame = 0; iFrame < frameCount; ++iFrame)
+    {
+        for (unsigned int o = 0; o < outputChannels; ++o)
+        {
+            float sum = 0;
+            for (unsigned int c = 0; c < channels; ++c) {
+                sum += pIn[c] * weights[c*outputChannels + o];
+            }
+
+            *pOut++ = sum;
+        }
+
+        pIn += channels;
+    }
+}
+
+static void drwav__downmix_f32(size_t frameCount, unsigned int channels, unsigned int outputChannels, const float* pWeights, const float* pIn, float* pOut)
+{
+    if (outputChannels == 1) {
+        switch (channels)
+        {
+            case 2: drwav__downmix_f32__inline(frameCount, 2, 1, pWeights, pIn, pOut); return;
+            case 4: drwav__downmix_f32__inline(frameCount, 4, 1, pWeights, pIn, pOut); return;
+            case 6: drwav__downmix_f32__inline(frameCount, 6, 1, pWeights, pIn, pOut); return;
+            case 8: drwav__downmix_f32__inline(frameCount, 8, 1, pWeights, pIn, pOut); return;
+            default: break;
+        }
+    } else {
+        switch (channels)
+        {
+            case 1: drwav__downmix_f32__inline(frameCount, 1, 2, pWeights, pIn, pOut); return;
+            case 4: drwav__downmix_f32__inline(frameCount, 4, 2, pWeights, pIn, pOut); return;
+            case 6: drwav__downmix_f32__inline(frameCount, 6, 2, pWeights, pIn, pOut); return;
+            case 8: drwav__downmix_f32__inline(frameCount, 8, 2, pWeights, pIn, pOut); return;
+            default: break;
+        }
+    }
+
+    drwav__downmix_f32__inline(frameCount, channels, outputChannels, pWeights, pIn, pOut);
+}
+
+size_t drwav_read_f32_downmixed(drwav* pWav, unsigned int outputChannels, size_t framesToRead, float* pBufferOut)
+{
+    if (pWav == NULL || framesToRead == 0 || pBufferOut == NULL) {
+        return 0;
+    }
+
+    float weights[DRWAV_MAX_DOWNMIX_CHANNELS * 2];
+    if (!drwav__build_downmix_matrix(pWav, outputChannels, weights)) {
+        return 0;
+    }
+
+    unsigned int channels = pWav->channels;
+    int isADPCM = drwav__is_adpcm(pWav);
+    if (!isADPCM && !drwav__is_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    // Nothing to mix if the matrix is an identity (a regular stereo file being read as stereo, for example).
+    if (channels == outputChannels) {
+        int isIdentity = 1;
+        for (unsigned int c = 0; c < channels; ++c) {
+            for (unsigned int o = 0; o < outputChannels; ++o) {
+                if (weights[c*outputChannels + o] != ((c == o) ? 1.0f : 0.0f)) {
+                    isIdentity = 0;
+                }
+            }
+        }
+
+        if (isIdentity) {
+            return drwav_read_f32(pWav, framesToRead * outputChannels, pBufferOut) / outputChannels;
+        }
+    }
+
+    // The data is read, converted and mixed in small blocks so that the converted samples are still in the cache when they
+    // are mixed, and only the mixed result is written to the output buffer. ADPCM is decoded into <sampleData> as s16. Other
+    // formats are read into it as raw bytes, which the conversion loads with memcpy().
+    int16_t sampleData[2048];
+    float samples[1024];
+
+    unsigned int bytesPerSampleIn = isADPCM ? sizeof(int16_t) : pWav->bytesPerSample;
+    size_t framesPerBlock = sizeof(sampleData) / (bytesPerSampleIn * channels);
+    if (framesPerBlock > sizeof(samples)/sizeof(samples[0]) / channels) {
+        framesPerBlock = sizeof(samples)/sizeof(samples[0]) / channels;
+    }
+
+    if (framesPerBlock == 0) {
+        return 0;
+    }
+
+    size_t totalFramesRead = 0;
+    while (totalFramesRead < framesToRead)
+    {
+        size_t framesToReadThisIteration = framesToRead - totalFramesRead;
+        if (framesToReadThisIteration > framesPerBlock) {
+            framesToReadThisIteration = framesPerBlock;
+        }
+
+        size_t samplesRead;
+        if (isADPCM) {
+            samplesRead = drwav__read_s16_adpcm(pWav, framesToReadThisIteration * channels, sampleData);
+        } else {
+            samplesRead = drwav_read(pWav, framesToReadThisIteration * channels, sampleData, sizeof(sampleData));
+        }
+
+        size_t framesRead = samplesRead / channels;
+        if (framesRead == 0) {
+            break;
+        }
+
+        if (isADPCM) {
+            drwav_s16PCM_to_f32(framesRead * channels, sampleData, samples);
+        } else {
+            drwav__convert_to_f32(pWav, framesRead * channels, (const unsigned char*)sampleData, samples);
+        }
+
+        drwav__downmix_f32(framesRead, channels, outputChannels, weights, samples, pBufferOut);
+
+        pBufferOut      += framesRead * outputChannels;
+        totalFramesRead += framesRead;
+
+        if (framesRead < framesToReadThisIteration) {
+            break;
+        }
+    }
+
+    return totalFramesRead;
+}
+
+
+// Copies interleaved samples into one buffer per channel, starting at <outOffset> in each. This is always inlined so the
+// common channel counts get their own copy with a constant stride.
+static DRWAV_INLINE void drwav__deinterleave_f32__inline(size_t frameCount, unsigned int channels, const float* pIn, float** ppOut, size_t outOffset)
+{
+    for (unsigned int c = 0; c < channels; ++c) {
+        float* pOut = ppOut[c] + outOffset;
+        for (size_t i = 0; i < frameCount; ++i) {
+            pOut[i] = pIn[i*channels + c];
+        }
+    }
+}
+
+static DRWAV_INLINE void drwav__deinterleave_s16__inline(size_t frameCount, unsigned int channels, const int16_t* pIn, int16_t** ppOut, size_t outOffset)
+{
+    for (unsigned int c = 0; c < channels; ++c) {
+        int16_t* pOut = ppOut[c] + outOffset;
+        for (size_t i = 0; i < frameCount; ++i) {
+            pOut[i] = pIn[i*channels + c];
+        }
+    }
+}
+
+#ifdef DRWAV_SUPPORTS_SSE2
+// Transposes an 8x8 block of 16-bit values in place.
+static DRWAV_INLINE void drwav__transpose_8x8_s16_sse2(__m128i* r)
+{
+    __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i t1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i t2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i t3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i t4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i t5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i t6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i t7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+    __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+    __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+    __m128i u2 = _mm_unpacklo_epi32(t4, t6);
+    __m128i u3 = _mm_unpackhi_epi32(t4, t6);
+    __m128i u4 = _mm_unpacklo_epi32(t1, t3);
+    __m128i u5 = _mm_unpackhi_epi32(t1, t3);
+    __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+    __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+    r[0] = _mm_unpacklo_epi64(u0, u2);
+    r[1] = _mm_unpackhi_epi64(u0, u2);
+    r[2] = _mm_unpacklo_epi64(u1, u3);
+    r[3] = _mm_unpackhi_epi64(u1, u3);
+    r[4] = _mm_unpacklo_epi64(u4, u6);
+    r[5] = _mm_unpackhi_epi64(u4, u6);
+    r[6] = _mm_unpacklo_epi64(u5, u7);
+    r[7] = _mm_unpackhi_epi64(u5, u7);
+}
+
+// The SSE2 deinterleaving paths return the number of frames they handled. The caller does the rest.
+static size_t drwav__deinterleave_f32_sse2(size_t frameCount, unsigned int channels, const float* pIn, float** ppOut, size_t outOffset)
+{
+    float* pOut[8];
+    for (unsigned int c = 0; c < channels && c < 8; ++c) {
+        pOut[c] = ppOut[c] + outOffset;
+    }
+
+    size_t i = 0;
+    switch (channels)
+    {
+        case 2:
+        {
+            for (; i + 4 <= frameCount; i += 4) {
+                __m128 a = _mm_loadu_ps(pIn + i*2 + 0);
+                __m128 b = _mm_loadu_ps(pIn + i*2 + 4);
+                _mm_storeu_ps(pOut[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(pOut[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+        } break;
+
+        case 4:
+        {
+            for (; i + 4 <= frameCount; i += 4) {
+                __m128 r0 = _mm_loadu_ps(pIn + i*4 +  0);
+                __m128 r1 = _mm_loadu_ps(pIn + i*4 +  4);
+                __m128 r2 = _mm_loadu_ps(pIn + i*4 +  8);
+                __m128 r3 = _mm_loadu_ps(pIn + i*4 + 12);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(pOut[0] + i, r0);
+                _mm_storeu_ps(pOut[1] + i, r1);
+                _mm_storeu_ps(pOut[2] + i, r2);
+                _mm_storeu_ps(pOut[3] + i, r3);
+            }
+        } break;
+
+        case 6:
+        {
+            // Four frames take up six registers. The first four channels of each frame are gathered into rows for a regular
+            // 4x4 transpose, and the last two channels are split out separately.
+            for (; i + 4 <= frameCount; i += 4) {
+                __m128 v0 = _mm_loadu_ps(pIn + i*6 +  0);
+                __m128 v1 = _mm_loadu_ps(pIn + i*6 +  4);
+                __m128 v2 = _mm_loadu_ps(pIn + i*6 +  8);
+                __m128 v3 = _mm_loadu_ps(pIn + i*6 + 12);
+                __m128 v4 = _mm_loadu_ps(pIn + i*6 + 16);
+                __m128 v5 = _mm_loadu_ps(pIn + i*6 + 20);
+
+                __m128 r0 = v0;
+                __m128 r1 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 0, 3, 2));
+                __m128 r2 = v3;
+                __m128 r3 = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(1, 0, 3, 2));
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                __m128 a = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0));
+                __m128 b = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(3, 2, 1, 0));
+
+                _mm_storeu_ps(pOut[0] + i, r0);
+                _mm_storeu_ps(pOut[1] + i, r1);
+                _mm_storeu_ps(pOut[2] + i, r2);
+                _mm_storeu_ps(pOut[3] + i, r3);
+                _mm_storeu_ps(pOut[4] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(pOut[5] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+        } break;
+
+        case 8:
+        {
+            for (; i + 4 <= frameCount; i += 4) {
+                __m128 r0 = _mm_loadu_ps(pIn + i*8 +  0);
+                __m128 h0 = _mm_loadu_ps(pIn + i*8 +  4);
+                __m128 r1 = _mm_loadu_ps(pIn + i*8 +  8);
+                __m128 h1 = _mm_loadu_ps(pIn + i*8 + 12);
+                __m128 r2 = _mm_loadu_ps(pIn + i*8 + 16);
+                __m128 h2 = _mm_loadu_ps(pIn + i*8 + 20);
+                __m128 r3 = _mm_loadu_ps(pIn + i*8 + 24);
+                __m128 h3 = _mm_loadu_ps(pIn + i*8 + 28);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+                _mm_storeu_ps(pOut[0] + i, r0);
+                _mm_storeu_ps(pOut[1] + i, r1);
+                _mm_storeu_ps(pOut[2] + i, r2);
+                _mm_storeu_ps(pOut[3] + i, r3);
+                _mm_storeu_ps(pOut[4] + i, h0);
+                _mm_storeu_ps(pOut[5] + i, h1);
+                _mm_storeu_ps(pOut[6] + i, h2);
+                _mm_storeu_ps(pOut[7] + i, h3);
+            }
+        } break;
+
+        default: break;
+    }
+
+    return i;
+}
+
+static size_t drwav__deinterleave_s16_sse2(size_t frameCount, unsigned int channels, const int16_t* pIn, int16_t** ppOut, size_t outOffset)
+{
+    int16_t* pOut[8];
+    for (unsigned int c = 0; c < channels && c < 8; ++c) {
+        pOut[c] = ppOut[c] + outOffset;
+    }
+
+    size_t i = 0;
+    switch (channels)
+    {
+        case 2:
+        {
+            // The left sample is the low half of each 32-bit pair and the right sample is the high half. Both are sign
+            // extended to 32 bits and packed back down.
+            for (; i + 8 <= frameCount; i += 8) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(pIn + i*2 + 0));
+                __m128i b = _mm_loadu_si128((const __m128i*)(pIn + i*2 + 8));
+                __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+                __m128i r = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+                _mm_storeu_si128((__m128i*)(pOut[0] + i), l);
+                _mm_storeu_si128((__m128i*)(pOut[1] + i), r);
+            }
+        } break;
+
+        case 4:
+        {
+            for (; i + 8 <= frameCount; i += 8) {
+                __m128i v0 = _mm_loadu_si128((const __m128i*)(pIn + i*4 +  0));
+                __m128i v1 = _mm_loadu_si128((const __m128i*)(pIn + i*4 +  8));
+                __m128i v2 = _mm_loadu_si128((const __m128i*)(pIn + i*4 + 16));
+                __m128i v3 = _mm_loadu_si128((const __m128i*)(pIn + i*4 + 24));
+
+                __m128i t0 = _mm_unpacklo_epi16(v0, v1);
+                __m128i t1 = _mm_unpackhi_epi16(v0, v1);
+                __m128i t2 = _mm_unpacklo_epi16(v2, v3);
+                __m128i t3 = _mm_unpackhi_epi16(v2, v3);
+
+                __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+                __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+                __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+                __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+
+                _mm_storeu_si128((__m128i*)(pOut[0] + i), _mm_unpacklo_epi64(u0, u2));
+                _mm_storeu_si128((__m128i*)(pOut[1] + i), _mm_unpackhi_epi64(u0, u2));
+                _mm_storeu_si128((__m128i*)(pOut[2] + i), _mm_unpacklo_epi64(u1, u3));
+                _mm_storeu_si128((__m128i*)(pOut[3] + i), _mm_unpackhi_epi64(u1, u3));
+            }
+        } break;
+
+        case 6:
+        {
+            // Each frame is loaded into its own register, with two samples of the next frame along for the ride, and the
+            // result is transposed as if it had 8 channels. The extra samples mean one more frame must be available.
+            for (; i + 9 <= frameCount; i += 8) {
+                __m128i r[8];
+                for (int f = 0; f < 8; ++f) {
+                    r[f] = _mm_loadu_si128((const __m128i*)(pIn + (i + f)*6));
+                }
+
+                drwav__transpose_8x8_s16_sse2(r);
+                for (int c = 0; c < 6; ++c) {
+                    _mm_storeu_si128((__m128i*)(pOut[c] + i), r[c]);
+                }
+            }
+        } break;
+
+        case 8:
+        {
+            for (; i + 8 <= frameCount; i += 8) {
+                __m128i r[8];
+                for (int f = 0; f < 8; ++f) {
+                    r[f] = _mm_loadu_si128((const __m128i*)(pIn + (i + f)*8));
+                }
+
+                drwav__transpose_8x8_s16_sse2(r);
+                for (int c = 0; c < 8; ++c) {
+                    _mm_storeu_si128((__m128i*)(pOut[c] + i), r[c]);
+                }
+            }
+        } break;
+
+        default: break;
     }
+
+    return i;
+}
 #endif
 
-    // If we opened the file with drwav_open_memory() we will want to free() the user data.
-    if (pWav->onRead == drwav__on_read_memory && pWav->onSeek == drwav__on_seek_memory) {
-        free(pWav->pUserData);
+static void drwav__deinterleave_f32(size_t frameCount, unsigned int channels, const float* pIn, float** ppOut, size_t outOffset)
+{
+    if (channels == 1) {
+        memcpy(ppOut[0] + outOffset, pIn, frameCount * sizeof(float));
+        return;
+    }
+
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t framesDone = drwav__deinterleave_f32_sse2(frameCount, channels, pIn, ppOut, outOffset);
+    pIn        += framesDone * channels;
+    outOffset  += framesDone;
+    frameCount -= framesDone;
+#endif
+
+    switch (channels)
+    {
+        case 2:  drwav__deinterleave_f32__inline(frameCount, 2, pIn, ppOut, outOffset);        break;
+        case 4:  drwav__deinterleave_f32__inline(frameCount, 4, pIn, ppOut, outOffset);        break;
+        case 6:  drwav__deinterleave_f32__inline(frameCount, 6, pIn, ppOut, outOffset);        break;
+        case 8:  drwav__deinterleave_f32__inline(frameCount, 8, pIn, ppOut, outOffset);        break;
+        default: drwav__deinterleave_f32__inline(frameCount, channels, pIn, ppOut, outOffset); break;
+    }
+}
+
+static void drwav__deinterleave_s16(size_t frameCount, unsigned int channels, const int16_t* pIn, int16_t** ppOut, size_t outOffset)
+{
+    if (channels == 1) {
+        memcpy(ppOut[0] + outOffset, pIn, frameCount * sizeof(int16_t));
+        return;
+    }
+
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t framesDone = drwav__deinterleave_s16_sse2(frameCount, channels, pIn, ppOut, outOffset);
+    pIn        += framesDone * channels;
+    outOffset  += framesDone;
+    frameCount -= framesDone;
+#endif
+
+    switch (channels)
+    {
+        case 2:  drwav__deinterleave_s16__inline(frameCount, 2, pIn, ppOut, outOffset);        break;
+        case 4:  drwav__deinterleave_s16__inline(frameCount, 4, pIn, ppOut, outOffset);        break;
+        case 6:  drwav__deinterleave_s16__inline(frameCount, 6, pIn, ppOut, outOffset);        break;
+        case 8:  drwav__deinterleave_s16__inline(frameCount, 8, pIn, ppOut, outOffset);        break;
+        default: drwav__deinterleave_s16__inline(frameCount, channels, pIn, ppOut, outOffset); break;
+    }
+}
+
+// Reads whole frames of raw data, or decoded s16 samples for ADPCM, into <pSampleData>. Returns the number of frames read.
+static size_t drwav__read_frames_for_planar(drwav* pWav, size_t framesToRead, void* pSampleData, size_t sampleDataSize)
+{
+    size_t samplesRead;
+    if (drwav__is_adpcm(pWav)) {
+        samplesRead = drwav__read_s16_adpcm(pWav, framesToRead * pWav->channels, (int16_t*)pSampleData);
+    } else {
+        samplesRead = drwav_read(pWav, framesToRead * pWav->channels, pSampleData, sampleDataSize);
+    }
+
+    return samplesRead / pWav->channels;
+}
+
+size_t drwav_read_f32_planar(drwav* pWav, size_t framesToRead, float** ppBufferOut)
+{
+    if (pWav == NULL || framesToRead == 0 || ppBufferOut == NULL || pWav->channels == 0) {
+        return 0;
+    }
+
+    unsigned int channels = pWav->channels;
+    for (unsigned int c = 0; c < channels; ++c) {
+        if (ppBufferOut[c] == NULL) {
+            return 0;
+        }
+    }
+
+    int isADPCM = drwav__is_adpcm(pWav);
+    if (!isADPCM && !drwav__is_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    // Like drwav_read_f32_downmixed(), this works in small blocks so the converted samples are still in the cache when they
+    // are split up. 32-bit float data doesn't need converting, so it's read straight into <samples> and split from there.
+    int16_t sampleData[2048];
+    float samples[1024];
+
+    int isPassthrough = pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT && pWav->bytesPerSample == 4;
+    unsigned int bytesPerSampleIn = isADPCM ? sizeof(int16_t) : pWav->bytesPerSample;
+    size_t framesPerBlock = sizeof(sampleData) / (bytesPerSampleIn * channels);
+    if (framesPerBlock > sizeof(samples)/sizeof(samples[0]) / channels) {
+        framesPerBlock = sizeof(samples)/sizeof(samples[0]) / channels;
+    }
+
+    if (framesPerBlock == 0) {
+        return 0;
+    }
+
+    size_t totalFramesRead = 0;
+    while (totalFramesRead < framesToRead)
+    {
+        size_t framesToReadThisIteration = framesToRead - totalFramesRead;
+        if (framesToReadThisIteration > framesPerBlock) {
+            framesToReadThisIteration = framesPerBlock;
+        }
+
+        size_t framesRead;
+        if (isPassthrough) {
+            framesRead = drwav__read_frames_for_planar(pWav, framesToReadThisIteration, samples, sizeof(samples));
+        } else {
+            framesRead = drwav__read_frames_for_planar(pWav, framesToReadThisIteration, sampleData, sizeof(sampleData));
+        }
+
+        if (framesRead == 0) {
+            break;
+        }
+
+        if (isADPCM) {
+            drwav_s16PCM_to_f32(framesRead * channels, sampleData, samples);
+        } else if (!isPassthrough) {
+            drwav__convert_to_f32(pWav, framesRead * channels, (const unsigned char*)sampleData, samples);
+        }
+
+        drwav__deinterleave_f32(framesRead, channels, samples, ppBufferOut, totalFramesRead);
+        totalFramesRead += framesRead;
+
+        if (framesRead < framesToReadThisIteration) {
+            break;
+        }
+    }
+
+    return totalFramesRead;
+}
+
+size_t drwav_read_s16_planar(drwav* pWav, size_t framesToRead, int16_t** ppBufferOut)
+{
+    if (pWav == NULL || framesToRead == 0 || ppBufferOut == NULL || pWav->channels == 0) {
+        return 0;
     }
 
-    free(pWav);
+    unsigned int channels = pWav->channels;
+    for (unsigned int c = 0; c < channels; ++c) {
+        if (ppBufferOut[c] == NULL) {
+            return 0;
+        }
+    }
+
+    int isADPCM = drwav__is_adpcm(pWav);
+    if (!isADPCM && !drwav__is_conversion_supported(pWav)) {
+        return 0;
+    }
+
+    // ADPCM is decoded straight to s16 and 16-bit PCM is already s16, so both are read straight into <samples> and split
+    // from there.
+    unsigned char sampleData[4096];
+    int16_t samples[2048];
+
+    int isPassthrough = isADPCM || (pWav->translatedFormatTag == DR_WAVE_FORMAT_PCM && pWav->bytesPerSample == 2);
+    unsigned int bytesPerSampleIn = isADPCM ? sizeof(int16_t) : pWav->bytesPerSample;
+    size_t framesPerBlock = sizeof(sampleData) / (bytesPerSampleIn * channels);
+    if (framesPerBlock > sizeof(samples)/sizeof(samples[0]) / channels) {
+        framesPerBlock = sizeof(samples)/sizeof(samples[0]) / channels;
+    }
+
+    if (framesPerBlock == 0) {
+        return 0;
+    }
+
+    size_t totalFramesRead = 0;
+    while (totalFramesRead < framesToRead)
+    {
+        size_t framesToReadThisIteration = framesToRead - totalFramesRead;
+        if (framesToReadThisIteration > framesPerBlock) {
+            framesToReadThisIteration = framesPerBlock;
+        }
+
+        size_t framesRead;
+        if (isPassthrough) {
+            framesRead = drwav__read_frames_for_planar(pWav, framesToReadThisIteration, samples, sizeof(samples));
+        } else {
+            framesRead = drwav__read_frames_for_planar(pWav, framesToReadThisIteration, sampleData, sizeof(sampleData));
+        }
+
+        if (framesRead == 0) {
+            break;
+        }
+
+        if (!isPassthrough) {
+            drwav__convert_to_s16(pWav, framesRead * channels, sampleData, samples);
+        }
+
+        drwav__deinterleave_s16(framesRead, channels, samples, ppBufferOut, totalFramesRead);
+        totalFramesRead += framesRead;
+
+        if (framesRead < framesToReadThisIteration) {
+            break;
+        }
+    }
+
+    return totalFramesRead;
+}
+
+void drwav_u8PCM_to_f32(size_t totalSampleCount, const unsigned char* u8PCM, float* f32Out)
+{
+    if (u8PCM == NULL || f32Out == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *f32Out++ = (u8PCM[i] / 255.0f) * 2 - 1;
+    }
+}
+
+void drwav_s16PCM_to_f32(size_t totalSampleCount, const short* s16PCM, float* f32Out)
+{
+    if (s16PCM == NULL || f32Out == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *f32Out++ = s16PCM[i] / 32768.0f;
+    }
+}
+
+void drwav_s24PCM_to_f32(size_t totalSampleCount, const unsigned char* s24PCM, float* f32Out)
+{
+    if (s24PCM == NULL || f32Out == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        unsigned int s0 = s24PCM[i*3 + 0];
+        unsigned int s1 = s24PCM[i*3 + 1];
+        unsigned int s2 = s24PCM[i*3 + 2];
+
+        int sample32 = (int)((s0 << 8) | (s1 << 16) | (s2 << 24));
+        *f32Out++ = (float)(sample32 / 2147483648.0);
+    }
 }
 
-
-size_t drwav_read_raw(drwav* pWav, void* pBufferOut, size_t bytesToRead)
+void drwav_s32PCM_to_f32(size_t totalSampleCount, const int* s32PCM, float* f32Out)
 {
-    if (pWav == NULL || bytesToRead == 0 || pBufferOut == NULL) {
-        return 0;
+    if (s32PCM == NULL || f32Out == NULL) {
+        return;
     }
 
-    if (bytesToRead > pWav->bytesRemaining) {
-        bytesToRead = (size_t)pWav->bytesRemaining;
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *f32Out++ = (float)(s32PCM[i] / 2147483648.0);
     }
-
-    size_t bytesRead = pWav->onRead(pWav->pUserData, pBufferOut, bytesToRead);
-
-    pWav->bytesRemaining -= bytesRead;
-    return bytesRead;
 }
 
-size_t drwav_read(drwav* pWav, size_t samplesToRead, void* pBufferOut, size_t bufferOutSize)
+void drwav_f64_to_f32(size_t totalSampleCount, const double* f64In, float* f32Out)
 {
-    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
-        return 0;
+    if (f64In == NULL || f32Out == NULL) {
+        return;
     }
 
-    size_t maxSamples = bufferOutSize / pWav->bytesPerSample;
-    if (samplesToRead > maxSamples) {
-        samplesToRead = maxSamples;
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *f32Out++ = (float)f64In[i];
     }
-
-    size_t bytesRead = drwav_read_raw(pWav, pBufferOut, samplesToRead * pWav->bytesPerSample);
-
-    return bytesRead / pWav->bytesPerSample;
 }
 
-int drwav_seek(drwav* pWav, uint64_t sample)
+void drwav_alaw_to_f32(size_t totalSampleCount, const unsigned char* alaw, float* f32Out)
 {
-    // Seeking should be compatible with wave files > 2GB.
-
-    if (pWav == NULL || pWav->onSeek == NULL) {
-        return 0;
+    if (alaw == NULL || f32Out == NULL) {
+        return;
     }
 
-    // If there are no samples, just return true without doing anything.
-    if (pWav->totalSampleCount == 0) {
-        return 1;
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_f32_avx2(totalSampleCount, alaw, drwav__alaw_table_f32, f32Out);
+    alaw += samplesDone;
+    f32Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
+
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        f32Out[i] = drwav__alaw_table_f32[alaw[i]];
     }
+}
 
-    // Make sure the sample is clamped.
-    if (sample >= pWav->totalSampleCount) {
-        sample = pWav->totalSampleCount - 1;
+void drwav_ulaw_to_f32(size_t totalSampleCount, const unsigned char* ulaw, float* f32Out)
+{
+    if (ulaw == NULL || f32Out == NULL) {
+        return;
     }
 
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_f32_avx2(totalSampleCount, ulaw, drwav__ulaw_table_f32, f32Out);
+    ulaw += samplesDone;
+    f32Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-    uint64_t totalSizeInBytes = pWav->totalSampleCount * pWav->bytesPerSample;
-    assert(totalSizeInBytes >= pWav->bytesRemaining);
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        f32Out[i] = drwav__ulaw_table_f32[ulaw[i]];
+    }
+}
 
-    uint64_t currentBytePos = totalSizeInBytes - pWav->bytesRemaining;
-    uint64_t targetBytePos  = sample * pWav->bytesPerSample;
 
-    uint64_t offset;
-    int direction;
-    if (currentBytePos < targetBytePos) {
-        // Offset forward.
-        offset = targetBytePos - currentBytePos;
-        direction = 1;
-    } else {
-        // Offset backwards.
-        offset = currentBytePos - targetBytePos;
-        direction = -1;
+void drwav_u8PCM_to_s16(size_t totalSampleCount, const unsigned char* u8PCM, short* s16Out)
+{
+    if (u8PCM == NULL || s16Out == NULL) {
+        return;
     }
 
-    while (offset > 0)
+    for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        int offset32 = ((offset > INT_MAX) ? INT_MAX : (int)offset);
-        pWav->onSeek(pWav->pUserData, offset32 * direction);
-
-        pWav->bytesRemaining -= (offset32 * direction);
-        offset -= offset32;
+        *s16Out++ = (short)((u8PCM[i] << 8) - 32768);
     }
-
-    return 1;
 }
 
-
-#ifndef DR_WAV_NO_CONVERSION_API
-static int drwav__pcm_to_f32(size_t totalSampleCount, const unsigned char* pPCM, unsigned short bytesPerSample, float* f32Out)
+void drwav_s24PCM_to_s16(size_t totalSampleCount, const unsigned char* s24PCM, short* s16Out)
 {
-    if (pPCM == NULL || f32Out == NULL) {
-        return 0;
+    if (s24PCM == NULL || s16Out == NULL) {
+        return;
     }
 
-    // Special case for 8-bit sample data because it's treated as unsigned.
-    if (bytesPerSample == 1) {
-        drwav_u8PCM_to_f32(totalSampleCount, pPCM, f32Out);
-        return 1;
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        unsigned int s1 = s24PCM[i*3 + 1];
+        unsigned int s2 = s24PCM[i*3 + 2];
+        *s16Out++ = (short)(s1 | (s2 << 8));
     }
+}
 
-
-    // Slightly more optimal implementation for common formats.
-    if (bytesPerSample == 2) {
-        drwav_s16PCM_to_f32(totalSampleCount, (const short*)pPCM, f32Out);
-        return 1;
+void drwav_s32PCM_to_s16(size_t totalSampleCount, const int* s32PCM, short* s16Out)
+{
+    if (s32PCM == NULL || s16Out == NULL) {
+        return;
     }
-    if (bytesPerSample == 3) {
-        drwav_s24PCM_to_f32(totalSampleCount, pPCM, f32Out);
-        return 1;
+
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *s16Out++ = (short)(s32PCM[i] >> 16);
     }
-    if (bytesPerSample == 4) {
-        drwav_s32PCM_to_f32(totalSampleCount, (const int*)pPCM, f32Out);
-        return 1;
+}
+
+void drwav_f32_to_s16(size_t totalSampleCount, const float* f32In, short* s16Out)
+{
+    if (f32In == NULL || s16Out == NULL) {
+        return;
     }
 
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t samplesDone = drwav__f32_to_s16_sse2(totalSampleCount, (const unsigned char*)f32In, s16Out, NULL);
+    f32In += samplesDone;
+    s16Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-    // Generic, slow converter.
-    for (unsigned int i = 0; i < totalSampleCount; ++i)
+    for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        unsigned int sample = 0;
-        unsigned int shift  = (8 - bytesPerSample) * 8;
-        for (unsigned short j = 0; j < bytesPerSample && j < 4; ++j) {
-            sample |= (unsigned int)(pPCM[j]) << shift;
-            shift  += 8;
-        }
-
-        pPCM += bytesPerSample;
-        *f32Out++ = (float)((int)sample / 2147483648.0);
+        *s16Out++ = drwav__clamp_and_round_s16(f32In[i]);
     }
-
-    return 1;
 }
 
-static int drwav__ieee_to_f32(size_t totalSampleCount, const unsigned char* pDataIn, unsigned short bytesPerSample, float* f32Out)
+void drwav_f64_to_s16(size_t totalSampleCount, const double* f64In, short* s16Out)
 {
-    if (pDataIn == NULL || f32Out == NULL) {
-        return 0;
+    if (f64In == NULL || s16Out == NULL) {
+        return;
     }
 
-    if (bytesPerSample == 32) {
-        for (unsigned int i = 0; i < totalSampleCount; ++i) {
-            *f32Out++ = ((float*)pDataIn)[i];
-        }
-        return 1;
-    } else {
-        drwav_f64_to_f32(totalSampleCount, (double*)pDataIn, f32Out);
-        return 1;
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *s16Out++ = drwav__clamp_and_round_s16((float)f64In[i]);
     }
-
-    return 0;
 }
 
-
-size_t drwav_read_f32(drwav* pWav, size_t samplesToRead, float* pBufferOut)
+void drwav_alaw_to_s16(size_t totalSampleCount, const unsigned char* alaw, short* s16Out)
 {
-    if (pWav == NULL || samplesToRead == 0 || pBufferOut == NULL) {
-        return 0;
+    if (alaw == NULL || s16Out == NULL) {
+        return;
     }
 
-    // Fast path.
-    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT && pWav->bytesPerSample == 4) {
-        return drwav_read(pWav, samplesToRead, pBufferOut, samplesToRead * sizeof(float));
-    }
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_s16_avx2(totalSampleCount, alaw, drwav__alaw_table_s16, s16Out);
+    alaw += samplesDone;
+    s16Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        s16Out[i] = drwav__alaw_table_s16[alaw[i]];
+    }
+}
 
-    // Slow path. Need to read and convert.
-    size_t totalSamplesRead = 0;
+void drwav_ulaw_to_s16(size_t totalSampleCount, const unsigned char* ulaw, short* s16Out)
+{
+    if (ulaw == NULL || s16Out == NULL) {
+        return;
+    }
 
-    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_PCM)
-    {
-        unsigned char sampleData[4096];
-        while (samplesToRead > 0)
-        {
-            size_t samplesRead = drwav_read(pWav, samplesToRead, sampleData, sizeof(sampleData));
-            if (samplesRead == 0) {
-                break;
-            }
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_s16_avx2(totalSampleCount, ulaw, drwav__ulaw_table_s16, s16Out);
+    ulaw += samplesDone;
+    s16Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-            drwav__pcm_to_f32(samplesRead, sampleData, pWav->bytesPerSample, pBufferOut);
-            pBufferOut += samplesRead;
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        s16Out[i] = drwav__ulaw_table_s16[ulaw[i]];
+    }
+}
 
-            samplesToRead    -= samplesRead;
-            totalSamplesRead += samplesRead;
-        }
 
-        return totalSamplesRead;
+void drwav_u8PCM_to_s32(size_t totalSampleCount, const unsigned char* u8PCM, int* s32Out)
+{
+    if (u8PCM == NULL || s32Out == NULL) {
+        return;
     }
 
-    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT)
+    for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        unsigned char sampleData[4096];
-        while (samplesToRead > 0)
-        {
-            size_t samplesRead = drwav_read(pWav, samplesToRead, sampleData, sizeof(sampleData));
-            if (samplesRead == 0) {
-                break;
-            }
-
-            drwav__ieee_to_f32(samplesRead, sampleData, pWav->bytesPerSample, pBufferOut);
-            pBufferOut += samplesRead;
-
-            samplesToRead    -= samplesRead;
-            totalSamplesRead += samplesRead;
-        }
+        *s32Out++ = (int)((unsigned int)(u8PCM[i] - 128) << 24);
+    }
+}
 
-        return totalSamplesRead;
+void drwav_s16PCM_to_s32(size_t totalSampleCount, const short* s16PCM, int* s32Out)
+{
+    if (s16PCM == NULL || s32Out == NULL) {
+        return;
     }
 
-    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_ALAW)
+    for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        unsigned char sampleData[4096];
-        while (samplesToRead > 0)
-        {
-            size_t samplesRead = drwav_read(pWav, samplesToRead, sampleData, sizeof(sampleData));
-            if (samplesRead == 0) {
-                break;
-            }
-
-            drwav_alaw_to_f32(samplesRead, sampleData, pBufferOut);
-            pBufferOut += samplesRead;
-
-            samplesToRead    -= samplesRead;
-            totalSamplesRead += samplesRead;
-        }
+        *s32Out++ = (int)((unsigned int)s16PCM[i] << 16);
+    }
+}
 
-        return totalSamplesRead;
+void drwav_s24PCM_to_s32(size_t totalSampleCount, const unsigned char* s24PCM, int* s32Out)
+{
+    if (s24PCM == NULL || s32Out == NULL) {
+        return;
     }
 
-    if (pWav->translatedFormatTag == DR_WAVE_FORMAT_MULAW)
+    for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        unsigned char sampleData[4096];
-        while (samplesToRead > 0)
-        {
-            size_t samplesRead = drwav_read(pWav, samplesToRead, sampleData, sizeof(sampleData));
-            if (samplesRead == 0) {
-                break;
-            }
+        unsigned int s0 = s24PCM[i*3 + 0];
+        unsigned int s1 = s24PCM[i*3 + 1];
+        unsigned int s2 = s24PCM[i*3 + 2];
+        *s32Out++ = (int)((s0 << 8) | (s1 << 16) | (s2 << 24));
+    }
+}
 
-            drwav_ulaw_to_f32(samplesRead, sampleData, pBufferOut);
-            pBufferOut += samplesRead;
+void drwav_f32_to_s32(size_t totalSampleCount, const float* f32In, int* s32Out)
+{
+    if (f32In == NULL || s32Out == NULL) {
+        return;
+    }
 
-            samplesToRead    -= samplesRead;
-            totalSamplesRead += samplesRead;
-        }
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t samplesDone = drwav__f32_to_s32_sse2(totalSampleCount, (const unsigned char*)f32In, s32Out);
+    f32In += samplesDone;
+    s32Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-        return totalSamplesRead;
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        *s32Out++ = drwav__clamp_and_round_s32(f32In[i]);
     }
-
-    return totalSamplesRead;
 }
 
-void drwav_u8PCM_to_f32(size_t totalSampleCount, const unsigned char* u8PCM, float* f32Out)
+void drwav_f64_to_s32(size_t totalSampleCount, const double* f64In, int* s32Out)
 {
-    if (u8PCM == NULL || f32Out == NULL) {
+    if (f64In == NULL || s32Out == NULL) {
         return;
     }
 
     for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        *f32Out++ = (u8PCM[i] / 255.0f) * 2 - 1;
+        *s32Out++ = drwav__clamp_and_round_s32(f64In[i]);
     }
 }
 
-void drwav_s16PCM_to_f32(size_t totalSampleCount, const short* s16PCM, float* f32Out)
+void drwav_alaw_to_s32(size_t totalSampleCount, const unsigned char* alaw, int* s32Out)
 {
-    if (s16PCM == NULL || f32Out == NULL) {
+    if (alaw == NULL || s32Out == NULL) {
         return;
     }
 
-    for (size_t i = 0; i < totalSampleCount; ++i)
-    {
-        *f32Out++ = s16PCM[i] / 32768.0f;
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_s32_avx2(totalSampleCount, alaw, drwav__alaw_table_s16, s32Out);
+    alaw += samplesDone;
+    s32Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
+
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        s32Out[i] = (int)((unsigned int)drwav__alaw_table_s16[alaw[i]] << 16);
     }
 }
 
-void drwav_s24PCM_to_f32(size_t totalSampleCount, const unsigned char* s24PCM, float* f32Out)
+void drwav_ulaw_to_s32(size_t totalSampleCount, const unsigned char* ulaw, int* s32Out)
 {
-    if (s24PCM == NULL || f32Out == NULL) {
+    if (ulaw == NULL || s32Out == NULL) {
         return;
     }
 
-    for (size_t i = 0; i < totalSampleCount; ++i)
-    {
-        unsigned int s0 = s24PCM[i*3 + 0];
-        unsigned int s1 = s24PCM[i*3 + 1];
-        unsigned int s2 = s24PCM[i*3 + 2];
+#ifdef DRWAV_SUPPORTS_AVX2
+    size_t samplesDone = drwav__table_lookup_s32_avx2(totalSampleCount, ulaw, drwav__ulaw_table_s16, s32Out);
+    ulaw += samplesDone;
+    s32Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-        int sample32 = (int)((s0 << 8) | (s1 << 16) | (s2 << 24));
-        *f32Out++ = (float)(sample32 / 2147483648.0);
+    for (size_t i = 0; i < totalSampleCount; ++i) {
+        s32Out[i] = (int)((unsigned int)drwav__ulaw_table_s16[ulaw[i]] << 16);
     }
 }
 
-void drwav_s32PCM_to_f32(size_t totalSampleCount, const int* s32PCM, float* f32Out)
+
+void drwav_s16PCM_to_s24(size_t totalSampleCount, const short* s16PCM, unsigned char* s24Out)
 {
-    if (s32PCM == NULL || f32Out == NULL) {
+    if (s16PCM == NULL || s24Out == NULL) {
         return;
     }
 
     for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        *f32Out++ = (float)(s32PCM[i] / 2147483648.0);
+        unsigned int s = (unsigned int)s16PCM[i];
+        *s24Out++ = 0;
+        *s24Out++ = (unsigned char)((s >> 0) & 0xFF);
+        *s24Out++ = (unsigned char)((s >> 8) & 0xFF);
     }
 }
 
-void drwav_f64_to_f32(size_t totalSampleCount, const double* f64In, float* f32Out)
+void drwav_s32PCM_to_s24(size_t totalSampleCount, const int* s32PCM, unsigned char* s24Out)
 {
-    if (f64In == NULL || f32Out == NULL) {
+    if (s32PCM == NULL || s24Out == NULL) {
         return;
     }
 
     for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        *f32Out++ = (float)f64In[i];
+        unsigned int s = (unsigned int)s32PCM[i];
+        *s24Out++ = (unsigned char)((s >>  8) & 0xFF);
+        *s24Out++ = (unsigned char)((s >> 16) & 0xFF);
+        *s24Out++ = (unsigned char)((s >> 24) & 0xFF);
     }
 }
 
-void drwav_alaw_to_f32(size_t totalSampleCount, const unsigned char* alaw, float* f32Out)
+void drwav_f32_to_s24(size_t totalSampleCount, const float* f32In, unsigned char* s24Out)
 {
-    if (alaw == NULL || f32Out == NULL) {
+    if (f32In == NULL || s24Out == NULL) {
         return;
     }
 
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t samplesDone = drwav__f32_to_s24_sse2(totalSampleCount, f32In, s24Out, NULL);
+    f32In += samplesDone;
+    s24Out += samplesDone*3;
+    totalSampleCount -= samplesDone;
+#endif
+
     for (size_t i = 0; i < totalSampleCount; ++i)
     {
-        const unsigned char a = alaw[i] ^ 0x55;
+        unsigned int s = (unsigned int)drwav__clamp_and_round_s24(f32In[i]);
+        *s24Out++ = (unsigned char)((s >>  0) & 0xFF);
+        *s24Out++ = (unsigned char)((s >>  8) & 0xFF);
+        *s24Out++ = (unsigned char)((s >> 16) & 0xFF);
+    }
+}
 
-        int t = (a & 0x0F) << 4;
 
-        int s = ((unsigned int)a & 0x70) >> 4;
-        switch (s)
-        {
-            case 0:
-            {
-                t += 8;
-            } break;
+void drwav_dither_init(drwav_dither* pDither, uint32_t seed)
+{
+    if (pDither == NULL) {
+        return;
+    }
 
-            default:
-            {
-                t += 0x108;
-                t <<= (s - 1);
-            } break;
-        }
+    // Each lane gets a differently hashed seed so the lanes aren't correlated. xorshift never leaves zero so that's avoided.
+    for (uint32_t i = 0; i < 4; ++i) {
+        uint32_t x = seed + 0x9E3779B9u*(i + 1);
+        x ^= x >> 16;
+        x *= 0x85EBCA6Bu;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35u;
+        x ^= x >> 16;
+        pDither->state[i] = (x != 0) ? x : 0x6D2B79F5u;
+    }
+}
 
-        if ((a & 0x80) == 0) {
-            t = -t;
-        }
+void drwav_f32_to_s16_dithered(size_t totalSampleCount, const float* f32In, short* s16Out, drwav_dither* pDither)
+{
+    if (f32In == NULL || s16Out == NULL || pDither == NULL) {
+        return;
+    }
+
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t samplesDone = drwav__f32_to_s16_sse2(totalSampleCount, (const unsigned char*)f32In, s16Out, pDither);
+    f32In += samplesDone;
+    s16Out += samplesDone;
+    totalSampleCount -= samplesDone;
+#endif
 
-        *f32Out++ = t / 32768.0f;
+    // The noise is scaled by a power of two so it's added at exactly the same precision as the SSE2 path.
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        uint32_t* pState = &pDither->state[i & 3];
+        *pState = drwav__xorshift32(*pState);
+        *s16Out++ = drwav__clamp_and_round_s16(f32In[i] + drwav__dither_noise(*pState) * (1.0f / 32768.0f));
     }
+
+    drwav__dither_rotate(pDither, totalSampleCount);
 }
 
-void drwav_ulaw_to_f32(size_t totalSampleCount, const unsigned char* ulaw, float* f32Out)
+void drwav_f32_to_s24_dithered(size_t totalSampleCount, const float* f32In, unsigned char* s24Out, drwav_dither* pDither)
 {
-    if (ulaw == NULL || f32Out == NULL) {
+    if (f32In == NULL || s24Out == NULL || pDither == NULL) {
         return;
     }
 
-    for (unsigned int i = 0; i < totalSampleCount; ++i)
-    {
-        const unsigned char u = ~ulaw[i];
+#ifdef DRWAV_SUPPORTS_SSE2
+    size_t samplesDone = drwav__f32_to_s24_sse2(totalSampleCount, f32In, s24Out, pDither);
+    f32In += samplesDone;
+    s24Out += samplesDone*3;
+    totalSampleCount -= samplesDone;
+#endif
 
-        int t = (((u & 0x0F) << 3) + 0x84) << (((unsigned int)u & 0x70) >> 4);
-        if (u & 0x80) {
-            t = 0x84 - t;
-        } else {
-            t = t - 0x84;
-        }
+    for (size_t i = 0; i < totalSampleCount; ++i)
+    {
+        uint32_t* pState = &pDither->state[i & 3];
+        *pState = drwav__xorshift32(*pState);
 
-        *f32Out++ = t / 32768.0f;
+        unsigned int s = (unsigned int)drwav__clamp_and_round_s24(f32In[i] + drwav__dither_noise(*pState) * (1.0f / 8388608.0f));
+        *s24Out++ = (unsigned char)((s >>  0) & 0xFF);
+        *s24Out++ = (unsigned char)((s >>  8) & 0xFF);
+        *s24Out++ = (unsigned char)((s >> 16) & 0xFF);
     }
+
+    drwav__dither_rotate(pDither, totalSampleCount);
 }
 #endif  //DR_WAV_NO_CONVERSION_API
 
@@ -0,0 +1,593 @@
+// Ogg demuxer test for dr_opus.
+//
+// This builds an Ogg Opus stream in memory and checks that the packets come back out of dr_opus exactly as they went in. The
+// packet contents aren't real Opus audio since only the container is being tested. The stream has:
+//
+//   - A page from another logical stream in front of the Opus headers, and more of them between the audio pages.
+//   - An OpusTags packet that spans several pages.
+//   - Large packets that span two or three pages, small packets that share a page, and packets that are an exact multiple of
+//     255 bytes so they end with a zero-length segment, sometimes on a page of their own.
+//   - One packet larger than DR_OPUS_MAX_PACKET_SIZE, which is skipped.
+//
+// The stream is read from start to finish with and without a seek callback, then with a corrupt page, and then seeked to
+// random granule positions. The CRC used to build the pages is calculated bit by bit so it's independent of dr_opus' tables.
+//
+// Build and run with something like this:
+//
+//   cc -std=c99 -O2 dr_opus_test1.c -o dr_opus_test1 && ./dr_opus_test1
+//
+// Pass --quick to use a shorter stream and fewer seeks. The exit code is non-zero if any check fails.
+
+#define DR_OPUS_IMPLEMENTATION
+#include "../dr_opus.h"
+
+#include <stdio.h>
+
+#define TEST_FRAME_SIZE     960         // The number of samples per channel in each packet.
+#define TEST_PRE_SKIP       312
+#define TEST_SERIAL         0x12345678
+#define TEST_OTHER_SERIAL   0x0BADF00D
+
+static int g_failCount = 0;
+
+#define TEST_CHECK(condition, ...)      \
+    do {                                \
+        if (!(condition)) {             \
+            printf("FAILED: ");         \
+            printf(__VA_ARGS__);        \
+            printf("\n");               \
+            g_failCount += 1;           \
+        }                               \
+    } while (0)
+
+
+static unsigned int test_random(unsigned int* pState)
+{
+    *pState = *pState * 1664525 + 1013904223;
+    return *pState >> 8;
+}
+
+static void test_put_u32(uint8_t* p, uint32_t x)
+{
+    p[0] = (uint8_t)(x >>  0);
+    p[1] = (uint8_t)(x >>  8);
+    p[2] = (uint8_t)(x >> 16);
+    p[3] = (uint8_t)(x >> 24);
+}
+
+static uint32_t test_get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t test_crc32(const uint8_t* pData, size_t dataSize)
+{
+    uint32_t crc = 0;
+    for (size_t i = 0; i < dataSize; ++i) {
+        crc ^= (uint32_t)pData[i] << 24;
+        for (int iBit = 0; iBit < 8; ++iBit) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+
+//// Stream building ////
+
+// The contents of every audio packet can be worked out from its index, so packets can be identified and checked when they're
+// read back. The first 4 bytes are the index.
+static void test_fill_packet(uint8_t* pData, size_t dataSize, uint32_t iPacket)
+{
+    unsigned int state = iPacket * 2654435761u + 1;
+    for (size_t i = 0; i < dataSize; ++i) {
+        pData[i] = (uint8_t)test_random(&state);
+    }
+
+    if (dataSize >= 4) {
+        test_put_u32(pData, iPacket);
+    }
+}
+
+static size_t test_packet_size(uint32_t iPacket, size_t maxPacketSize, unsigned int* pRandom)
+{
+    unsigned int r = test_random(pRandom);
+    switch (iPacket % 16)
+    {
+        case 3:  return 4 + r % 400;                    // Small packets that share pages.
+        case 4:  return 4 + r % 400;
+        case 7:  return 255 * (1 + r % 600);            // Ends with a zero-length segment.
+        case 11: return 255 * 255;                      // Fills a whole page. See test_build_stream().
+        default: return 70000 + r % (maxPacketSize - 70000);
+    }
+}
+
+typedef struct
+{
+    uint8_t* pData;
+    size_t dataSize;
+    size_t dataCapacity;
+
+    uint32_t pageSequence;
+    uint32_t otherPageSequence;
+
+    // The number of bytes of audio packet data written so far, and the position of each page of the Opus stream along with
+    // the number of bytes of audio data that came before it.
+    uint64_t audioDataSize;
+    int isAudio;
+    size_t* pPagePositions;
+    uint64_t* pPageAudioPositions;
+    size_t pageCapacity;
+
+    // The segments and data of the page being built.
+    uint8_t segments[255];
+    uint32_t segmentCount;
+    uint8_t pageData[255 * 255];
+    size_t pageDataSize;
+    int isContinued;            // Set when the page starts in the middle of a packet.
+    int64_t granulePosition;    // -1 until a packet finishes on the page.
+} test_ogg_writer;
+
+static void test_ogg_append(test_ogg_writer* pWriter, const void* pData, size_t dataSize)
+{
+    if (pWriter->dataSize + dataSize > pWriter->dataCapacity) {
+        size_t newCapacity = (pWriter->dataCapacity == 0) ? 1024*1024 : pWriter->dataCapacity * 2;
+        while (newCapacity < pWriter->dataSize + dataSize) {
+            newCapacity *= 2;
+        }
+
+        uint8_t* pNewData = (uint8_t*)realloc(pWriter->pData, newCapacity);
+        if (pNewData == NULL) {
+            printf("Out of memory.\n");
+            exit(1);
+        }
+
+        pWriter->pData = pNewData;
+        pWriter->dataCapacity = newCapacity;
+    }
+
+    memcpy(pWriter->pData + pWriter->dataSize, pData, dataSize);
+    pWriter->dataSize += dataSize;
+}
+
+static void test_ogg_write_page(test_ogg_writer* pWriter, uint8_t headerType, int64_t granulePosition, uint32_t serial, uint32_t sequence, const uint8_t* pSegments, uint32_t segmentCount, const uint8_t* pData, size_t dataSize)
+{
+    uint8_t header[27 + 255];
+    memcpy(header, "OggS", 4);
+    header[4] = 0;
+    header[5] = headerType;
+    test_put_u32(header +  6, (uint32_t)((uint64_t)granulePosition & 0xFFFFFFFF));
+    test_put_u32(header + 10, (uint32_t)((uint64_t)granulePosition >> 32));
+    test_put_u32(header + 14, serial);
+    test_put_u32(header + 18, sequence);
+    test_put_u32(header + 22, 0);
+    header[26] = (uint8_t)segmentCount;
+    memcpy(header + 27, pSegments, segmentCount);
+
+    // The CRC covers the header, with the CRC field set to zero, followed by the data.
+    uint8_t* pPage = (uint8_t*)malloc(27 + segmentCount + dataSize);
+    if (pPage == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    memcpy(pPage, header, 27 + segmentCount);
+    memcpy(pPage + 27 + segmentCount, pData, dataSize);
+    test_put_u32(pPage + 22, test_crc32(pPage, 27 + segmentCount + dataSize));
+
+    test_ogg_append(pWriter, pPage, 27 + segmentCount + dataSize);
+    free(pPage);
+}
+
+static void test_ogg_flush(test_ogg_writer* pWriter, uint8_t extraHeaderType)
+{
+    if (pWriter->segmentCount == 0 && extraHeaderType == 0) {
+        return;
+    }
+
+    if (pWriter->pageSequence == pWriter->pageCapacity) {
+        pWriter->pageCapacity = (pWriter->pageCapacity == 0) ? 1024 : pWriter->pageCapacity * 2;
+        pWriter->pPagePositions = (size_t*)realloc(pWriter->pPagePositions, pWriter->pageCapacity * sizeof(size_t));
+        pWriter->pPageAudioPositions = (uint64_t*)realloc(pWriter->pPageAudioPositions, pWriter->pageCapacity * sizeof(uint64_t));
+        if (pWriter->pPagePositions == NULL || pWriter->pPageAudioPositions == NULL) {
+            printf("Out of memory.\n");
+            exit(1);
+        }
+    }
+
+    pWriter->pPagePositions[pWriter->pageSequence] = pWriter->dataSize;
+    pWriter->pPageAudioPositions[pWriter->pageSequence] = pWriter->isAudio ? pWriter->audioDataSize - pWriter->pageDataSize : 0;
+
+    uint8_t headerType = (uint8_t)((pWriter->isContinued ? DROPUS_OGG_HEADER_TYPE_CONTINUED : 0) | extraHeaderType);
+    test_ogg_write_page(pWriter, headerType, pWriter->granulePosition, TEST_SERIAL, pWriter->pageSequence++, pWriter->segments, pWriter->segmentCount, pWriter->pageData, pWriter->pageDataSize);
+
+    pWriter->segmentCount = 0;
+    pWriter->pageDataSize = 0;
+    pWriter->granulePosition = -1;
+    pWriter->isContinued = 0;
+}
+
+// A page of another logical stream. These should be skipped.
+static void test_ogg_write_other_page(test_ogg_writer* pWriter, uint8_t headerType)
+{
+    uint8_t data[300];
+    memset(data, 'x', sizeof(data));
+    uint8_t segments[2] = {255, 45};
+    test_ogg_write_page(pWriter, headerType, 1234, TEST_OTHER_SERIAL, pWriter->otherPageSequence++, segments, 2, data, sizeof(data));
+}
+
+// Adds a packet, starting new pages as needed. <granulePosition> is the granule position at the end of the packet.
+static void test_ogg_write_packet(test_ogg_writer* pWriter, const uint8_t* pData, size_t dataSize, int64_t granulePosition)
+{
+    size_t pos = 0;
+    for (;;) {
+        if (pWriter->segmentCount == 255) {
+            test_ogg_flush(pWriter, 0);
+            pWriter->isContinued = pos > 0;
+        }
+
+        size_t lacing = (dataSize - pos < 255) ? dataSize - pos : 255;
+        pWriter->segments[pWriter->segmentCount++] = (uint8_t)lacing;
+        memcpy(pWriter->pageData + pWriter->pageDataSize, pData + pos, lacing);
+        pWriter->pageDataSize += lacing;
+        pWriter->audioDataSize += pWriter->isAudio ? lacing : 0;
+        pos += lacing;
+
+        if (lacing < 255) {
+            break;
+        }
+    }
+
+    pWriter->granulePosition = granulePosition;
+}
+
+typedef struct
+{
+    uint8_t* pData;
+    size_t dataSize;
+
+    uint32_t packetCount;
+    size_t* pPacketSizes;
+    int64_t lastGranule;
+
+    // The index of the packet that's too big to be reassembled.
+    uint32_t oversizedPacket;
+
+    // The byte position of each page of the Opus stream, and the number of bytes of audio packet data before it. The pages
+    // before <firstAudioPage> hold the headers.
+    uint32_t pageCount;
+    uint32_t firstAudioPage;
+    size_t* pPagePositions;
+    uint64_t* pPageAudioPositions;
+} test_stream;
+
+static void test_build_stream(test_stream* pStream, uint32_t packetCount, unsigned int seed)
+{
+    test_ogg_writer writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.granulePosition = -1;
+
+    memset(pStream, 0, sizeof(*pStream));
+    pStream->packetCount = packetCount;
+    pStream->pPacketSizes = (size_t*)malloc(packetCount * sizeof(size_t));
+    uint8_t* pPacket = (uint8_t*)malloc(DR_OPUS_MAX_PACKET_SIZE + 65536);
+    if (pStream->pPacketSizes == NULL || pPacket == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    // Another logical stream comes first. The Opus stream is the one whose first packet is OpusHead.
+    test_ogg_write_other_page(&writer, DROPUS_OGG_HEADER_TYPE_BOS);
+
+    uint8_t head[19] = {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, 2, TEST_PRE_SKIP & 0xFF, TEST_PRE_SKIP >> 8, 0x80, 0xBB, 0, 0, 0, 0, 0};
+    test_ogg_write_packet(&writer, head, sizeof(head), 0);
+    test_ogg_flush(&writer, DROPUS_OGG_HEADER_TYPE_BOS);
+
+    // A big OpusTags, like one with an embedded picture. The header packets each finish their page.
+    size_t tagsSize = 200000;
+    memset(pPacket, 't', tagsSize);
+    memcpy(pPacket, "OpusTags", 8);
+    test_ogg_write_packet(&writer, pPacket, tagsSize, 0);
+    test_ogg_flush(&writer, 0);
+
+    pStream->firstAudioPage = writer.pageSequence;
+    writer.isAudio = 1;
+
+    unsigned int random = seed;
+    pStream->oversizedPacket = packetCount / 3;
+    for (uint32_t iPacket = 0; iPacket < packetCount; ++iPacket) {
+        size_t packetSize = test_packet_size(iPacket, 90000, &random);
+        if (iPacket == pStream->oversizedPacket) {
+            packetSize = DR_OPUS_MAX_PACKET_SIZE + 1000;
+        }
+
+        // A packet of 255*255 bytes on a page of its own fills it, which pushes the terminating zero-length segment onto the
+        // next page.
+        if (packetSize == 255*255) {
+            test_ogg_flush(&writer, 0);
+        }
+
+        pStream->pPacketSizes[iPacket] = packetSize;
+        test_fill_packet(pPacket, packetSize, iPacket);
+        test_ogg_write_packet(&writer, pPacket, packetSize, (int64_t)(iPacket + 1) * TEST_FRAME_SIZE);
+
+        // Pages are sometimes ended early, like an encoder flushing on a time limit.
+        if (test_random(&random) % 8 == 0) {
+            test_ogg_flush(&writer, 0);
+        }
+
+        if (test_random(&random) % 50 == 0) {
+            test_ogg_flush(&writer, 0);
+            test_ogg_write_other_page(&writer, 0);
+        }
+    }
+
+    test_ogg_flush(&writer, DROPUS_OGG_HEADER_TYPE_EOS);
+    pStream->lastGranule = (int64_t)packetCount * TEST_FRAME_SIZE;
+
+    pStream->pData = writer.pData;
+    pStream->dataSize = writer.dataSize;
+    pStream->pageCount = writer.pageSequence;
+    pStream->pPagePositions = writer.pPagePositions;
+    pStream->pPageAudioPositions = writer.pPageAudioPositions;
+    free(pPacket);
+}
+
+static void test_free_stream(test_stream* pStream)
+{
+    free(pStream->pData);
+    free(pStream->pPacketSizes);
+    free(pStream->pPagePositions);
+    free(pStream->pPageAudioPositions);
+}
+
+// Checks that a packet is the audio packet with the given index.
+static int test_is_packet(const test_stream* pStream, const dropus_packet* pPacket, uint32_t iPacket)
+{
+    if (iPacket >= pStream->packetCount || pPacket->dataSize != pStream->pPacketSizes[iPacket]) {
+        return 0;
+    }
+
+    uint8_t* pExpected = (uint8_t*)malloc(pPacket->dataSize);
+    if (pExpected == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    test_fill_packet(pExpected, pPacket->dataSize, iPacket);
+    int isEqual = memcmp(pExpected, pPacket->pData, pPacket->dataSize) == 0;
+    free(pExpected);
+    return isEqual;
+}
+
+static uint32_t test_packet_index(const dropus_packet* pPacket)
+{
+    return (pPacket->dataSize >= 4) ? test_get_u32(pPacket->pData) : 0xFFFFFFFF;
+}
+
+
+//// Reading ////
+
+typedef struct
+{
+    const uint8_t* pData;
+    size_t dataSize;
+    size_t cursor;
+} test_memory_reader;
+
+static size_t test_on_read(void* pUserData, void* pBufferOut, size_t bytesToRead)
+{
+    test_memory_reader* pReader = (test_memory_reader*)pUserData;
+    if (bytesToRead > pReader->dataSize - pReader->cursor) {
+        bytesToRead = pReader->dataSize - pReader->cursor;
+    }
+
+    memcpy(pBufferOut, pReader->pData + pReader->cursor, bytesToRead);
+    pReader->cursor += bytesToRead;
+    return bytesToRead;
+}
+
+// Reads every packet from start to finish. <isPacketLost> says which packets aren't expected because of a corrupt page.
+static void test_read_all(const char* name, const test_stream* pStream, const uint8_t* pData, int isSeekable, const uint8_t* isPacketLost)
+{
+    dropus* pOpus;
+    test_memory_reader reader;
+    if (isSeekable) {
+        pOpus = dropus_open_memory(pData, pStream->dataSize);
+    } else {
+        reader.pData = pData;
+        reader.dataSize = pStream->dataSize;
+        reader.cursor = 0;
+        pOpus = dropus_open(test_on_read, NULL, &reader);
+    }
+
+    if (pOpus == NULL) {
+        TEST_CHECK(0, "%s: dropus_open()", name);
+        return;
+    }
+
+    TEST_CHECK(pOpus->channels == 2 && pOpus->preSkip == TEST_PRE_SKIP && pOpus->inputSampleRate == 48000, "%s: bad OpusHead", name);
+
+    uint64_t expectedTotal = isSeekable ? (uint64_t)(pStream->lastGranule - TEST_PRE_SKIP) * 2 : 0;
+    TEST_CHECK(pOpus->totalSampleCount == expectedTotal, "%s: total sample count is %llu, expected %llu", name, (unsigned long long)pOpus->totalSampleCount, (unsigned long long)expectedTotal);
+
+    uint32_t iExpected = 0;
+    uint32_t packetsRead = 0;
+    dropus_packet packet;
+    while (dropus_read_packet(pOpus, &packet)) {
+        while (iExpected < pStream->packetCount && (iExpected == pStream->oversizedPacket || (isPacketLost != NULL && isPacketLost[iExpected]))) {
+            iExpected += 1;
+        }
+
+        if (!test_is_packet(pStream, &packet, iExpected)) {
+            TEST_CHECK(0, "%s: packet %u (%zu bytes) is wrong, expected packet %u", name, test_packet_index(&packet), packet.dataSize, iExpected);
+            break;
+        }
+
+        // The granule position is only given for the last packet to finish on a page, and is the end of that packet.
+        TEST_CHECK(packet.granulePosition == -1 || packet.granulePosition == (int64_t)(iExpected + 1) * TEST_FRAME_SIZE, "%s: packet %u has granule position %lld", name, iExpected, (long long)packet.granulePosition);
+
+        iExpected += 1;
+        packetsRead += 1;
+    }
+
+    while (iExpected < pStream->packetCount && (iExpected == pStream->oversizedPacket || (isPacketLost != NULL && isPacketLost[iExpected]))) {
+        iExpected += 1;
+    }
+    TEST_CHECK(iExpected == pStream->packetCount, "%s: stopped at packet %u of %u", name, iExpected, pStream->packetCount);
+
+    printf("%-40s %u packets\n", name, packetsRead);
+    dropus_close(pOpus);
+}
+
+// Corrupts one byte of the data of the given page, and works out which packets are lost along with it.
+static uint8_t* test_corrupt_page(const test_stream* pStream, uint32_t iPage, uint8_t* isPacketLost)
+{
+    uint8_t* pData = (uint8_t*)malloc(pStream->dataSize);
+    if (pData == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    memcpy(pData, pStream->pData, pStream->dataSize);
+
+    // Every packet with data on the page is lost, as is a packet whose terminating zero-length segment is the first segment
+    // of the page.
+    const uint8_t* pPage = pStream->pData + pStream->pPagePositions[iPage];
+    uint32_t segmentCount = pPage[26];
+    size_t dataStart = pStream->pPagePositions[iPage] + 27 + segmentCount;
+    size_t pageDataSize = 0;
+    for (uint32_t i = 0; i < segmentCount; ++i) {
+        pageDataSize += pPage[27 + i];
+    }
+
+    uint64_t pageStart = pStream->pPageAudioPositions[iPage];
+    uint64_t pageEnd = pageStart + pageDataSize;
+
+    memset(isPacketLost, 0, pStream->packetCount);
+    uint64_t packetStart = 0;
+    for (uint32_t iPacket = 0; iPacket < pStream->packetCount; ++iPacket) {
+        uint64_t packetEnd = packetStart + pStream->pPacketSizes[iPacket];
+        if ((packetStart < pageEnd && packetEnd > pageStart) || (packetEnd == pageStart && pPage[27] == 0)) {
+            isPacketLost[iPacket] = 1;
+        }
+
+        packetStart = packetEnd;
+    }
+
+    // The byte is flipped in the data rather than the header so the page is still found and has to fail its CRC.
+    pData[dataStart + pageDataSize/2] ^= 0x55;
+    if (pageDataSize == 0) {
+        pData[pStream->pPagePositions[iPage] + 22] ^= 0x55;
+    }
+    return pData;
+}
+
+
+//// Seeking ////
+
+static void test_seek(const test_stream* pStream, unsigned int seekCount)
+{
+    const char* name = "seek to granule";
+
+    dropus* pOpus = dropus_open_memory(pStream->pData, pStream->dataSize);
+    if (pOpus == NULL) {
+        TEST_CHECK(0, "%s: dropus_open_memory()", name);
+        return;
+    }
+
+    unsigned int random = 7;
+    for (unsigned int iSeek = 0; iSeek < seekCount; ++iSeek) {
+        uint64_t target;
+        switch (iSeek)
+        {
+            case 0:  target = 0; break;
+            case 1:  target = (uint64_t)pStream->lastGranule; break;
+            case 2:  target = (uint64_t)pStream->lastGranule + 100000; break;
+            case 3:  target = (uint64_t)pStream->oversizedPacket * TEST_FRAME_SIZE; break;
+            default: target = ((uint64_t)test_random(&random) * 4099) % (uint64_t)(pStream->lastGranule + TEST_FRAME_SIZE); break;
+        }
+
+        // The expected position is the last page granule at or before the target. Page granules are at the end of the last
+        // packet finishing on the page, which is also the start of the next packet.
+        uint64_t expectedGranule = 0;
+        for (uint32_t iPage = 0; iPage < pStream->pageCount; ++iPage) {
+            const uint8_t* pPage = pStream->pData + pStream->pPagePositions[iPage];
+            int64_t pageGranule = (int64_t)(((uint64_t)test_get_u32(pPage + 10) << 32) | test_get_u32(pPage + 6));
+            if (pageGranule != -1 && pageGranule <= (int64_t)target && (uint64_t)pageGranule > expectedGranule) {
+                expectedGranule = (uint64_t)pageGranule;
+            }
+        }
+
+        uint64_t packetGranule;
+        if (!dropus_seek_to_granule(pOpus, target, &packetGranule)) {
+            TEST_CHECK(0, "%s: dropus_seek_to_granule(%llu)", name, (unsigned long long)target);
+            continue;
+        }
+
+        TEST_CHECK(packetGranule == expectedGranule, "%s: seeking to %llu gave packet granule %llu, expected %llu", name, (unsigned long long)target, (unsigned long long)packetGranule, (unsigned long long)expectedGranule);
+
+        uint32_t iExpected = (uint32_t)(expectedGranule / TEST_FRAME_SIZE);
+        if (iExpected == pStream->oversizedPacket) {
+            iExpected += 1;
+        }
+
+        dropus_packet packet;
+        if (iExpected >= pStream->packetCount) {
+            TEST_CHECK(!dropus_read_packet(pOpus, &packet), "%s: read a packet after seeking to the end", name);
+        } else {
+            TEST_CHECK(dropus_read_packet(pOpus, &packet) && test_is_packet(pStream, &packet, iExpected), "%s: seeking to %llu gave the wrong packet, expected %u", name, (unsigned long long)target, iExpected);
+        }
+    }
+
+    printf("%-40s %u seeks\n", name, seekCount);
+    dropus_close(pOpus);
+}
+
+
+int main(int argc, char** argv)
+{
+    int isQuick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    uint32_t packetCount = isQuick ? 300 : 3000;
+    unsigned int seekCount = isQuick ? 100 : 400;
+
+    test_stream stream;
+    test_build_stream(&stream, packetCount, 1);
+    printf("Stream of %u packets in %u pages, %zu bytes\n\n", packetCount, stream.pageCount, stream.dataSize);
+
+    test_read_all("read with seek callback", &stream, stream.pData, 1, NULL);
+    test_read_all("read without seek callback", &stream, stream.pData, 0, NULL);
+
+    // Corrupt a few pages, one at a time, and make sure only the packets on them are lost.
+    uint8_t* isPacketLost = (uint8_t*)malloc(packetCount);
+    if (isPacketLost == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    unsigned int random = 3;
+    for (int iCorrupt = 0; iCorrupt < 8; ++iCorrupt) {
+        uint32_t iPage = stream.firstAudioPage + test_random(&random) % (stream.pageCount - stream.firstAudioPage);
+        uint8_t* pCorrupt = test_corrupt_page(&stream, iPage, isPacketLost);
+
+        char name[64];
+        snprintf(name, sizeof(name), "corrupt page %u, with seek callback", iPage);
+        test_read_all(name, &stream, pCorrupt, 1, isPacketLost);
+        snprintf(name, sizeof(name), "corrupt page %u, without seek callback", iPage);
+        test_read_all(name, &stream, pCorrupt, 0, isPacketLost);
+        free(pCorrupt);
+    }
+    free(isPacketLost);
+
+    test_seek(&stream, seekCount);
+
+    test_free_stream(&stream);
+
+    if (g_failCount > 0) {
+        printf("\n%d CHECKS FAILED\n", g_failCount);
+        return 1;
+    }
+
+    printf("\nALL CHECKS PASSED\n");
+    return 0;
+}
@@ -0,0 +1,628 @@
+// Decoding test for dr_pcx.
+//
+// This encodes PCX files in memory for every supported combination of bits per pixel and planes, with a few different sizes,
+// and checks that every way of loading them gives the same pixels as a simple reference decoder:
+//
+//   - drpcx_load(), drpcx_load_memory() and drpcx_load_file(), flipped and not.
+//   - drpcx_load_into() and friends in each output format, flipped and not, into an area larger than the image.
+//   - The streaming API, from memory, from a file, and from callbacks with and without a seek callback.
+//   - drpcx_load_batch() with a mix of files, memory, allocated and client owned outputs, on one and several threads.
+//
+// 8-bit single plane images are covered with a 256 color palette, as grayscale, and as grayscale with trailing data that looks
+// like a palette from the end of the file but doesn't follow the image data. Some files let runs carry over from one scanline
+// to the next, and some have padding at the end of each scanline.
+//
+// Temporary files are written to the current directory and removed afterwards. Build and run with something like this:
+//
+//   cc -std=c99 -O2 -DDR_PCX_USE_THREADS dr_pcx_test1.c -o dr_pcx_test1 -lpthread && ./dr_pcx_test1
+//
+// Pass --quick to only use small images. The exit code is non-zero if any check fails. This is also worth running with
+// -fsanitize=address and -fsanitize=thread.
+
+#define DR_PCX_IMPLEMENTATION
+#include "../dr_pcx.h"
+
+#include <stdio.h>
+
+#define TEST_MAX_IMAGES     64
+
+static int g_failCount = 0;
+
+#define TEST_CHECK(condition, ...)      \
+    do {                                \
+        if (!(condition)) {             \
+            printf("FAILED: ");         \
+            printf(__VA_ARGS__);        \
+            printf("\n");               \
+            g_failCount += 1;           \
+        }                               \
+    } while (0)
+
+static const char* g_formatNames[3] = {"rgb8", "rgba8", "bgra8"};
+
+
+static unsigned int test_random(unsigned int* pState)
+{
+    *pState = *pState * 1664525 + 1013904223;
+    return *pState >> 8;
+}
+
+static void* test_malloc(size_t size)
+{
+    void* p = malloc(size);
+    if (p == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    return p;
+}
+
+
+//// Encoding ////
+
+typedef enum
+{
+    test_palette_none,          // Anything other than 8-bit single plane images.
+    test_palette_256,           // A 256 color palette after the image data.
+    test_palette_gray,          // Grayscale, as stated by the header.
+    test_palette_gray_trailing  // Grayscale, but with a version 5 header and 0x0C 769 bytes from the end of the file.
+} test_palette;
+
+typedef struct
+{
+    char name[64];
+    unsigned int width;
+    unsigned int height;
+    unsigned int bpp;
+    unsigned int planes;
+    test_palette palette;
+
+    // The file, and the path of a copy of it on disk.
+    uint8_t* pFile;
+    size_t fileSize;
+    char filePath[64];
+
+    // The expected pixels as RGBA, top row first.
+    uint8_t* pExpected;
+
+    // The number of components drpcx_load() outputs.
+    unsigned int components;
+
+    // Whether or not the image can be streamed without a seek callback, and whether the streaming API gives the same result as
+    // loading the whole image. Streams trust the palette at the end of the file without checking it follows the image data.
+    int isStreamableWithoutSeek;
+    int isStreamExact;
+} test_image;
+
+// Run-length encodes <size> bytes. Values with the two top bits set always need to be encoded as a run.
+static size_t test_rle_encode(const uint8_t* pIn, size_t size, uint8_t* pOut)
+{
+    size_t outSize = 0;
+    for (size_t i = 0; i < size;) {
+        size_t run = 1;
+        while (i + run < size && run < 63 && pIn[i + run] == pIn[i]) {
+            run += 1;
+        }
+
+        if (run == 1 && (pIn[i] & 0xC0) != 0xC0) {
+            pOut[outSize++] = pIn[i];
+        } else {
+            pOut[outSize++] = (uint8_t)(0xC0 | run);
+            pOut[outSize++] = pIn[i];
+        }
+        i += run;
+    }
+
+    return outSize;
+}
+
+// Decodes pixel <x> of a scanline the straightforward way, returning it as RGBA.
+static void test_reference_pixel(const test_image* pImage, const uint8_t* pScanline, unsigned int bytesPerLine, const uint8_t* pPalette16, const uint8_t* pPalette256, unsigned int x, uint8_t* pRGBA)
+{
+    pRGBA[3] = 0xFF;
+
+    if (pImage->bpp == 8) {
+        if (pImage->planes == 1) {
+            uint8_t value = pScanline[x];
+            if (pImage->palette == test_palette_256) {
+                memcpy(pRGBA, pPalette256 + value*3, 3);
+            } else {
+                pRGBA[0] = pRGBA[1] = pRGBA[2] = value;
+            }
+        } else {
+            for (unsigned int plane = 0; plane < pImage->planes; ++plane) {
+                pRGBA[plane] = pScanline[plane*bytesPerLine + x];
+            }
+        }
+        return;
+    }
+
+    // Each plane holds one bit of the palette index, with the pixels packed from the most significant bit down.
+    unsigned int index = 0;
+    unsigned int bitPos = x * pImage->bpp;
+    for (unsigned int plane = 0; plane < pImage->planes; ++plane) {
+        uint8_t byte = pScanline[plane*bytesPerLine + bitPos/8];
+        unsigned int value = (byte >> (8 - pImage->bpp - bitPos%8)) & ((1U << pImage->bpp) - 1);
+        index |= value << plane;
+    }
+
+    memcpy(pRGBA, pPalette16 + index*3, 3);
+}
+
+static void test_build_image(test_image* pImage, unsigned int width, unsigned int height, unsigned int bpp, unsigned int planes, test_palette palette, int runsCrossLines, unsigned int linePadding, unsigned int* pRandom)
+{
+    static const char* paletteNames[4] = {"", " palette", " gray", " gray + trailing"};
+
+    memset(pImage, 0, sizeof(*pImage));
+    snprintf(pImage->name, sizeof(pImage->name), "%ux%u %ubpp x%u%s%s", width, height, bpp, planes, paletteNames[palette], runsCrossLines ? " (long runs)" : "");
+    pImage->width = width;
+    pImage->height = height;
+    pImage->bpp = bpp;
+    pImage->planes = planes;
+    pImage->palette = palette;
+    pImage->components = (bpp == 8 && planes == 4) ? 4 : 3;
+    pImage->isStreamableWithoutSeek = !(bpp == 8 && planes == 1 && palette != test_palette_gray);
+    pImage->isStreamExact = (palette != test_palette_gray_trailing);
+
+    // Scanlines are an even number of bytes.
+    unsigned int bytesPerLine = (width*bpp + 7) / 8;
+    bytesPerLine += (bytesPerLine % 2) + linePadding;
+
+    uint8_t palette16[48];
+    uint8_t palette256[768];
+    for (int i = 0; i < 48; ++i) {
+        palette16[i] = (uint8_t)test_random(pRandom);
+    }
+    for (int i = 0; i < 768; ++i) {
+        palette256[i] = (uint8_t)test_random(pRandom);
+    }
+
+    // The raw scanlines, with plenty of runs. Padding bytes are random too since decoders should ignore them.
+    size_t lineSize = (size_t)bytesPerLine * planes;
+    size_t rawSize = lineSize * height;
+    uint8_t* pRaw = (uint8_t*)test_malloc(rawSize + 1);
+    for (size_t i = 0; i < rawSize; ++i) {
+        unsigned int r = test_random(pRandom);
+        pRaw[i] = (i > 0 && (r & 3) != 0) ? pRaw[i - 1] : (uint8_t)(r >> 8);
+    }
+
+    pImage->pExpected = (uint8_t*)test_malloc((size_t)width * height * 4);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            test_reference_pixel(pImage, pRaw + y*lineSize, bytesPerLine, palette16, palette256, x, pImage->pExpected + ((size_t)y*width + x)*4);
+        }
+    }
+
+    // Worst case every byte is a run of 1, plus the palette and trailing data.
+    pImage->pFile = (uint8_t*)test_malloc(128 + rawSize*2 + 770);
+    uint8_t* pHeader = pImage->pFile;
+    memset(pHeader, 0, 128);
+    pHeader[0] = 10;
+    pHeader[1] = (palette == test_palette_gray) ? 3 : 5;
+    pHeader[2] = 1;
+    pHeader[3] = (uint8_t)bpp;
+    pHeader[8] = (uint8_t)((width - 1) & 0xFF);
+    pHeader[9] = (uint8_t)((width - 1) >> 8);
+    pHeader[10] = (uint8_t)((height - 1) & 0xFF);
+    pHeader[11] = (uint8_t)((height - 1) >> 8);
+    memcpy(pHeader + 16, palette16, 48);
+    pHeader[65] = (uint8_t)planes;
+    pHeader[66] = (uint8_t)(bytesPerLine & 0xFF);
+    pHeader[67] = (uint8_t)(bytesPerLine >> 8);
+    pHeader[68] = (palette == test_palette_gray) ? 2 : 1;
+
+    size_t fileSize = 128;
+    if (runsCrossLines) {
+        fileSize += test_rle_encode(pRaw, rawSize, pImage->pFile + fileSize);
+    } else {
+        for (unsigned int y = 0; y < height; ++y) {
+            fileSize += test_rle_encode(pRaw + y*lineSize, lineSize, pImage->pFile + fileSize);
+        }
+    }
+
+    if (palette == test_palette_256) {
+        pImage->pFile[fileSize++] = 0x0C;
+        memcpy(pImage->pFile + fileSize, palette256, 768);
+        fileSize += 768;
+    } else if (palette == test_palette_gray_trailing) {
+        memset(pImage->pFile + fileSize, 0, 770);
+        pImage->pFile[fileSize + 1] = 0x0C;
+        memcpy(pImage->pFile + fileSize + 2, palette256, 768);
+        fileSize += 770;
+    }
+
+    pImage->fileSize = fileSize;
+    free(pRaw);
+}
+
+static void test_free_image(test_image* pImage)
+{
+    free(pImage->pFile);
+    free(pImage->pExpected);
+}
+
+
+//// Checking ////
+
+// Checks a decoded image in the given format, with rows <stride> bytes apart.
+static int test_compare(const test_image* pImage, const uint8_t* pOut, size_t stride, drpcx_format format, int flipped)
+{
+    unsigned int components = (format == drpcx_format_rgb8) ? 3 : 4;
+    for (unsigned int y = 0; y < pImage->height; ++y) {
+        const uint8_t* pRow = pOut + (flipped ? pImage->height - y - 1 : y) * stride;
+        for (unsigned int x = 0; x < pImage->width; ++x) {
+            const uint8_t* pExpected = pImage->pExpected + ((size_t)y*pImage->width + x)*4;
+            uint8_t pixel[4] = {pExpected[0], pExpected[1], pExpected[2], pExpected[3]};
+            if (format == drpcx_format_bgra8) {
+                pixel[0] = pExpected[2];
+                pixel[2] = pExpected[0];
+            }
+
+            if (memcmp(pRow + x*components, pixel, components) != 0) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static int test_compare_pcx(const test_image* pImage, const drpcx* pPCX, int flipped)
+{
+    if (pPCX == NULL || pPCX->width != pImage->width || pPCX->height != pImage->height || pPCX->components != pImage->components) {
+        return 0;
+    }
+
+    return test_compare(pImage, (const uint8_t*)pPCX->pData, (size_t)pImage->width * pImage->components, (pImage->components == 4) ? drpcx_format_rgba8 : drpcx_format_rgb8, flipped);
+}
+
+
+// Reads from memory, a few bytes at a time so the decoder has to deal with short reads.
+typedef struct
+{
+    const uint8_t* pData;
+    size_t dataSize;
+    size_t cursor;
+    unsigned int random;
+} test_reader;
+
+static size_t test_on_read(void* pUserData, void* pBufferOut, size_t bytesToRead)
+{
+    test_reader* pReader = (test_reader*)pUserData;
+    size_t maxBytes = 1 + test_random(&pReader->random) % 1000;
+    if (bytesToRead > maxBytes) {
+        bytesToRead = maxBytes;
+    }
+    if (bytesToRead > pReader->dataSize - pReader->cursor) {
+        bytesToRead = pReader->dataSize - pReader->cursor;
+    }
+
+    memcpy(pBufferOut, pReader->pData + pReader->cursor, bytesToRead);
+    pReader->cursor += bytesToRead;
+    return bytesToRead;
+}
+
+static bool test_on_seek(void* pUserData, int64_t offset, drpcx_seek_origin origin)
+{
+    test_reader* pReader = (test_reader*)pUserData;
+    int64_t newCursor = (origin == drpcx_seek_origin_start) ? offset : (int64_t)pReader->dataSize + offset;
+    if (newCursor < 0 || newCursor > (int64_t)pReader->dataSize) {
+        return false;
+    }
+
+    pReader->cursor = (size_t)newCursor;
+    return true;
+}
+
+static test_reader* test_reader_init(test_reader* pReader, const test_image* pImage)
+{
+    pReader->pData = pImage->pFile;
+    pReader->dataSize = pImage->fileSize;
+    pReader->cursor = 0;
+    pReader->random = 7;
+    return pReader;
+}
+
+
+static void test_load(const test_image* pImage)
+{
+    const char* name = pImage->name;
+    test_reader reader;
+
+    drpcx_image_info info;
+    TEST_CHECK(drpcx_info_memory(pImage->pFile, pImage->fileSize, &info) && info.width == pImage->width && info.height == pImage->height &&
+               info.bitsPerPixel == pImage->bpp && info.bitPlanes == pImage->planes && info.components == pImage->components, "%s: drpcx_info_memory()", name);
+    TEST_CHECK(drpcx_info_file(pImage->filePath, &info) && info.width == pImage->width && info.height == pImage->height, "%s: drpcx_info_file()", name);
+    TEST_CHECK(drpcx_info(test_on_read, test_reader_init(&reader, pImage), &info) && info.bitPlanes == pImage->planes, "%s: drpcx_info()", name);
+
+    for (int flipped = 0; flipped <= 1; ++flipped) {
+        drpcx* pPCX = drpcx_load_memory(pImage->pFile, pImage->fileSize, flipped);
+        TEST_CHECK(test_compare_pcx(pImage, pPCX, flipped), "%s: drpcx_load_memory(flipped = %d)", name, flipped);
+        drpcx_delete(pPCX);
+
+        pPCX = drpcx_load(test_on_read, test_reader_init(&reader, pImage), flipped);
+        TEST_CHECK(test_compare_pcx(pImage, pPCX, flipped), "%s: drpcx_load(flipped = %d)", name, flipped);
+        drpcx_delete(pPCX);
+
+        pPCX = drpcx_load_file(pImage->filePath, flipped);
+        TEST_CHECK(test_compare_pcx(pImage, pPCX, flipped), "%s: drpcx_load_file(flipped = %d)", name, flipped);
+        drpcx_delete(pPCX);
+    }
+
+    // Decoding into an area that's bigger than the image, with padding at the end of each row. Nothing outside of the image
+    // may be touched.
+    unsigned int outWidth = pImage->width + 3;
+    unsigned int outHeight = pImage->height + 2;
+    size_t outStride = (size_t)outWidth*4 + 5;
+    size_t outSize = outStride * outHeight;
+    uint8_t* pOut = (uint8_t*)test_malloc(outSize);
+    uint8_t* pUntouched = (uint8_t*)test_malloc(outSize);
+    memset(pUntouched, 0xA5, outSize);
+
+    for (int iFormat = 0; iFormat < 3; ++iFormat) {
+        drpcx_format format = (drpcx_format)iFormat;
+        size_t imageRowSize = (size_t)pImage->width * ((format == drpcx_format_rgb8) ? 3 : 4);
+
+        for (int flipped = 0; flipped <= 1; ++flipped) {
+            for (int source = 0; source < 3; ++source) {
+                static const char* sourceNames[3] = {"drpcx_load_memory_into", "drpcx_load_into", "drpcx_load_file_into"};
+
+                memset(pOut, 0xA5, outSize);
+                bool result;
+                if (source == 0) {
+                    result = drpcx_load_memory_into(pImage->pFile, pImage->fileSize, pOut, outWidth, outHeight, outStride, format, flipped);
+                } else if (source == 1) {
+                    result = drpcx_load_into(test_on_read, test_reader_init(&reader, pImage), pOut, outWidth, outHeight, outStride, format, flipped);
+                } else {
+                    result = drpcx_load_file_into(pImage->filePath, pOut, outWidth, outHeight, outStride, format, flipped);
+                }
+
+                TEST_CHECK(result && test_compare(pImage, pOut, outStride, format, flipped), "%s: %s(%s, flipped = %d)", name, sourceNames[source], g_formatNames[format], flipped);
+
+                int isOutsideUntouched = 1;
+                for (unsigned int y = 0; y < outHeight; ++y) {
+                    size_t start = (y < pImage->height) ? imageRowSize : 0;
+                    if (memcmp(pOut + y*outStride + start, pUntouched, outStride - start) != 0) {
+                        isOutsideUntouched = 0;
+                    }
+                }
+                TEST_CHECK(isOutsideUntouched, "%s: %s(%s, flipped = %d) wrote outside of the image", name, sourceNames[source], g_formatNames[format], flipped);
+            }
+        }
+    }
+
+    // Too small an area fails without writing anything.
+    memset(pOut, 0xA5, outSize);
+    TEST_CHECK(!drpcx_load_memory_into(pImage->pFile, pImage->fileSize, pOut, pImage->width - 1, outHeight, outStride, drpcx_format_rgba8, false), "%s: decoded into an area that's too narrow", name);
+    TEST_CHECK(!drpcx_load_memory_into(pImage->pFile, pImage->fileSize, pOut, outWidth, pImage->height - 1, outStride, drpcx_format_rgba8, false), "%s: decoded into an area that's too short", name);
+    TEST_CHECK(!drpcx_load_memory_into(pImage->pFile, pImage->fileSize, pOut, outWidth, outHeight, (size_t)outWidth*4 - 1, drpcx_format_rgba8, false), "%s: decoded with a stride that's too small", name);
+    TEST_CHECK(memcmp(pOut, pUntouched, outSize) == 0, "%s: failed calls wrote to the output", name);
+
+    free(pOut);
+    free(pUntouched);
+}
+
+
+//// Streaming ////
+
+typedef struct
+{
+    const test_image* pImage;
+    uint8_t* pOut;
+    size_t stride;
+    unsigned int nextRow;
+    unsigned int stopAfter;
+    int isOrdered;
+} test_row_collector;
+
+static bool test_on_row(void* pUserData, unsigned int row, const void* pRow)
+{
+    test_row_collector* pCollector = (test_row_collector*)pUserData;
+    if (row != pCollector->nextRow) {
+        pCollector->isOrdered = 0;
+    }
+
+    memcpy(pCollector->pOut + row*pCollector->stride, pRow, pCollector->stride);
+    pCollector->nextRow = row + 1;
+    return pCollector->nextRow != pCollector->stopAfter;
+}
+
+// Reads every row of the stream with drpcx_read_row(), or with drpcx_read_rows() after reading the first few rows one at a time.
+static int test_read_stream(const test_image* pImage, drpcx_stream* pStream, drpcx_format format, int useReadRows)
+{
+    unsigned int components = (format == drpcx_format_rgb8) ? 3 : 4;
+    if (pStream == NULL || pStream->width != pImage->width || pStream->height != pImage->height || pStream->format != format || pStream->components != components) {
+        return 0;
+    }
+
+    size_t stride = (size_t)pImage->width * components;
+    uint8_t* pOut = (uint8_t*)test_malloc(stride * pImage->height);
+
+    int result = 1;
+    unsigned int firstRows = useReadRows ? pImage->height/3 : pImage->height;
+    for (unsigned int y = 0; y < firstRows; ++y) {
+        if (pStream->nextRow != y || !drpcx_read_row(pStream, pOut + y*stride)) {
+            result = 0;
+        }
+    }
+
+    if (useReadRows) {
+        // Stop once, part way through, then carry on.
+        test_row_collector collector = {pImage, pOut, stride, firstRows, firstRows + (pImage->height - firstRows)/2, 1};
+        if (collector.stopAfter != pImage->height && collector.stopAfter != firstRows) {
+            result &= !drpcx_read_rows(pStream, test_on_row, &collector);
+            result &= (collector.nextRow == collector.stopAfter);
+        }
+        collector.stopAfter = 0;
+        result &= drpcx_read_rows(pStream, test_on_row, &collector);
+        result &= collector.isOrdered && collector.nextRow == pImage->height;
+    }
+
+    result &= !drpcx_read_row(pStream, pOut) && pStream->nextRow == pImage->height;
+    result &= test_compare(pImage, pOut, stride, format, 0);
+
+    free(pOut);
+    return result;
+}
+
+static void test_stream(const test_image* pImage)
+{
+    const char* name = pImage->name;
+    if (!pImage->isStreamExact) {
+        return;
+    }
+
+    test_reader reader;
+    for (int iFormat = 0; iFormat < 3; ++iFormat) {
+        drpcx_format format = (drpcx_format)iFormat;
+        for (int useReadRows = 0; useReadRows <= 1; ++useReadRows) {
+            drpcx_stream* pStream = drpcx_open_memory(pImage->pFile, pImage->fileSize, format);
+            TEST_CHECK(test_read_stream(pImage, pStream, format, useReadRows), "%s: drpcx_open_memory(%s), %s", name, g_formatNames[format], useReadRows ? "drpcx_read_rows()" : "drpcx_read_row()");
+            drpcx_close(pStream);
+
+            pStream = drpcx_open_file(pImage->filePath, format);
+            TEST_CHECK(test_read_stream(pImage, pStream, format, useReadRows), "%s: drpcx_open_file(%s), %s", name, g_formatNames[format], useReadRows ? "drpcx_read_rows()" : "drpcx_read_row()");
+            drpcx_close(pStream);
+
+            pStream = drpcx_open(test_on_read, test_on_seek, test_reader_init(&reader, pImage), format);
+            TEST_CHECK(test_read_stream(pImage, pStream, format, useReadRows), "%s: drpcx_open(%s) with a seek callback, %s", name, g_formatNames[format], useReadRows ? "drpcx_read_rows()" : "drpcx_read_row()");
+            drpcx_close(pStream);
+        }
+
+        drpcx_stream* pStream = drpcx_open(test_on_read, NULL, test_reader_init(&reader, pImage), format);
+        if (pImage->isStreamableWithoutSeek) {
+            TEST_CHECK(test_read_stream(pImage, pStream, format, 0), "%s: drpcx_open(%s) without a seek callback", name, g_formatNames[format]);
+        } else {
+            TEST_CHECK(pStream == NULL, "%s: drpcx_open(%s) without a seek callback should fail", name, g_formatNames[format]);
+        }
+        drpcx_close(pStream);
+    }
+}
+
+
+//// Batches ////
+
+// Checks the result of every item of a batch built by test_batch(), deleting the images that were allocated.
+static void test_check_batch(const test_image* pImages, size_t imageCount, drpcx_batch_item* pItems, size_t itemCount, unsigned int threadCount)
+{
+    for (size_t i = 0; i < itemCount; ++i) {
+        const test_image* pImage = &pImages[i % imageCount];
+        drpcx_batch_item* pItem = &pItems[i];
+        if (pItem->pOut != NULL) {
+            TEST_CHECK(pItem->succeeded && pItem->pPCX == NULL && test_compare(pImage, (const uint8_t*)pItem->pOut, pItem->outStride, pItem->format, pItem->flipped), "batch on %u threads: item %zu (%s)", threadCount, i, pImage->name);
+        } else {
+            TEST_CHECK(pItem->succeeded && test_compare_pcx(pImage, pItem->pPCX, pItem->flipped), "batch on %u threads: item %zu (%s)", threadCount, i, pImage->name);
+            drpcx_delete(pItem->pPCX);
+            pItem->pPCX = NULL;
+        }
+    }
+}
+
+static void test_batch(const test_image* pImages, size_t imageCount, unsigned int threadCount)
+{
+    // Every image is in the batch twice, with the source and destination depending on its position.
+    drpcx_batch_item items[TEST_MAX_IMAGES*2 + 1];
+    size_t itemCount = imageCount*2;
+    memset(items, 0, sizeof(items));
+
+    for (size_t i = 0; i < itemCount; ++i) {
+        const test_image* pImage = &pImages[i % imageCount];
+        drpcx_batch_item* pItem = &items[i];
+        if (i % 3 == 0) {
+            pItem->pFilePath = pImage->filePath;
+        } else {
+            pItem->pData = pImage->pFile;
+            pItem->dataSize = pImage->fileSize;
+        }
+
+        pItem->flipped = (i / imageCount) == 1;
+        if (i % 2 == 1) {
+            pItem->format = (drpcx_format)(i % 3);
+            pItem->outWidth = pImage->width;
+            pItem->outHeight = pImage->height;
+            pItem->outStride = (size_t)pImage->width * 4 + 1;
+            pItem->pOut = test_malloc(pItem->outStride * pImage->height);
+        }
+    }
+
+    TEST_CHECK(drpcx_load_batch(items, itemCount, threadCount), "batch on %u threads: failed", threadCount);
+    test_check_batch(pImages, imageCount, items, itemCount, threadCount);
+
+    // Again with one that can't succeed on the end, which mustn't stop the others.
+    items[itemCount].pFilePath = "dr_pcx_test1.missing.pcx";
+    TEST_CHECK(!drpcx_load_batch(items, itemCount + 1, threadCount), "batch on %u threads: succeeded with a missing file", threadCount);
+    TEST_CHECK(!items[itemCount].succeeded && items[itemCount].pPCX == NULL, "batch on %u threads: loaded a missing file", threadCount);
+    test_check_batch(pImages, imageCount, items, itemCount, threadCount);
+
+    for (size_t i = 0; i < itemCount; ++i) {
+        free(items[i].pOut);
+    }
+
+    TEST_CHECK(drpcx_load_batch(NULL, 0, threadCount), "batch on %u threads: an empty batch failed", threadCount);
+    printf("%-48s checked\n", (threadCount == 0) ? "batch, one thread per processor" : (threadCount == 1) ? "batch, one thread" : "batch, three threads");
+}
+
+
+int main(int argc, char** argv)
+{
+    int isQuick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+    static const unsigned int formats[][2] = {{8, 1}, {8, 3}, {8, 4}, {1, 1}, {1, 2}, {1, 3}, {1, 4}, {2, 1}, {4, 1}};
+    static const unsigned int sizes[][2] = {{1, 1}, {37, 23}, {300, 7}, {1021, 301}};
+    size_t sizeCount = isQuick ? 3 : 4;
+
+    test_image* pImages = (test_image*)test_malloc(sizeof(test_image) * TEST_MAX_IMAGES);
+    size_t imageCount = 0;
+    unsigned int random = 1;
+
+    for (size_t iFormat = 0; iFormat < sizeof(formats)/sizeof(formats[0]); ++iFormat) {
+        unsigned int bpp = formats[iFormat][0];
+        unsigned int planes = formats[iFormat][1];
+        for (size_t iSize = 0; iSize < sizeCount; ++iSize) {
+            int variant = (int)(iSize % 2);
+            if (bpp == 8 && planes == 1) {
+                for (int palette = test_palette_256; palette <= test_palette_gray_trailing; ++palette) {
+                    test_build_image(&pImages[imageCount++], sizes[iSize][0], sizes[iSize][1], bpp, planes, (test_palette)palette, variant, 0, &random);
+                }
+            } else {
+                test_build_image(&pImages[imageCount++], sizes[iSize][0], sizes[iSize][1], bpp, planes, test_palette_none, variant, variant*2, &random);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < imageCount; ++i) {
+        test_image* pImage = &pImages[i];
+        snprintf(pImage->filePath, sizeof(pImage->filePath), "dr_pcx_test1.%zu.tmp.pcx", i);
+
+        FILE* pFile = fopen(pImage->filePath, "wb");
+        if (pFile == NULL || fwrite(pImage->pFile, 1, pImage->fileSize, pFile) != pImage->fileSize) {
+            printf("Failed to write %s.\n", pImage->filePath);
+            return 1;
+        }
+        fclose(pFile);
+    }
+
+    for (size_t i = 0; i < imageCount; ++i) {
+        test_load(&pImages[i]);
+        test_stream(&pImages[i]);
+        printf("%-48s checked\n", pImages[i].name);
+    }
+
+    test_batch(pImages, imageCount, 1);
+    test_batch(pImages, imageCount, 3);
+    test_batch(pImages, imageCount, 0);
+
+    for (size_t i = 0; i < imageCount; ++i) {
+        remove(pImages[i].filePath);
+        test_free_image(&pImages[i]);
+    }
+    free(pImages);
+
+    if (g_failCount > 0) {
+        printf("\n%d CHECKS FAILED\n", g_failCount);
+        return 1;
+    }
+
+    printf("\nALL CHECKS PASSED\n");
+    return 0;
+}
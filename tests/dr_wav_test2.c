@@ -0,0 +1,2107 @@
+// Conversion test and benchmark for dr_wav.
+//
+// This synthesizes a wav file in memory for every supported sample format and checks that reading it back as s16, s32 and f32,
+// interleaved and planar, gives the right values. It then times each conversion path at a few different read chunk sizes and
+// reports the throughput in megabytes of file data per second, followed by the same for drwav_write_f32().
+//
+// After that come checks that aren't timed: mixing down to mono and stereo, MS and IMA ADPCM decoding against reference
+// encoders, the headers written by drwav_write_raw() for RIFF and RF64 files, promotion of a RIFF file larger than 4GB to RF64
+// (without keeping the data in memory), reading and writing streams that can't be seeked, the chunk and metadata accessors
+// for RIFF and Wave64 files, and reading a temporary file through drwav_init_file_mapped() and the read-ahead thread.
+//
+// No test files are needed. The temporary file is written to the current directory and removed afterwards. Build and run with
+// something like this:
+//
+//   cc -std=c99 -O2 dr_wav_test2.c -o dr_wav_test2 -lm -lpthread && ./dr_wav_test2
+//
+// Pass --quick to use a short signal and a single timing run, which is enough to check for correctness. The exit code is
+// non-zero if any check fails.
+
+#define _POSIX_C_SOURCE 199309L
+
+#define DR_WAV_IMPLEMENTATION
+#include "../dr_wav.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#define TEST_SAMPLE_RATE    48000
+#define TEST_MAX_CHANNELS   8
+
+typedef enum
+{
+    test_format_u8,
+    test_format_s12,
+    test_format_s16,
+    test_format_s24,
+    test_format_s32,
+    test_format_f32,
+    test_format_f64,
+    test_format_alaw,
+    test_format_ulaw,
+    test_format_s24_extensible,
+    test_format_f32_extensible,
+    test_format_count
+} test_format;
+
+typedef struct
+{
+    const char* name;
+    unsigned int formatTag;
+    unsigned int bitsPerSample;     // The number of valid bits.
+    unsigned int bytesPerSample;    // The size of the container.
+    unsigned int channels;
+    int isExtensible;
+
+    // How far a decoded sample may be from the exact value of the encoded sample, on top of the precision of the output format.
+    // This is only non-zero for u8, which is mapped onto [-1, 1] by dr_wav rather than [-1, 127/128].
+    double tolerance;
+} test_format_info;
+
+static const test_format_info g_formats[test_format_count] = {
+    {"u8",          DR_WAVE_FORMAT_PCM,        8,  1, 2, 0, 1.0/127},
+    {"s12",         DR_WAVE_FORMAT_PCM,        12, 2, 2, 0, 0},
+    {"s16",         DR_WAVE_FORMAT_PCM,        16, 2, 2, 0, 0},
+    {"s24",         DR_WAVE_FORMAT_PCM,        24, 3, 2, 0, 0},
+    {"s32",         DR_WAVE_FORMAT_PCM,        32, 4, 2, 0, 0},
+    {"f32",         DR_WAVE_FORMAT_IEEE_FLOAT, 32, 4, 2, 0, 0},
+    {"f64",         DR_WAVE_FORMAT_IEEE_FLOAT, 64, 8, 2, 0, 0},
+    {"alaw",        DR_WAVE_FORMAT_ALAW,       8,  1, 2, 0, 0},
+    {"ulaw",        DR_WAVE_FORMAT_MULAW,      8,  1, 2, 0, 0},
+    {"s24 ext 5.1", DR_WAVE_FORMAT_PCM,        24, 3, 6, 1, 0},
+    {"f32 ext 7.1", DR_WAVE_FORMAT_IEEE_FLOAT, 32, 4, 8, 1, 0},
+};
+
+typedef enum
+{
+    test_output_s16,
+    test_output_s16_planar,
+    test_output_s32,
+    test_output_f32,
+    test_output_f32_planar,
+    test_output_count
+} test_output;
+
+static const char* g_outputNames[test_output_count] = {"s16", "s16 planar", "s32", "f32", "f32 planar"};
+
+static int g_failCount = 0;
+
+#define TEST_CHECK(condition, ...)      \
+    do {                                \
+        if (!(condition)) {             \
+            printf("FAILED: ");         \
+            printf(__VA_ARGS__);        \
+            printf("\n");               \
+            g_failCount += 1;           \
+        }                               \
+    } while (0)
+
+
+static double test_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 0.000000001;
+}
+
+
+//// G.711 ////
+//
+// These are the reference algorithms from the ITU-T/Sun implementation. They're kept separate from the tables in dr_wav so the
+// tables are tested against something independent.
+
+static int g711_search(int value, const int* pTable, int size)
+{
+    for (int i = 0; i < size; ++i) {
+        if (value <= pTable[i]) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+static unsigned char g711_linear_to_alaw(int pcm)
+{
+    static const int segEnd[8] = {0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF};
+
+    int mask;
+    pcm >>= 3;
+    if (pcm >= 0) {
+        mask = 0xD5;
+    } else {
+        mask = 0x55;
+        pcm = -pcm - 1;
+    }
+
+    int seg = g711_search(pcm, segEnd, 8);
+    if (seg >= 8) {
+        return (unsigned char)(0x7F ^ mask);
+    }
+
+    int aval = seg << 4;
+    aval |= (seg < 2) ? ((pcm >> 1) & 0xF) : ((pcm >> seg) & 0xF);
+    return (unsigned char)(aval ^ mask);
+}
+
+static int g711_alaw_to_linear(unsigned char a)
+{
+    a ^= 0x55;
+
+    int t = (a & 0xF) << 4;
+    int seg = (a & 0x70) >> 4;
+    switch (seg)
+    {
+        case 0:  t += 8; break;
+        case 1:  t += 0x108; break;
+        default: t += 0x108; t <<= seg - 1; break;
+    }
+
+    return (a & 0x80) ? t : -t;
+}
+
+static unsigned char g711_linear_to_ulaw(int pcm)
+{
+    static const int segEnd[8] = {0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF};
+
+    int mask;
+    pcm >>= 2;
+    if (pcm < 0) {
+        pcm = -pcm;
+        mask = 0x7F;
+    } else {
+        mask = 0xFF;
+    }
+
+    if (pcm > 8159) {
+        pcm = 8159;
+    }
+
+    pcm += 0x84 >> 2;
+
+    int seg = g711_search(pcm, segEnd, 8);
+    if (seg >= 8) {
+        return (unsigned char)(0x7F ^ mask);
+    }
+
+    int uval = (seg << 4) | ((pcm >> (seg + 1)) & 0xF);
+    return (unsigned char)(uval ^ mask);
+}
+
+static int g711_ulaw_to_linear(unsigned char u)
+{
+    u = ~u;
+
+    int t = ((u & 0xF) << 3) + 0x84;
+    t <<= (u & 0x70) >> 4;
+
+    return (u & 0x80) ? (0x84 - t) : (t - 0x84);
+}
+
+
+//// Synthesis ////
+
+// A sweep with some noise on top, plus full scale values and silence at regular intervals so the clamping and rounding edge
+// cases get hit in every format.
+static double test_signal(size_t iFrame, unsigned int iChannel, unsigned int* pRandom)
+{
+    switch (iFrame % 997)
+    {
+        case 0: return  1.0;
+        case 1: return -1.0;
+        case 2: return  0.0;
+        default: break;
+    }
+
+    *pRandom = *pRandom * 1664525 + 1013904223;
+    double noise = ((*pRandom >> 8) / 16777216.0) * 2 - 1;
+
+    double t = (double)iFrame / TEST_SAMPLE_RATE;
+    double phase = 2 * 3.14159265358979323846 * (50 + 2000*t) * t * (1 + iChannel*0.25);
+    return 0.9*sin(phase) + 0.1*noise;
+}
+
+static long long test_quantize(double x, unsigned int bits)
+{
+    double scale = (double)(1LL << (bits - 1));
+    double y = floor(x*scale + 0.5);
+    if (y < -scale) {
+        y = -scale;
+    }
+    if (y > scale - 1) {
+        y = scale - 1;
+    }
+
+    return (long long)y;
+}
+
+static void test_put_u16(unsigned char* p, unsigned int x)
+{
+    p[0] = (unsigned char)(x >> 0);
+    p[1] = (unsigned char)(x >> 8);
+}
+
+static void test_put_u32(unsigned char* p, unsigned int x)
+{
+    p[0] = (unsigned char)(x >>  0);
+    p[1] = (unsigned char)(x >>  8);
+    p[2] = (unsigned char)(x >> 16);
+    p[3] = (unsigned char)(x >> 24);
+}
+
+// Encodes one sample in the given format, returning the exact value it represents, scaled to [-1, 1].
+static double test_encode_sample(const test_format_info* pFormat, double x, unsigned char* pOut)
+{
+    if (pFormat->formatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
+        if (pFormat->bytesPerSample == 4) {
+            float f = (float)x;
+            memcpy(pOut, &f, 4);
+            return f;
+        } else {
+            memcpy(pOut, &x, 8);
+            return x;
+        }
+    }
+
+    if (pFormat->formatTag == DR_WAVE_FORMAT_ALAW) {
+        *pOut = g711_linear_to_alaw((int)test_quantize(x, 16));
+        return g711_alaw_to_linear(*pOut) / 32768.0;
+    }
+
+    if (pFormat->formatTag == DR_WAVE_FORMAT_MULAW) {
+        *pOut = g711_linear_to_ulaw((int)test_quantize(x, 16));
+        return g711_ulaw_to_linear(*pOut) / 32768.0;
+    }
+
+    long long q = test_quantize(x, pFormat->bitsPerSample);
+    double value = (double)q / (double)(1LL << (pFormat->bitsPerSample - 1));
+
+    if (pFormat->bitsPerSample == 8) {
+        *pOut = (unsigned char)(q + 128);
+        return value;
+    }
+
+    // Samples that don't fill their container are left justified.
+    unsigned long long bits = (unsigned long long)q << (pFormat->bytesPerSample*8 - pFormat->bitsPerSample);
+    for (unsigned int i = 0; i < pFormat->bytesPerSample; ++i) {
+        pOut[i] = (unsigned char)(bits >> (i*8));
+    }
+
+    return value;
+}
+
+// Builds a complete wav file in memory. <pExpected> receives the exact value of each encoded sample.
+static unsigned char* test_synthesize(const test_format_info* pFormat, size_t frameCount, double* pExpected, size_t* pFileSizeOut)
+{
+    unsigned int blockAlign = pFormat->bytesPerSample * pFormat->channels;
+    unsigned int fmtSize = pFormat->isExtensible ? 40 : ((pFormat->formatTag == DR_WAVE_FORMAT_PCM) ? 16 : 18);
+    size_t dataSize = frameCount * blockAlign;
+    size_t fileSize = 12 + 8 + fmtSize + 8 + dataSize;
+
+    unsigned char* pFile = (unsigned char*)malloc(fileSize);
+    if (pFile == NULL) {
+        return NULL;
+    }
+
+    unsigned char* p = pFile;
+    memcpy(p, "RIFF", 4); test_put_u32(p + 4, (unsigned int)(fileSize - 8)); memcpy(p + 8, "WAVE", 4);
+    p += 12;
+
+    memcpy(p, "fmt ", 4); test_put_u32(p + 4, fmtSize);
+    test_put_u16(p +  8, pFormat->isExtensible ? DR_WAVE_FORMAT_EXTENSIBLE : pFormat->formatTag);
+    test_put_u16(p + 10, pFormat->channels);
+    test_put_u32(p + 12, TEST_SAMPLE_RATE);
+    test_put_u32(p + 16, TEST_SAMPLE_RATE * blockAlign);
+    test_put_u16(p + 20, blockAlign);
+    test_put_u16(p + 22, pFormat->bytesPerSample * 8);
+    if (fmtSize > 16) {
+        test_put_u16(p + 24, fmtSize - 18);
+    }
+    if (pFormat->isExtensible) {
+        static const unsigned char subformatTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+        test_put_u16(p + 26, pFormat->bitsPerSample);
+        test_put_u32(p + 28, (pFormat->channels == 6) ? 0x3F : 0x63F);
+        test_put_u16(p + 32, pFormat->formatTag);
+        memcpy(p + 34, subformatTail, sizeof(subformatTail));
+    }
+    p += 8 + fmtSize;
+
+    memcpy(p, "data", 4); test_put_u32(p + 4, (unsigned int)dataSize);
+    p += 8;
+
+    unsigned int random = 1;
+    for (size_t iFrame = 0; iFrame < frameCount; ++iFrame) {
+        for (unsigned int iChannel = 0; iChannel < pFormat->channels; ++iChannel) {
+            double x = test_signal(iFrame, iChannel, &random);
+            *pExpected++ = test_encode_sample(pFormat, x, p);
+            p += pFormat->bytesPerSample;
+        }
+    }
+
+    *pFileSizeOut = fileSize;
+    return pFile;
+}
+
+
+//// Reading ////
+
+// Reads the whole file with the given output path, <chunkFrames> at a time, converting everything to float for checking.
+static size_t test_read_all(drwav* pWav, test_output output, size_t chunkFrames, void* pBuffer, float** ppPlanar)
+{
+    unsigned int channels = pWav->channels;
+    size_t totalFrames = 0;
+    for (;;)
+    {
+        size_t framesRead = 0;
+        switch (output)
+        {
+            case test_output_s16:
+            {
+                framesRead = drwav_read_s16(pWav, chunkFrames * channels, (int16_t*)pBuffer + totalFrames*channels) / channels;
+            } break;
+
+            case test_output_s16_planar:
+            {
+                // The planar buffers are big enough for floats so they're reused for s16.
+                int16_t* ppOut[TEST_MAX_CHANNELS];
+                for (unsigned int c = 0; c < channels; ++c) {
+                    ppOut[c] = (int16_t*)ppPlanar[c] + totalFrames;
+                }
+                framesRead = drwav_read_s16_planar(pWav, chunkFrames, ppOut);
+            } break;
+
+            case test_output_s32:
+            {
+                framesRead = drwav_read_s32(pWav, chunkFrames * channels, (int32_t*)pBuffer + totalFrames*channels) / channels;
+            } break;
+
+            case test_output_f32:
+            {
+                framesRead = drwav_read_f32(pWav, chunkFrames * channels, (float*)pBuffer + totalFrames*channels) / channels;
+            } break;
+
+            case test_output_f32_planar:
+            {
+                float* ppOut[TEST_MAX_CHANNELS];
+                for (unsigned int c = 0; c < channels; ++c) {
+                    ppOut[c] = ppPlanar[c] + totalFrames;
+                }
+                framesRead = drwav_read_f32_planar(pWav, chunkFrames, ppOut);
+            } break;
+
+            default: break;
+        }
+
+        totalFrames += framesRead;
+        if (framesRead < chunkFrames) {
+            break;
+        }
+    }
+
+    return totalFrames;
+}
+
+static double test_get_sample(test_output output, const void* pBuffer, float** ppPlanar, unsigned int channels, size_t iFrame, unsigned int iChannel)
+{
+    switch (output)
+    {
+        case test_output_s16:        return ((const int16_t*)pBuffer)[iFrame*channels + iChannel] / 32768.0;
+        case test_output_s16_planar: return ((const int16_t*)ppPlanar[iChannel])[iFrame] / 32768.0;
+        case test_output_s32:        return ((const int32_t*)pBuffer)[iFrame*channels + iChannel] / 2147483648.0;
+        case test_output_f32:        return ((const float*)pBuffer)[iFrame*channels + iChannel];
+        case test_output_f32_planar: return ppPlanar[iChannel][iFrame];
+        default: return 0;
+    }
+}
+
+static const size_t g_chunkSizes[] = {16, 256, 4096, 65536};
+#define TEST_CHUNK_SIZE_COUNT   (sizeof(g_chunkSizes) / sizeof(g_chunkSizes[0]))
+
+static void test_format_read(const test_format_info* pFormat, size_t frameCount, int timingRuns)
+{
+    size_t sampleCount = frameCount * pFormat->channels;
+    double* pExpected = (double*)malloc(sampleCount * sizeof(double));
+    void* pBuffer = malloc(sampleCount * sizeof(float));
+    void* pFirst  = malloc(sampleCount * sizeof(float));
+    float* ppPlanar[TEST_MAX_CHANNELS];
+    for (unsigned int c = 0; c < pFormat->channels; ++c) {
+        ppPlanar[c] = (float*)malloc(frameCount * sizeof(float));
+    }
+
+    size_t fileSize;
+    unsigned char* pFile = test_synthesize(pFormat, frameCount, pExpected, &fileSize);
+    if (pFile == NULL || pExpected == NULL || pBuffer == NULL || pFirst == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    for (int iOutput = 0; iOutput < test_output_count; ++iOutput)
+    {
+        test_output output = (test_output)iOutput;
+        double seconds[TEST_CHUNK_SIZE_COUNT];
+        double maxError = 0;
+
+        for (size_t iChunk = 0; iChunk < TEST_CHUNK_SIZE_COUNT; ++iChunk)
+        {
+            seconds[iChunk] = 1e30;
+            for (int iRun = 0; iRun < timingRuns; ++iRun)
+            {
+                drwav wav;
+                if (!drwav_init_memory(&wav, pFile, fileSize)) {
+                    TEST_CHECK(0, "%s: drwav_init_memory()", pFormat->name);
+                    goto done;
+                }
+
+                double t = test_time();
+                size_t framesRead = test_read_all(&wav, output, g_chunkSizes[iChunk], pBuffer, ppPlanar);
+                t = test_time() - t;
+                drwav_uninit(&wav);
+
+                if (seconds[iChunk] > t) {
+                    seconds[iChunk] = t;
+                }
+
+                TEST_CHECK(framesRead == frameCount, "%s -> %s: read %zu frames, expected %zu", pFormat->name, g_outputNames[output], framesRead, frameCount);
+            }
+
+            // Accuracy against the exact value of each encoded sample. Anything within the precision of the output format
+            // is accepted, since the exact rounding of each path is covered by the checks below.
+            int isS16 = (output == test_output_s16 || output == test_output_s16_planar);
+            int isPlanar = (output == test_output_s16_planar || output == test_output_f32_planar);
+            double outputPrecision = isS16 ? (1.0 / 32768) : 0.0000002;
+            double tolerance = outputPrecision + pFormat->tolerance;
+            for (size_t iFrame = 0; iFrame < frameCount; ++iFrame) {
+                for (unsigned int iChannel = 0; iChannel < pFormat->channels; ++iChannel) {
+                    double error = fabs(test_get_sample(output, pBuffer, ppPlanar, pFormat->channels, iFrame, iChannel) - pExpected[iFrame*pFormat->channels + iChannel]);
+                    if (maxError < error) {
+                        maxError = error;
+                    }
+                }
+            }
+
+            TEST_CHECK(maxError <= tolerance, "%s -> %s: error of %g exceeds %g", pFormat->name, g_outputNames[output], maxError, tolerance);
+
+            // Every chunk size must give exactly the same result, and so must planar and interleaved reads. Each planar output
+            // follows the interleaved output of the same type.
+            if (output == test_output_s16_planar) {
+                for (size_t iFrame = 0; iFrame < frameCount; ++iFrame) {
+                    for (unsigned int iChannel = 0; iChannel < pFormat->channels; ++iChannel) {
+                        ((int16_t*)pBuffer)[iFrame*pFormat->channels + iChannel] = ((int16_t*)ppPlanar[iChannel])[iFrame];
+                    }
+                }
+            }
+            if (output == test_output_f32_planar) {
+                for (size_t iFrame = 0; iFrame < frameCount; ++iFrame) {
+                    for (unsigned int iChannel = 0; iChannel < pFormat->channels; ++iChannel) {
+                        ((float*)pBuffer)[iFrame*pFormat->channels + iChannel] = ppPlanar[iChannel][iFrame];
+                    }
+                }
+            }
+
+            size_t bytesPerOutputSample = isS16 ? 2 : 4;
+            if (iChunk == 0 && !isPlanar) {
+                memcpy(pFirst, pBuffer, sampleCount * bytesPerOutputSample);
+            } else {
+                TEST_CHECK(memcmp(pFirst, pBuffer, sampleCount * bytesPerOutputSample) == 0, "%s -> %s: %zu frame chunks give a different result", pFormat->name, g_outputNames[output], g_chunkSizes[iChunk]);
+            }
+        }
+
+        printf("%-12s -> %-10s", pFormat->name, g_outputNames[output]);
+        for (size_t iChunk = 0; iChunk < TEST_CHUNK_SIZE_COUNT; ++iChunk) {
+            printf(" %9.1f", (fileSize / seconds[iChunk]) / 1000000.0);
+        }
+        printf("   max error %.3g\n", maxError);
+    }
+
+done:
+    free(pFile);
+    free(pExpected);
+    free(pBuffer);
+    free(pFirst);
+    for (unsigned int c = 0; c < pFormat->channels; ++c) {
+        free(ppPlanar[c]);
+    }
+}
+
+
+//// Downmixing ////
+
+// The weight of each input channel in each output channel for the layouts used by the tests: stereo, 5.1 and 7.1, all in the
+// order of the channel mask. Mono is copied to both sides.
+static void test_get_downmix_weights(unsigned int channels, unsigned int outputChannels, double* pWeights)
+{
+    const double h = 0.70710678;
+    const double speakers[8][2] = {{1, 0}, {0, 1}, {h, h}, {0, 0}, {h, 0}, {0, h}, {h, 0}, {0, h}};
+
+    if (channels == 1) {
+        for (unsigned int o = 0; o < outputChannels; ++o) {
+            pWeights[o] = 1;
+        }
+        return;
+    }
+
+    for (unsigned int c = 0; c < channels; ++c) {
+        if (outputChannels == 1) {
+            pWeights[c] = (speakers[c][0] + speakers[c][1]) / 2;
+        } else {
+            pWeights[c*2 + 0] = speakers[c][0];
+            pWeights[c*2 + 1] = speakers[c][1];
+        }
+    }
+
+    double maxSum = 0;
+    for (unsigned int o = 0; o < outputChannels; ++o) {
+        double sum = 0;
+        for (unsigned int c = 0; c < channels; ++c) {
+            sum += pWeights[c*outputChannels + o];
+        }
+        if (maxSum < sum) {
+            maxSum = sum;
+        }
+    }
+
+    if (maxSum > 1) {
+        for (unsigned int i = 0; i < channels*outputChannels; ++i) {
+            pWeights[i] /= maxSum;
+        }
+    }
+}
+
+// Checks drwav_read_f32_downmixed() to mono and stereo against mixing the exact samples, read all at once and in chunks.
+static void test_downmix(const test_format_info* pFormat, size_t frameCount)
+{
+    size_t sampleCount = frameCount * pFormat->channels;
+    double* pExpected = (double*)malloc(sampleCount * sizeof(double));
+    float* pMixed  = (float*)malloc(frameCount * 2 * sizeof(float));
+    float* pChunks = (float*)malloc(frameCount * 2 * sizeof(float));
+    if (pExpected == NULL || pMixed == NULL || pChunks == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    size_t fileSize;
+    unsigned char* pFile = test_synthesize(pFormat, frameCount, pExpected, &fileSize);
+    if (pFile == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    for (unsigned int outputChannels = 1; outputChannels <= 2; ++outputChannels)
+    {
+        drwav wav;
+        if (!drwav_init_memory(&wav, pFile, fileSize)) {
+            TEST_CHECK(0, "%s -> downmix: drwav_init_memory()", pFormat->name);
+            break;
+        }
+
+        size_t framesRead = drwav_read_f32_downmixed(&wav, outputChannels, frameCount, pMixed);
+        TEST_CHECK(framesRead == frameCount, "%s -> downmix x%u: read %zu frames, expected %zu", pFormat->name, outputChannels, framesRead, frameCount);
+
+        // Odd chunk sizes so the chunks don't line up with the blocks the mix is done in.
+        drwav_seek(&wav, 0);
+        size_t chunkFramesRead = 0;
+        for (size_t chunkFrames = 1; chunkFramesRead < frameCount; chunkFrames = (chunkFrames*3 + 1) % 997) {
+            size_t n = drwav_read_f32_downmixed(&wav, outputChannels, chunkFrames, pChunks + chunkFramesRead*outputChannels);
+            chunkFramesRead += n;
+            if (n < chunkFrames) {
+                break;
+            }
+        }
+
+        TEST_CHECK(chunkFramesRead == frameCount && memcmp(pMixed, pChunks, frameCount*outputChannels*sizeof(float)) == 0, "%s -> downmix x%u: reading in chunks gives a different result", pFormat->name, outputChannels);
+        TEST_CHECK(drwav_read_f32_downmixed(&wav, 3, 1, pMixed) == 0, "%s -> downmix x3: should fail", pFormat->name);
+        drwav_uninit(&wav);
+
+        double weights[TEST_MAX_CHANNELS * 2];
+        test_get_downmix_weights(pFormat->channels, outputChannels, weights);
+
+        double maxError = 0;
+        for (size_t iFrame = 0; iFrame < framesRead; ++iFrame) {
+            for (unsigned int o = 0; o < outputChannels; ++o) {
+                double sum = 0;
+                for (unsigned int c = 0; c < pFormat->channels; ++c) {
+                    sum += pExpected[iFrame*pFormat->channels + c] * weights[c*outputChannels + o];
+                }
+
+                double error = fabs(pMixed[iFrame*outputChannels + o] - sum);
+                if (maxError < error) {
+                    maxError = error;
+                }
+            }
+        }
+
+        double tolerance = 0.000001 + pFormat->tolerance;
+        TEST_CHECK(maxError <= tolerance, "%s -> downmix x%u: error of %g exceeds %g", pFormat->name, outputChannels, maxError, tolerance);
+    }
+
+    printf("%-12s -> downmix       checked\n", pFormat->name);
+
+    free(pFile);
+    free(pExpected);
+    free(pMixed);
+    free(pChunks);
+}
+
+
+//// Writing ////
+
+typedef struct
+{
+    unsigned char* pData;
+    size_t dataSize;
+    size_t dataCapacity;
+    size_t cursor;
+} test_memory_writer;
+
+static size_t test_on_write(void* pUserData, const void* pData, size_t bytesToWrite)
+{
+    test_memory_writer* pWriter = (test_memory_writer*)pUserData;
+    if (pWriter->cursor + bytesToWrite > pWriter->dataCapacity) {
+        return 0;
+    }
+
+    memcpy(pWriter->pData + pWriter->cursor, pData, bytesToWrite);
+    pWriter->cursor += bytesToWrite;
+    if (pWriter->dataSize < pWriter->cursor) {
+        pWriter->dataSize = pWriter->cursor;
+    }
+
+    return bytesToWrite;
+}
+
+static int test_on_seek(void* pUserData, int64_t offset, drwav_seek_origin origin)
+{
+    test_memory_writer* pWriter = (test_memory_writer*)pUserData;
+    int64_t newCursor = (origin == drwav_seek_origin_start) ? offset : (int64_t)pWriter->cursor + offset;
+    if (newCursor < 0 || (size_t)newCursor > pWriter->dataSize) {
+        return 0;
+    }
+
+    pWriter->cursor = (size_t)newCursor;
+    return 1;
+}
+
+static void test_format_write(unsigned int formatTag, unsigned int bitsPerSample, int dither, const float* pSamples, size_t frameCount, int timingRuns)
+{
+    unsigned int channels = 2;
+    size_t sampleCount = frameCount * channels;
+
+    test_memory_writer writer;
+    writer.dataCapacity = 1024 + sampleCount * (bitsPerSample / 8);
+    writer.pData = (unsigned char*)malloc(writer.dataCapacity);
+
+    float* pReadBack = (float*)malloc(sampleCount * sizeof(float));
+    if (writer.pData == NULL || pReadBack == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%s%u%s", (formatTag == DR_WAVE_FORMAT_IEEE_FLOAT) ? "f" : "s", bitsPerSample, dither ? " dither" : "");
+
+    double seconds[TEST_CHUNK_SIZE_COUNT];
+    for (size_t iChunk = 0; iChunk < TEST_CHUNK_SIZE_COUNT; ++iChunk)
+    {
+        seconds[iChunk] = 1e30;
+        for (int iRun = 0; iRun < timingRuns; ++iRun)
+        {
+            writer.dataSize = 0;
+            writer.cursor = 0;
+
+            drwav_data_format format;
+            format.container = drwav_container_riff;
+            format.format = formatTag;
+            format.channels = channels;
+            format.sampleRate = TEST_SAMPLE_RATE;
+            format.bitsPerSample = bitsPerSample;
+
+            drwav wav;
+            if (!drwav_init_write(&wav, &format, test_on_write, test_on_seek, &writer)) {
+                TEST_CHECK(0, "f32 -> %s: drwav_init_write()", name);
+                goto done;
+            }
+
+            drwav_set_write_dither(&wav, dither);
+
+            double t = test_time();
+            size_t samplesWritten = 0;
+            while (samplesWritten < sampleCount) {
+                size_t samplesToWrite = g_chunkSizes[iChunk] * channels;
+                if (samplesToWrite > sampleCount - samplesWritten) {
+                    samplesToWrite = sampleCount - samplesWritten;
+                }
+
+                size_t n = drwav_write_f32(&wav, samplesToWrite, pSamples + samplesWritten);
+                samplesWritten += n;
+                if (n < samplesToWrite) {
+                    break;
+                }
+            }
+            drwav_uninit(&wav);
+            t = test_time() - t;
+
+            if (seconds[iChunk] > t) {
+                seconds[iChunk] = t;
+            }
+
+            TEST_CHECK(samplesWritten == sampleCount, "f32 -> %s: wrote %zu samples, expected %zu", name, samplesWritten, sampleCount);
+        }
+    }
+
+    // Read the last file back and check it. Rounding should never be more than half a step out, and triangular dither adds
+    // at most one more step.
+    {
+        drwav wav;
+        TEST_CHECK(drwav_init_memory(&wav, writer.pData, writer.dataSize), "f32 -> %s: drwav_init_memory()", name);
+        size_t samplesRead = drwav_read_f32(&wav, sampleCount, pReadBack);
+        drwav_uninit(&wav);
+        TEST_CHECK(samplesRead == sampleCount, "f32 -> %s: read back %zu samples, expected %zu", name, samplesRead, sampleCount);
+
+        double step = (formatTag == DR_WAVE_FORMAT_IEEE_FLOAT) ? 0 : 1.0 / (double)(1LL << (bitsPerSample - 1));
+        double tolerance = step * (dither ? 1.5 : 0.5) + 0.0000002;
+        double maxError = 0;
+        for (size_t i = 0; i < samplesRead; ++i) {
+            // Full scale positive values can't be represented and are clamped to the largest value below it.
+            double expected = pSamples[i];
+            if (expected > 1 - step) {
+                expected = 1 - step;
+            }
+
+            double error = fabs(pReadBack[i] - expected);
+            if (maxError < error) {
+                maxError = error;
+            }
+        }
+
+        TEST_CHECK(maxError <= tolerance, "f32 -> %s: error of %g exceeds %g", name, maxError, tolerance);
+
+        printf("f32          -> %-10s", name);
+        for (size_t iChunk = 0; iChunk < TEST_CHUNK_SIZE_COUNT; ++iChunk) {
+            printf(" %9.1f", (writer.dataSize / seconds[iChunk]) / 1000000.0);
+        }
+        printf("   max error %.3g\n", maxError);
+    }
+
+done:
+    free(writer.pData);
+    free(pReadBack);
+}
+
+
+//// Chunk building ////
+
+// Appends a chunk to a RIFF file being built in <pWriter>, adding the pad byte for odd sizes. <sizeField> is the size stored in
+// the chunk header, which is normally <dataSize> but can be 0xFFFFFFFF for streamed data.
+static void test_write_chunk(test_memory_writer* pWriter, const char* id, const void* pData, size_t dataSize, unsigned int sizeField)
+{
+    unsigned char header[8];
+    memcpy(header, id, 4);
+    test_put_u32(header + 4, sizeField);
+    test_on_write(pWriter, header, 8);
+    test_on_write(pWriter, pData, dataSize);
+    if (dataSize % 2 != 0) {
+        test_on_write(pWriter, "", 1);
+    }
+}
+
+static void test_memory_writer_init(test_memory_writer* pWriter, size_t capacity)
+{
+    pWriter->pData = (unsigned char*)malloc(capacity);
+    pWriter->dataSize = 0;
+    pWriter->dataCapacity = capacity;
+    pWriter->cursor = 0;
+    if (pWriter->pData == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+}
+
+// Starts a RIFF file in <pWriter>. test_finish_riff() fills in the size.
+static void test_begin_riff(test_memory_writer* pWriter)
+{
+    test_on_write(pWriter, "RIFF\0\0\0\0WAVE", 12);
+}
+
+static void test_finish_riff(test_memory_writer* pWriter)
+{
+    test_put_u32(pWriter->pData + 4, (unsigned int)(pWriter->dataSize - 8));
+}
+
+
+static uint64_t test_get_u64(const unsigned char* p)
+{
+    uint64_t x = 0;
+    for (int i = 7; i >= 0; --i) {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+static unsigned int test_get_u32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// Finds a chunk in a RIFF or RF64 file, returning a pointer to it's data or null if it's not there.
+static const unsigned char* test_find_chunk(const unsigned char* pFile, size_t fileSize, const char* id)
+{
+    size_t cursor = 12;
+    while (cursor + 8 <= fileSize) {
+        if (memcmp(pFile + cursor, id, 4) == 0) {
+            return pFile + cursor + 8;
+        }
+
+        unsigned int size = test_get_u32(pFile + cursor + 4);
+        if (size == 0xFFFFFFFF) {
+            break;
+        }
+        cursor += 8 + size + (size % 2);
+    }
+
+    return NULL;
+}
+
+
+//// Non-seekable streams ////
+
+typedef struct
+{
+    const unsigned char* pData;
+    size_t dataSize;
+    size_t cursor;
+} test_memory_reader;
+
+static size_t test_on_read(void* pUserData, void* pBufferOut, size_t bytesToRead)
+{
+    test_memory_reader* pReader = (test_memory_reader*)pUserData;
+    if (bytesToRead > pReader->dataSize - pReader->cursor) {
+        bytesToRead = pReader->dataSize - pReader->cursor;
+    }
+
+    memcpy(pBufferOut, pReader->pData + pReader->cursor, bytesToRead);
+    pReader->cursor += bytesToRead;
+    return bytesToRead;
+}
+
+// Initializes <pWav> for reading from memory without a seek callback, the same as reading from a pipe.
+static int test_init_non_seekable(drwav* pWav, test_memory_reader* pReader, const void* pData, size_t dataSize)
+{
+    pReader->pData = (const unsigned char*)pData;
+    pReader->dataSize = dataSize;
+    pReader->cursor = 0;
+    return drwav_init(pWav, test_on_read, NULL, pReader);
+}
+
+// Reads s16 samples until the end of the data, <chunkSamples> at a time.
+static size_t test_read_all_s16(drwav* pWav, size_t chunkSamples, int16_t* pSamplesOut, size_t sampleCapacity)
+{
+    size_t totalSamples = 0;
+    for (;;) {
+        size_t samplesToRead = chunkSamples;
+        if (samplesToRead > sampleCapacity - totalSamples) {
+            samplesToRead = sampleCapacity - totalSamples;
+        }
+
+        size_t samplesRead = drwav_read_s16(pWav, samplesToRead, pSamplesOut + totalSamples);
+        totalSamples += samplesRead;
+        if (samplesRead == 0 || samplesRead < samplesToRead) {
+            break;
+        }
+    }
+
+    return totalSamples;
+}
+
+static void test_non_seekable()
+{
+    unsigned int channels = 2;
+    size_t frameCount = 1001;
+    size_t sampleCount = frameCount * channels;
+
+    int16_t* pSamples  = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    int16_t* pReadBack = (int16_t*)malloc((sampleCount + 64) * sizeof(int16_t));
+    if (pSamples == NULL || pReadBack == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    unsigned int random = 1;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        pSamples[i] = (int16_t)test_quantize(test_signal(i / channels, i % channels, &random), 16);
+    }
+
+    // A file with chunks before and after the data, one with an odd size, and a known data size. The leading chunks have to
+    // be skipped by reading, and the trailing one must not be read as samples.
+    {
+        test_memory_writer writer;
+        test_memory_writer_init(&writer, 1024 + sampleCount*2);
+        test_begin_riff(&writer);
+
+        unsigned char fmt[16];
+        test_put_u16(fmt +  0, DR_WAVE_FORMAT_PCM);
+        test_put_u16(fmt +  2, channels);
+        test_put_u32(fmt +  4, TEST_SAMPLE_RATE);
+        test_put_u32(fmt +  8, TEST_SAMPLE_RATE * channels * 2);
+        test_put_u16(fmt + 12, channels * 2);
+        test_put_u16(fmt + 14, 16);
+
+        unsigned char junk[333];
+        memset(junk, 0x7F, sizeof(junk));
+
+        test_write_chunk(&writer, "LIST", junk, sizeof(junk), sizeof(junk));
+        test_write_chunk(&writer, "fmt ", fmt, sizeof(fmt), sizeof(fmt));
+        test_write_chunk(&writer, "JUNK", junk, 17, 17);
+        test_write_chunk(&writer, "data", pSamples, sampleCount*2, (unsigned int)(sampleCount*2));
+        test_write_chunk(&writer, "LIST", junk, sizeof(junk), sizeof(junk));
+        test_finish_riff(&writer);
+
+        drwav wav;
+        test_memory_reader reader;
+        if (test_init_non_seekable(&wav, &reader, writer.pData, writer.dataSize)) {
+            TEST_CHECK(wav.totalSampleCount == sampleCount, "non-seekable: total sample count is %llu, expected %zu", (unsigned long long)wav.totalSampleCount, sampleCount);
+            TEST_CHECK(drwav_seek(&wav, 0) == 0, "non-seekable: drwav_seek() succeeded without a seek callback");
+
+            size_t samplesRead = test_read_all_s16(&wav, 7, pReadBack, sampleCount + 64);
+            TEST_CHECK(samplesRead == sampleCount, "non-seekable: read %zu samples, expected %zu", samplesRead, sampleCount);
+            TEST_CHECK(samplesRead == sampleCount && memcmp(pReadBack, pSamples, sampleCount*2) == 0, "non-seekable: samples differ");
+            drwav_uninit(&wav);
+        } else {
+            TEST_CHECK(0, "non-seekable: drwav_init()");
+        }
+
+        free(writer.pData);
+    }
+
+    // Files written without a seek callback leave the sizes at 0xFFFFFFFF. Reading them back without a seek callback should
+    // give all of the data, with an unknown length. IEEE float is used so there's a "fact" chunk with an unknown frame count
+    // in front of the data as well.
+    for (int isFloat = 0; isFloat <= 1; ++isFloat)
+    {
+        const char* name = isFloat ? "f32" : "s16";
+        unsigned int bytesPerSample = isFloat ? 4 : 2;
+
+        test_memory_writer writer;
+        test_memory_writer_init(&writer, 1024 + sampleCount*bytesPerSample);
+
+        drwav_data_format format;
+        format.container = drwav_container_riff;
+        format.format = isFloat ? DR_WAVE_FORMAT_IEEE_FLOAT : DR_WAVE_FORMAT_PCM;
+        format.channels = channels;
+        format.sampleRate = TEST_SAMPLE_RATE;
+        format.bitsPerSample = bytesPerSample * 8;
+
+        drwav wav;
+        if (!drwav_init_write(&wav, &format, test_on_write, NULL, &writer)) {
+            TEST_CHECK(0, "non-seekable %s: drwav_init_write()", name);
+            free(writer.pData);
+            continue;
+        }
+
+        // Odd sized pieces so the write buffer gets flushed part way through a sample.
+        size_t samplesWritten = 0;
+        while (samplesWritten < sampleCount) {
+            size_t samplesToWrite = 333;
+            if (samplesToWrite > sampleCount - samplesWritten) {
+                samplesToWrite = sampleCount - samplesWritten;
+            }
+
+            if (isFloat) {
+                float f[333];
+                drwav_s16PCM_to_f32(samplesToWrite, pSamples + samplesWritten, f);
+                samplesWritten += drwav_write_f32(&wav, samplesToWrite, f);
+            } else {
+                samplesWritten += drwav_write(&wav, samplesToWrite, pSamples + samplesWritten);
+            }
+        }
+        drwav_uninit(&wav);
+
+        TEST_CHECK(memcmp(writer.pData + 4, "\xFF\xFF\xFF\xFF", 4) == 0, "non-seekable %s: RIFF size was written", name);
+        TEST_CHECK(memcmp(writer.pData + writer.dataSize - sampleCount*bytesPerSample - 8, "data\xFF\xFF\xFF\xFF", 8) == 0, "non-seekable %s: data size was written", name);
+
+        test_memory_reader reader;
+        if (test_init_non_seekable(&wav, &reader, writer.pData, writer.dataSize)) {
+            TEST_CHECK(wav.totalSampleCount == 0, "non-seekable %s: total sample count of a streamed file is %llu", name, (unsigned long long)wav.totalSampleCount);
+
+            size_t samplesRead = test_read_all_s16(&wav, 100, pReadBack, sampleCount + 64);
+            TEST_CHECK(samplesRead == sampleCount, "non-seekable %s: read %zu samples, expected %zu", name, samplesRead, sampleCount);
+            TEST_CHECK(samplesRead == sampleCount && memcmp(pReadBack, pSamples, sampleCount*2) == 0, "non-seekable %s: samples differ", name);
+            drwav_uninit(&wav);
+        } else {
+            TEST_CHECK(0, "non-seekable %s: drwav_init()", name);
+        }
+
+        free(writer.pData);
+    }
+
+    printf("non-seekable reads and writes checked\n");
+
+    free(pSamples);
+    free(pReadBack);
+}
+
+
+//// ADPCM ////
+//
+// The encoders below follow the Microsoft and IMA reference descriptions and keep track of what a decoder should reconstruct
+// from their output, which dr_wav has to match exactly. The signal is encoded block by block with the last block padded out
+// to a full block, so the frame count has to come from the "fact" chunk, or is cut short on a whole byte (or IMA group) and
+// has no "fact" chunk, so the frame count has to come from the size of the data.
+
+static const int g_msadpcmCoeffs[8][2] = {{256, 0}, {512, -256}, {0, 0}, {192, 64}, {240, 0}, {460, -208}, {392, -232}, {300, -100}};
+static const int g_msadpcmAdaptation[16] = {230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230};
+
+static const int g_imaIndexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+static const int g_imaStepTable[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static int test_clamp_s16(int x)
+{
+    return (x < -32768) ? -32768 : ((x > 32767) ? 32767 : x);
+}
+
+// Encodes a block of <framesPerBlock> frames. The predictor used by every channel is chosen by the caller so all of them get
+// used.
+static void test_msadpcm_encode_block(const int16_t* pSamples, unsigned int channels, size_t framesPerBlock, int predictor, unsigned char* pBlock, int16_t* pDecoded)
+{
+    int prev[2][2];
+    int delta[2];
+    for (unsigned int ch = 0; ch < channels; ++ch) {
+        // The header holds the first two frames, most recent first.
+        prev[ch][1] = pSamples[0*channels + ch];
+        prev[ch][0] = pSamples[1*channels + ch];
+        delta[ch] = 16 + 48*ch;
+
+        pBlock[ch] = (unsigned char)predictor;
+        test_put_u16(pBlock + channels*1 + ch*2, (unsigned int)delta[ch]);
+        test_put_u16(pBlock + channels*3 + ch*2, (unsigned int)prev[ch][0]);
+        test_put_u16(pBlock + channels*5 + ch*2, (unsigned int)prev[ch][1]);
+
+        pDecoded[0*channels + ch] = (int16_t)prev[ch][1];
+        pDecoded[1*channels + ch] = (int16_t)prev[ch][0];
+    }
+
+    unsigned char* pNibbles = pBlock + 7*channels;
+    for (size_t iSample = 2*channels; iSample < framesPerBlock*channels; ++iSample) {
+        unsigned int ch = (unsigned int)(iSample % channels);
+        const int* pCoeff = g_msadpcmCoeffs[predictor];
+
+        int prediction = (prev[ch][0]*pCoeff[0] + prev[ch][1]*pCoeff[1]) >> 8;
+        int error = pSamples[iSample] - prediction;
+        int q = (error + ((error >= 0) ? delta[ch]/2 : -delta[ch]/2)) / delta[ch];
+        q = (q < -8) ? -8 : ((q > 7) ? 7 : q);
+
+        int sample = test_clamp_s16(prediction + q*delta[ch]);
+        prev[ch][1] = prev[ch][0];
+        prev[ch][0] = sample;
+        pDecoded[iSample] = (int16_t)sample;
+
+        unsigned int nibble = (unsigned int)q & 0x0F;
+        delta[ch] = (g_msadpcmAdaptation[nibble] * delta[ch]) >> 8;
+        if (delta[ch] < 16) {
+            delta[ch] = 16;
+        }
+
+        size_t iNibble = iSample - 2*channels;
+        pNibbles[iNibble/2] |= (unsigned char)((iNibble % 2 == 0) ? (nibble << 4) : nibble);
+    }
+}
+
+// Encodes a block of <framesPerBlock> frames. The step index carries over from the previous block.
+static void test_ima_encode_block(const int16_t* pSamples, unsigned int channels, size_t framesPerBlock, int* pStepIndex, unsigned char* pBlock, int16_t* pDecoded)
+{
+    for (unsigned int ch = 0; ch < channels; ++ch) {
+        int predictor = pSamples[ch];
+        test_put_u16(pBlock + ch*4, (unsigned int)predictor);
+        pBlock[ch*4 + 2] = (unsigned char)pStepIndex[ch];
+        pDecoded[ch] = (int16_t)predictor;
+
+        for (size_t iFrame = 1; iFrame < framesPerBlock; ++iFrame) {
+            int step = g_imaStepTable[pStepIndex[ch]];
+            int diff = pSamples[iFrame*channels + ch] - predictor;
+
+            unsigned int nibble = 0;
+            if (diff < 0) {
+                nibble = 8;
+                diff = -diff;
+            }
+
+            int reconstructed = step >> 3;
+            if (diff >= step) { nibble |= 4; diff -= step; reconstructed += step; }
+            step >>= 1;
+            if (diff >= step) { nibble |= 2; diff -= step; reconstructed += step; }
+            step >>= 1;
+            if (diff >= step) { nibble |= 1;               reconstructed += step; }
+
+            predictor = test_clamp_s16((nibble & 8) ? predictor - reconstructed : predictor + reconstructed);
+            pDecoded[iFrame*channels + ch] = (int16_t)predictor;
+
+            pStepIndex[ch] += g_imaIndexTable[nibble];
+            pStepIndex[ch] = (pStepIndex[ch] < 0) ? 0 : ((pStepIndex[ch] > 88) ? 88 : pStepIndex[ch]);
+
+            // Groups of 8 frames are stored as 4 bytes per channel, low nibble first.
+            size_t iGroup = (iFrame - 1) / 8;
+            size_t iNibble = (iFrame - 1) % 8;
+            pBlock[4*channels + iGroup*4*channels + ch*4 + iNibble/2] |= (unsigned char)((iNibble % 2 == 0) ? nibble : (nibble << 4));
+        }
+    }
+}
+
+// Builds an ADPCM file of <frameCount> frames, writing the samples a decoder should produce to <pDecoded>.
+static void test_adpcm_synthesize(test_memory_writer* pWriter, int isMS, unsigned int channels, unsigned int blockAlign, size_t frameCount, int hasFact, int16_t* pDecoded)
+{
+    size_t framesPerBlock = isMS ? ((blockAlign - 7*channels) * 2) / channels + 2 : ((blockAlign - 4*channels) / (4*channels)) * 8 + 1;
+    size_t blockCount = (frameCount + framesPerBlock - 1) / framesPerBlock;
+
+    // The source is padded with silence out to a whole number of blocks.
+    int16_t* pSource = (int16_t*)calloc(blockCount * framesPerBlock * channels, sizeof(int16_t));
+    int16_t* pBlockDecoded = (int16_t*)malloc(framesPerBlock * channels * sizeof(int16_t));
+    unsigned char* pData = (unsigned char*)calloc(blockCount, blockAlign);
+    if (pSource == NULL || pBlockDecoded == NULL || pData == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    unsigned int random = 1;
+    for (size_t i = 0; i < frameCount * channels; ++i) {
+        pSource[i] = (int16_t)test_quantize(test_signal(i / channels, i % channels, &random), 16);
+    }
+
+    int stepIndex[2] = {0, 40};
+    for (size_t iBlock = 0; iBlock < blockCount; ++iBlock) {
+        const int16_t* pBlockSource = pSource + iBlock*framesPerBlock*channels;
+        unsigned char* pBlock = pData + iBlock*blockAlign;
+        if (isMS) {
+            test_msadpcm_encode_block(pBlockSource, channels, framesPerBlock, (int)(iBlock % 8), pBlock, pBlockDecoded);
+        } else {
+            test_ima_encode_block(pBlockSource, channels, framesPerBlock, stepIndex, pBlock, pBlockDecoded);
+        }
+
+        size_t framesInBlock = framesPerBlock;
+        if (framesInBlock > frameCount - iBlock*framesPerBlock) {
+            framesInBlock = frameCount - iBlock*framesPerBlock;
+        }
+        memcpy(pDecoded + iBlock*framesPerBlock*channels, pBlockDecoded, framesInBlock * channels * sizeof(int16_t));
+    }
+
+    // Without a "fact" chunk the data stops straight after the last frame.
+    size_t dataSize = blockCount * blockAlign;
+    if (!hasFact) {
+        size_t framesInLastBlock = frameCount - (blockCount - 1)*framesPerBlock;
+        size_t bytesInLastBlock = isMS ? 7*channels + ((framesInLastBlock - 2)*channels + 1) / 2 : 4*channels + ((framesInLastBlock - 1) / 8) * 4*channels;
+        dataSize = (blockCount - 1)*blockAlign + bytesInLastBlock;
+    }
+
+    unsigned char fmt[20 + 4 + 8*4];
+    unsigned int extraSize = isMS ? 4 + 8*4 : 2;
+    test_put_u16(fmt +  0, isMS ? DR_WAVE_FORMAT_ADPCM : DR_WAVE_FORMAT_DVI_ADPCM);
+    test_put_u16(fmt +  2, channels);
+    test_put_u32(fmt +  4, TEST_SAMPLE_RATE);
+    test_put_u32(fmt +  8, (unsigned int)((TEST_SAMPLE_RATE * (uint64_t)blockAlign) / framesPerBlock));
+    test_put_u16(fmt + 12, blockAlign);
+    test_put_u16(fmt + 14, 4);
+    test_put_u16(fmt + 16, extraSize);
+    test_put_u16(fmt + 18, (unsigned int)framesPerBlock);
+    if (isMS) {
+        test_put_u16(fmt + 20, 8);
+        for (int i = 0; i < 8; ++i) {
+            test_put_u16(fmt + 22 + i*4 + 0, (unsigned int)g_msadpcmCoeffs[i][0]);
+            test_put_u16(fmt + 22 + i*4 + 2, (unsigned int)g_msadpcmCoeffs[i][1]);
+        }
+    }
+
+    test_memory_writer_init(pWriter, 1024 + dataSize);
+    test_begin_riff(pWriter);
+    test_write_chunk(pWriter, "fmt ", fmt, 18 + extraSize, 18 + extraSize);
+    if (hasFact) {
+        unsigned char fact[4];
+        test_put_u32(fact, (unsigned int)frameCount);
+        test_write_chunk(pWriter, "fact", fact, 4, 4);
+    }
+    test_write_chunk(pWriter, "data", pData, dataSize, (unsigned int)dataSize);
+    test_finish_riff(pWriter);
+
+    free(pSource);
+    free(pBlockDecoded);
+    free(pData);
+}
+
+static void test_adpcm(int isMS, unsigned int channels, int hasFact)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s adpcm %s%s", isMS ? "ms" : "ima", (channels == 1) ? "mono" : "stereo", hasFact ? "" : " (no fact)");
+
+    unsigned int blockAlign = 256 * channels;
+    size_t frameCount = 12345;
+    size_t sampleCount = frameCount * channels;
+
+    // The reference samples and the output get some room at the end to catch reads past the last frame.
+    int16_t* pDecoded  = (int16_t*)calloc(sampleCount + 1024, sizeof(int16_t));
+    int16_t* pReadBack = (int16_t*)malloc((sampleCount + 1024) * sizeof(int16_t));
+    float*   pReadBackF32 = (float*)malloc(sampleCount * sizeof(float));
+    if (pDecoded == NULL || pReadBack == NULL || pReadBackF32 == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    test_memory_writer file;
+    test_adpcm_synthesize(&file, isMS, channels, blockAlign, frameCount, hasFact, pDecoded);
+
+    // Every read size has to give the same samples. Small sizes go through the per-block cache, larger ones decode in place.
+    static const size_t chunkSamples[] = {1, 3, 16, 1000, 1000000};
+    for (size_t iChunk = 0; iChunk < sizeof(chunkSamples)/sizeof(chunkSamples[0]); ++iChunk) {
+        drwav wav;
+        if (!drwav_init_memory(&wav, file.pData, file.dataSize)) {
+            TEST_CHECK(0, "%s: drwav_init_memory()", name);
+            goto done;
+        }
+
+        TEST_CHECK(wav.totalSampleCount == sampleCount, "%s: total sample count is %llu, expected %zu", name, (unsigned long long)wav.totalSampleCount, sampleCount);
+
+        size_t samplesRead = test_read_all_s16(&wav, chunkSamples[iChunk], pReadBack, sampleCount + 1024);
+        drwav_uninit(&wav);
+
+        TEST_CHECK(samplesRead == sampleCount, "%s: read %zu samples %zu at a time, expected %zu", name, samplesRead, chunkSamples[iChunk], sampleCount);
+        TEST_CHECK(samplesRead == sampleCount && memcmp(pReadBack, pDecoded, sampleCount*2) == 0, "%s: samples differ when read %zu at a time", name, chunkSamples[iChunk]);
+    }
+
+    // The float path decodes through s16.
+    {
+        drwav wav;
+        if (drwav_init_memory(&wav, file.pData, file.dataSize)) {
+            size_t samplesRead = drwav_read_f32(&wav, sampleCount, pReadBackF32);
+            drwav_uninit(&wav);
+
+            int isEqual = samplesRead == sampleCount;
+            for (size_t i = 0; isEqual && i < sampleCount; ++i) {
+                isEqual = pReadBackF32[i] == pDecoded[i] / 32768.0f;
+            }
+            TEST_CHECK(isEqual, "%s -> f32: samples differ", name);
+        }
+    }
+
+    // Seeking lands part way through a block and has to decode up to the sample.
+    {
+        drwav wav;
+        if (drwav_init_memory(&wav, file.pData, file.dataSize)) {
+            static const size_t seekFrames[] = {7000, 0, 1, 2, 3, 505, 1234, 12344, 500};
+            for (size_t iSeek = 0; iSeek < sizeof(seekFrames)/sizeof(seekFrames[0]); ++iSeek) {
+                size_t iSample = seekFrames[iSeek] * channels;
+                size_t samplesToRead = (sampleCount - iSample < 100) ? sampleCount - iSample : 100;
+
+                TEST_CHECK(drwav_seek(&wav, iSample), "%s: drwav_seek(%zu)", name, iSample);
+                size_t samplesRead = drwav_read_s16(&wav, samplesToRead, pReadBack);
+                TEST_CHECK(samplesRead == samplesToRead && memcmp(pReadBack, pDecoded + iSample, samplesToRead*2) == 0, "%s: samples differ after seeking to %zu", name, iSample);
+            }
+            drwav_uninit(&wav);
+        }
+    }
+
+    // Without a seek callback. When there's no "fact" chunk the data size is also marked as unknown, so decoding has to stop
+    // at the end of the stream rather than at a frame count. A streamed file has no pad byte since everything up to the end
+    // is data.
+    {
+        if (!hasFact) {
+            unsigned char* pDataChunk = (unsigned char*)test_find_chunk(file.pData, file.dataSize, "data");
+            file.dataSize = (size_t)(pDataChunk - file.pData) + test_get_u32(pDataChunk - 4);
+            test_put_u32(pDataChunk - 4, 0xFFFFFFFF);
+        }
+
+        drwav wav;
+        test_memory_reader reader;
+        if (test_init_non_seekable(&wav, &reader, file.pData, file.dataSize)) {
+            size_t samplesRead = test_read_all_s16(&wav, 1000, pReadBack, sampleCount + 1024);
+            drwav_uninit(&wav);
+
+            TEST_CHECK(samplesRead == sampleCount, "%s: read %zu samples without a seek callback, expected %zu", name, samplesRead, sampleCount);
+            TEST_CHECK(samplesRead == sampleCount && memcmp(pReadBack, pDecoded, sampleCount*2) == 0, "%s: samples differ without a seek callback", name);
+        } else {
+            TEST_CHECK(0, "%s: drwav_init() without a seek callback", name);
+        }
+    }
+
+    printf("%-32s checked\n", name);
+
+done:
+    free(file.pData);
+    free(pDecoded);
+    free(pReadBack);
+    free(pReadBackF32);
+}
+
+
+//// RF64 ////
+
+// Writes a file with drwav_write_raw() in odd sized pieces and checks the sizes and frame counts in the headers, including
+// the "ds64" chunk of RF64 files, and that the extensible format and "fact" chunk are used where they should be.
+static void test_write_raw(drwav_container container, unsigned int formatTag, unsigned int channels, unsigned int bitsPerSample)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s %s%u x%u drwav_write_raw()", (container == drwav_container_rf64) ? "rf64" : "riff", (formatTag == DR_WAVE_FORMAT_IEEE_FLOAT) ? "f" : "s", bitsPerSample, channels);
+
+    size_t frameCount = 777;
+    unsigned int blockAlign = (bitsPerSample/8) * channels;
+    size_t dataSize = frameCount * blockAlign;
+
+    unsigned char* pData = (unsigned char*)malloc(dataSize);
+    test_memory_writer writer;
+    test_memory_writer_init(&writer, 1024 + dataSize);
+    if (pData == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < dataSize; ++i) {
+        pData[i] = (unsigned char)(i * 7);
+    }
+    if (formatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
+        for (size_t i = 0; i < frameCount * channels; ++i) {
+            float x = (float)((int)(i % 200) - 100) / 128.0f;
+            memcpy(pData + i*4, &x, 4);
+        }
+    }
+
+    drwav_data_format format;
+    format.container = container;
+    format.format = formatTag;
+    format.channels = channels;
+    format.sampleRate = TEST_SAMPLE_RATE;
+    format.bitsPerSample = bitsPerSample;
+
+    drwav wav;
+    if (!drwav_init_write(&wav, &format, test_on_write, test_on_seek, &writer)) {
+        TEST_CHECK(0, "%s: drwav_init_write()", name);
+        goto done;
+    }
+
+    size_t bytesWritten = 0;
+    size_t pieceSize = 1;
+    while (bytesWritten < dataSize) {
+        if (pieceSize > dataSize - bytesWritten) {
+            pieceSize = dataSize - bytesWritten;
+        }
+        bytesWritten += drwav_write_raw(&wav, pData + bytesWritten, pieceSize);
+        pieceSize = pieceSize*3 + 1;
+    }
+
+    TEST_CHECK(wav.totalSampleCount == frameCount * channels, "%s: total sample count is %llu, expected %zu", name, (unsigned long long)wav.totalSampleCount, frameCount * channels);
+    drwav_uninit(&wav);
+
+    const unsigned char* pFile = writer.pData;
+    size_t fileSize = writer.dataSize;
+    const unsigned char* pFmt  = test_find_chunk(pFile, fileSize, "fmt ");
+    const unsigned char* pFact = test_find_chunk(pFile, fileSize, "fact");
+    const unsigned char* pDs64 = test_find_chunk(pFile, fileSize, "ds64");
+    const unsigned char* pDataChunk = test_find_chunk(pFile, fileSize, "data");
+    if (pFmt == NULL || pDataChunk == NULL) {
+        TEST_CHECK(0, "%s: missing fmt or data chunk", name);
+        goto done;
+    }
+
+    TEST_CHECK(memcmp(pDataChunk, pData, dataSize) == 0, "%s: data differs", name);
+
+    int isExtensible = channels > 2 || (formatTag == DR_WAVE_FORMAT_PCM && bitsPerSample > 16);
+    if (isExtensible) {
+        TEST_CHECK(test_get_u32(pFmt - 4) == 40 && pFmt[0] == 0xFE && pFmt[1] == 0xFF, "%s: expected WAVE_FORMAT_EXTENSIBLE", name);
+        TEST_CHECK(pFmt[16] == 22 && pFmt[18] == bitsPerSample && pFmt[24] == formatTag, "%s: bad extensible fmt", name);
+    } else {
+        TEST_CHECK(pFmt[0] == formatTag && pFmt[1] == 0, "%s: expected format tag %u", name, formatTag);
+    }
+
+    if (formatTag != DR_WAVE_FORMAT_PCM) {
+        TEST_CHECK(pFact != NULL && test_get_u32(pFact) == frameCount, "%s: fact frame count is %u, expected %zu", name, pFact ? test_get_u32(pFact) : 0, frameCount);
+    } else {
+        TEST_CHECK(pFact == NULL, "%s: unexpected fact chunk for PCM", name);
+    }
+
+    if (container == drwav_container_rf64) {
+        TEST_CHECK(memcmp(pFile, "RF64\xFF\xFF\xFF\xFF", 8) == 0, "%s: expected RF64 header", name);
+        TEST_CHECK(test_get_u32(pDataChunk - 4) == 0xFFFFFFFF, "%s: data size should be in ds64", name);
+        if (pDs64 != NULL) {
+            TEST_CHECK(test_get_u64(pDs64 +  0) == fileSize - 8, "%s: ds64 RIFF size is %llu, expected %zu", name, (unsigned long long)test_get_u64(pDs64 + 0), fileSize - 8);
+            TEST_CHECK(test_get_u64(pDs64 +  8) == dataSize, "%s: ds64 data size is %llu, expected %zu", name, (unsigned long long)test_get_u64(pDs64 + 8), dataSize);
+            TEST_CHECK(test_get_u64(pDs64 + 16) == frameCount, "%s: ds64 sample count is %llu, expected %zu", name, (unsigned long long)test_get_u64(pDs64 + 16), frameCount);
+        } else {
+            TEST_CHECK(0, "%s: missing ds64 chunk", name);
+        }
+    } else {
+        TEST_CHECK(test_get_u32(pFile + 4) == fileSize - 8, "%s: RIFF size is %u, expected %zu", name, test_get_u32(pFile + 4), fileSize - 8);
+        TEST_CHECK(test_get_u32(pDataChunk - 4) == dataSize, "%s: data size is %u, expected %zu", name, test_get_u32(pDataChunk - 4), dataSize);
+    }
+
+    // And it has to read back.
+    if (drwav_init_memory(&wav, pFile, fileSize)) {
+        TEST_CHECK(wav.container == container, "%s: read back as the wrong container", name);
+        TEST_CHECK(wav.translatedFormatTag == formatTag, "%s: read back as format %u", name, wav.translatedFormatTag);
+        TEST_CHECK(wav.totalSampleCount == frameCount * channels, "%s: read back %llu samples, expected %zu", name, (unsigned long long)wav.totalSampleCount, frameCount * channels);
+
+        unsigned char* pReadBack = (unsigned char*)malloc(dataSize);
+        TEST_CHECK(pReadBack != NULL && drwav_read_raw(&wav, pReadBack, dataSize) == dataSize && memcmp(pReadBack, pData, dataSize) == 0, "%s: data read back differs", name);
+        free(pReadBack);
+        drwav_uninit(&wav);
+    } else {
+        TEST_CHECK(0, "%s: drwav_init_memory()", name);
+    }
+
+    printf("%-32s checked\n", name);
+
+done:
+    free(pData);
+    free(writer.pData);
+}
+
+// A write target that keeps the start of the file and throws the rest away, so a file larger than 4GB can be written without
+// needing the memory for it. Reading it back gives zeros after the part that was kept.
+typedef struct
+{
+    unsigned char header[4096];
+    uint64_t size;
+    uint64_t cursor;
+} test_sparse_file;
+
+static size_t test_sparse_on_write(void* pUserData, const void* pData, size_t bytesToWrite)
+{
+    test_sparse_file* pFile = (test_sparse_file*)pUserData;
+    if (pFile->cursor < sizeof(pFile->header)) {
+        size_t bytesToKeep = (size_t)(sizeof(pFile->header) - pFile->cursor);
+        if (bytesToKeep > bytesToWrite) {
+            bytesToKeep = bytesToWrite;
+        }
+        memcpy(pFile->header + pFile->cursor, pData, bytesToKeep);
+    }
+
+    pFile->cursor += bytesToWrite;
+    if (pFile->size < pFile->cursor) {
+        pFile->size = pFile->cursor;
+    }
+
+    return bytesToWrite;
+}
+
+static size_t test_sparse_on_read(void* pUserData, void* pBufferOut, size_t bytesToRead)
+{
+    test_sparse_file* pFile = (test_sparse_file*)pUserData;
+    if (bytesToRead > pFile->size - pFile->cursor) {
+        bytesToRead = (size_t)(pFile->size - pFile->cursor);
+    }
+
+    for (size_t i = 0; i < bytesToRead; ++i) {
+        uint64_t pos = pFile->cursor + i;
+        ((unsigned char*)pBufferOut)[i] = (pos < sizeof(pFile->header)) ? pFile->header[pos] : 0;
+    }
+
+    pFile->cursor += bytesToRead;
+    return bytesToRead;
+}
+
+static int test_sparse_on_seek(void* pUserData, int64_t offset, drwav_seek_origin origin)
+{
+    test_sparse_file* pFile = (test_sparse_file*)pUserData;
+    int64_t newCursor = (origin == drwav_seek_origin_start) ? offset : (int64_t)pFile->cursor + offset;
+    if (newCursor < 0 || (uint64_t)newCursor > pFile->size) {
+        return 0;
+    }
+
+    pFile->cursor = (uint64_t)newCursor;
+    return 1;
+}
+
+// A RIFF file that grows past 4GB has to be promoted to RF64 when it's closed, with the real sizes in the "ds64" chunk.
+static void test_rf64_promotion()
+{
+    const char* name = "riff -> rf64 promotion";
+
+    test_sparse_file* pFile = (test_sparse_file*)calloc(1, sizeof(*pFile));
+    size_t pieceSize = 1 << 20;
+    unsigned char* pPiece = (unsigned char*)calloc(1, pieceSize);
+    if (pFile == NULL || pPiece == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    drwav_data_format format;
+    format.container = drwav_container_riff;
+    format.format = DR_WAVE_FORMAT_IEEE_FLOAT;
+    format.channels = 2;
+    format.sampleRate = TEST_SAMPLE_RATE;
+    format.bitsPerSample = 32;
+
+    // A little over 4GB, ending part way through a piece.
+    uint64_t dataSize = 0x100000000ULL + 8*12345;
+    uint64_t frameCount = dataSize / 8;
+
+    drwav wav;
+    if (!drwav_init_write(&wav, &format, test_sparse_on_write, test_sparse_on_seek, pFile)) {
+        TEST_CHECK(0, "%s: drwav_init_write()", name);
+        goto done;
+    }
+
+    uint64_t bytesWritten = 0;
+    while (bytesWritten < dataSize) {
+        size_t bytesToWrite = (dataSize - bytesWritten < pieceSize) ? (size_t)(dataSize - bytesWritten) : pieceSize;
+        size_t n = drwav_write_raw(&wav, pPiece, bytesToWrite);
+        bytesWritten += n;
+        if (n < bytesToWrite) {
+            break;
+        }
+    }
+
+    TEST_CHECK(bytesWritten == dataSize, "%s: wrote %llu bytes", name, (unsigned long long)bytesWritten);
+    TEST_CHECK(wav.totalSampleCount == frameCount*2, "%s: total sample count is %llu, expected %llu", name, (unsigned long long)wav.totalSampleCount, (unsigned long long)(frameCount*2));
+    drwav_uninit(&wav);
+
+    const unsigned char* pDs64 = test_find_chunk(pFile->header, sizeof(pFile->header), "ds64");
+    const unsigned char* pFact = test_find_chunk(pFile->header, sizeof(pFile->header), "fact");
+    const unsigned char* pData = test_find_chunk(pFile->header, sizeof(pFile->header), "data");
+    TEST_CHECK(memcmp(pFile->header, "RF64\xFF\xFF\xFF\xFF", 8) == 0, "%s: expected RF64 header", name);
+    if (pDs64 != NULL && pFact != NULL && pData != NULL) {
+        TEST_CHECK(test_get_u64(pDs64 +  0) == pFile->size - 8, "%s: ds64 RIFF size is %llu, expected %llu", name, (unsigned long long)test_get_u64(pDs64 + 0), (unsigned long long)(pFile->size - 8));
+        TEST_CHECK(test_get_u64(pDs64 +  8) == dataSize, "%s: ds64 data size is %llu, expected %llu", name, (unsigned long long)test_get_u64(pDs64 + 8), (unsigned long long)dataSize);
+        TEST_CHECK(test_get_u64(pDs64 + 16) == frameCount, "%s: ds64 sample count is %llu, expected %llu", name, (unsigned long long)test_get_u64(pDs64 + 16), (unsigned long long)frameCount);
+        TEST_CHECK(test_get_u32(pFact) == frameCount, "%s: fact frame count is %u, expected %llu", name, test_get_u32(pFact), (unsigned long long)frameCount);
+        TEST_CHECK(test_get_u32(pData - 4) == 0xFFFFFFFF, "%s: data size should be in ds64", name);
+    } else {
+        TEST_CHECK(0, "%s: missing ds64, fact or data chunk", name);
+    }
+
+    pFile->cursor = 0;
+    if (drwav_init(&wav, test_sparse_on_read, test_sparse_on_seek, pFile)) {
+        TEST_CHECK(wav.container == drwav_container_rf64, "%s: read back as the wrong container", name);
+        TEST_CHECK(wav.totalSampleCount == frameCount*2, "%s: read back %llu samples, expected %llu", name, (unsigned long long)wav.totalSampleCount, (unsigned long long)(frameCount*2));
+        TEST_CHECK(drwav_seek(&wav, frameCount*2 - 2), "%s: drwav_seek() to the last frame", name);
+
+        float lastFrame[4];
+        TEST_CHECK(drwav_read_f32(&wav, 4, lastFrame) == 2, "%s: reading the last frame", name);
+        drwav_uninit(&wav);
+    } else {
+        TEST_CHECK(0, "%s: drwav_init()", name);
+    }
+
+    printf("%-32s checked\n", name);
+
+done:
+    free(pFile);
+    free(pPiece);
+}
+
+
+//// Chunks and metadata ////
+
+static const unsigned char g_w64Suffix[12] = {0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};
+static const unsigned char g_w64List[16] = {0x6C,0x69,0x73,0x74, 0x2F,0x91, 0xCF,0x11, 0xA5,0xD6, 0x28,0xDB,0x04,0xC1,0x00,0x00};
+
+// Appends a chunk to a RIFF or Wave64 file. For Wave64 the GUID is the FOURCC followed by the usual 12 bytes, except "LIST"
+// which uses the Wave64 list GUID. <pSuffix> overrides those 12 bytes when it's not null.
+static void test_write_chunk_ex(test_memory_writer* pWriter, drwav_container container, const char* id, const unsigned char* pSuffix, const void* pData, size_t dataSize)
+{
+    if (container != drwav_container_w64) {
+        test_write_chunk(pWriter, id, pData, dataSize, (unsigned int)dataSize);
+        return;
+    }
+
+    unsigned char header[24];
+    if (memcmp(id, "LIST", 4) == 0) {
+        memcpy(header, g_w64List, 16);
+    } else {
+        memcpy(header, id, 4);
+        memcpy(header + 4, (pSuffix != NULL) ? pSuffix : g_w64Suffix, 12);
+    }
+    test_put_u32(header + 16, (unsigned int)(dataSize + 24));
+    test_put_u32(header + 20, 0);
+    test_on_write(pWriter, header, 24);
+    test_on_write(pWriter, pData, dataSize);
+    test_on_write(pWriter, "\0\0\0\0\0\0\0", (8 - dataSize % 8) % 8);
+}
+
+// Builds a 16-bit stereo file with "smpl", "cue " and "LIST" chunks after the data, and an odd sized chunk before it. Wave64
+// files also get a chunk whose GUID starts with "smpl" but isn't the "smpl" GUID, which needs to be skipped.
+static void test_build_metadata_file(test_memory_writer* pWriter, drwav_container container, const int16_t* pSamples, size_t frameCount)
+{
+    test_memory_writer_init(pWriter, 4096 + frameCount*4);
+
+    if (container == drwav_container_w64) {
+        static const unsigned char riff[16] = {0x72,0x69,0x66,0x66, 0x2E,0x91, 0xCF,0x11, 0xA5,0xD6, 0x28,0xDB,0x04,0xC1,0x00,0x00};
+        static const unsigned char wave[16] = {0x77,0x61,0x76,0x65, 0xF3,0xAC, 0xD3,0x11, 0x8C,0xD1, 0x00,0xC0,0x4F,0x8E,0xDB,0x8A};
+        test_on_write(pWriter, riff, 16);
+        test_on_write(pWriter, "\0\0\0\0\0\0\0\0", 8);
+        test_on_write(pWriter, wave, 16);
+    } else {
+        test_begin_riff(pWriter);
+    }
+
+    unsigned char fmt[16];
+    test_put_u16(fmt +  0, DR_WAVE_FORMAT_PCM);
+    test_put_u16(fmt +  2, 2);
+    test_put_u32(fmt +  4, TEST_SAMPLE_RATE);
+    test_put_u32(fmt +  8, TEST_SAMPLE_RATE*4);
+    test_put_u16(fmt + 12, 4);
+    test_put_u16(fmt + 14, 16);
+    test_write_chunk_ex(pWriter, container, "fmt ", NULL, fmt, sizeof(fmt));
+    test_write_chunk_ex(pWriter, container, "junk", NULL, "odd", 3);
+    test_write_chunk_ex(pWriter, container, "data", NULL, pSamples, frameCount*4);
+
+    if (container == drwav_container_w64) {
+        static const unsigned char otherSuffix[12] = {0x11,0x22, 0x33,0x44, 0x55,0x66, 0x77,0x88,0x99,0xAA,0xBB,0xCC};
+        test_write_chunk_ex(pWriter, container, "smpl", otherSuffix, "not a sampler chunk", 19);
+    }
+
+    // Two loops after the 36 byte header, followed by 4 bytes of sampler specific data.
+    unsigned char smpl[36 + 2*24 + 4];
+    memset(smpl, 0, sizeof(smpl));
+    test_put_u32(smpl + 28, 2);
+    test_put_u32(smpl + 32, 4);
+    for (unsigned int iLoop = 0; iLoop < 2; ++iLoop) {
+        unsigned char* pLoop = smpl + 36 + iLoop*24;
+        test_put_u32(pLoop +  0, 100 + iLoop);
+        test_put_u32(pLoop +  4, iLoop);
+        test_put_u32(pLoop +  8, 1000*iLoop);
+        test_put_u32(pLoop + 12, 1000*iLoop + 499);
+        test_put_u32(pLoop + 20, 3);
+    }
+    test_write_chunk_ex(pWriter, container, "smpl", NULL, smpl, sizeof(smpl));
+
+    unsigned char cue[4 + 24];
+    memset(cue, 0, sizeof(cue));
+    test_put_u32(cue +  0, 1);
+    test_put_u32(cue +  4, 7);
+    test_put_u32(cue +  8, 1234);
+    memcpy(cue + 12, "data", 4);
+    test_put_u32(cue + 24, 1234);
+    test_write_chunk_ex(pWriter, container, "cue ", NULL, cue, sizeof(cue));
+
+    // A title with an odd length, padded to 2 bytes, and a null terminated artist.
+    unsigned char list[4 + 8 + 6 + 8 + 8];
+    memcpy(list, "INFO", 4);
+    memcpy(list + 4, "INAM", 4);
+    test_put_u32(list + 8, 5);
+    memcpy(list + 12, "Title\0", 6);
+    memcpy(list + 18, "IART", 4);
+    test_put_u32(list + 22, 8);
+    memcpy(list + 26, "Artist\0\0", 8);
+    test_write_chunk_ex(pWriter, container, "LIST", NULL, list, sizeof(list));
+
+    if (container == drwav_container_w64) {
+        test_put_u32(pWriter->pData + 16, (unsigned int)pWriter->dataSize);
+    } else {
+        test_finish_riff(pWriter);
+    }
+}
+
+// Checks the chunk and metadata accessors, interleaved with reading the samples to make sure they don't move the read
+// position.
+static void test_metadata(drwav_container container)
+{
+    const char* name = (container == drwav_container_w64) ? "metadata w64" : "metadata riff";
+    size_t frameCount = 5000;
+    size_t sampleCount = frameCount*2;
+
+    int16_t* pSamples = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    int16_t* pReadBack = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    if (pSamples == NULL || pReadBack == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    for (size_t iSample = 0; iSample < sampleCount; ++iSample) {
+        pSamples[iSample] = (int16_t)(iSample*7919);
+    }
+
+    test_memory_writer writer;
+    test_build_metadata_file(&writer, container, pSamples, frameCount);
+
+    drwav wav;
+    if (!drwav_init_memory(&wav, writer.pData, writer.dataSize)) {
+        TEST_CHECK(0, "%s: drwav_init_memory()", name);
+        goto done;
+    }
+
+    size_t samplesRead = drwav_read_s16(&wav, 1000, pReadBack);
+
+    const drwav_chunk* pJunk = drwav_find_chunk(&wav, "junk");
+    const drwav_chunk* pData = drwav_find_chunk(&wav, "data");
+    const drwav_chunk* pSmpl = drwav_find_chunk(&wav, "smpl");
+    const drwav_chunk* pList = drwav_find_chunk(&wav, "LIST");
+    TEST_CHECK(pJunk != NULL && pJunk->dataSize == 3, "%s: junk chunk", name);
+    TEST_CHECK(pData != NULL && pData->dataSize == frameCount*4, "%s: data chunk", name);
+    TEST_CHECK(pSmpl != NULL && pSmpl->dataSize == 36 + 2*24 + 4, "%s: smpl chunk", name);
+    TEST_CHECK(pList != NULL && pList->dataSize == 34, "%s: LIST chunk", name);
+    TEST_CHECK(drwav_find_chunk(&wav, "bext") == NULL, "%s: found a bext chunk that isn't there", name);
+
+    char fourcc[4];
+    TEST_CHECK(pList != NULL && drwav_read_chunk_data(&wav, pList, 0, fourcc, 4) == 4 && memcmp(fourcc, "INFO", 4) == 0, "%s: LIST chunk data", name);
+
+    samplesRead += drwav_read_s16(&wav, 3000, pReadBack + samplesRead);
+
+    drwav_smpl_loop loops[4];
+    TEST_CHECK(drwav_get_smpl_loops(&wav, NULL, 0) == 2, "%s: smpl loop count", name);
+    uint32_t loopCount = drwav_get_smpl_loops(&wav, loops, 4);
+    TEST_CHECK(loopCount == 2, "%s: read %u smpl loops", name, loopCount);
+    for (uint32_t iLoop = 0; iLoop < loopCount && iLoop < 2; ++iLoop) {
+        TEST_CHECK(loops[iLoop].cuePointId == 100 + iLoop && loops[iLoop].type == iLoop && loops[iLoop].start == 1000*iLoop &&
+                   loops[iLoop].end == 1000*iLoop + 499 && loops[iLoop].fraction == 0 && loops[iLoop].playCount == 3, "%s: smpl loop %u", name, iLoop);
+    }
+
+    drwav_cue_point cuePoint;
+    TEST_CHECK(drwav_get_cue_points(&wav, &cuePoint, 1) == 1, "%s: cue point count", name);
+    TEST_CHECK(cuePoint.id == 7 && cuePoint.position == 1234 && memcmp(cuePoint.dataChunkId, "data", 4) == 0 && cuePoint.sampleOffset == 1234, "%s: cue point", name);
+
+    // Wave64 has no INFO list.
+    char title[16];
+    char artist[4];
+    if (container == drwav_container_w64) {
+        TEST_CHECK(drwav_get_info_string(&wav, "INAM", title, sizeof(title)) == 0 && title[0] == '\0', "%s: got an INFO string", name);
+    } else {
+        TEST_CHECK(drwav_get_info_string(&wav, "INAM", title, sizeof(title)) == 5 && strcmp(title, "Title") == 0, "%s: INAM", name);
+        TEST_CHECK(drwav_get_info_string(&wav, "IART", artist, sizeof(artist)) == 6 && strcmp(artist, "Art") == 0, "%s: IART", name);
+        TEST_CHECK(drwav_get_info_string(&wav, "ICMT", NULL, 0) == 0, "%s: found an ICMT that isn't there", name);
+    }
+
+    samplesRead += drwav_read_s16(&wav, sampleCount - samplesRead, pReadBack + samplesRead);
+    TEST_CHECK(samplesRead == sampleCount && memcmp(pReadBack, pSamples, sampleCount*2) == 0, "%s: samples differ", name);
+
+    TEST_CHECK(drwav_seek(&wav, 2000) && drwav_find_chunk(&wav, "cue ") != NULL && drwav_read_s16(&wav, 2, pReadBack) == 2 &&
+               memcmp(pReadBack, pSamples + 2000, 4) == 0, "%s: samples differ after seeking", name);
+
+    drwav_uninit(&wav);
+    printf("%-32s checked\n", name);
+
+done:
+    free(writer.pData);
+    free(pSamples);
+    free(pReadBack);
+}
+
+
+//// Files ////
+
+#define TEST_FILE_PATH  "dr_wav_test2.tmp.wav"
+
+// Reads the samples from <firstSample> in a few calls of up to <chunkSamples>, comparing them with <pSamples>. Returns the
+// number of samples that matched.
+static size_t test_read_and_compare(drwav* pWav, const int16_t* pSamples, size_t sampleCount, size_t firstSample, size_t samplesToRead, size_t chunkSamples, int16_t* pReadBack)
+{
+    if (samplesToRead > sampleCount - firstSample) {
+        samplesToRead = sampleCount - firstSample;
+    }
+
+    size_t totalSamplesRead = 0;
+    while (totalSamplesRead < samplesToRead) {
+        size_t samplesThisCall = (samplesToRead - totalSamplesRead < chunkSamples) ? samplesToRead - totalSamplesRead : chunkSamples;
+        size_t samplesRead = drwav_read_s16(pWav, samplesThisCall, pReadBack);
+        if (samplesRead != samplesThisCall || memcmp(pReadBack, pSamples + firstSample + totalSamplesRead, samplesRead*2) != 0) {
+            break;
+        }
+        totalSamplesRead += samplesRead;
+    }
+
+    return totalSamplesRead;
+}
+
+// Looks up every piece of metadata in the file built by test_build_metadata_file(). This seeks all over the file.
+static int test_check_metadata(drwav* pWav)
+{
+    drwav_smpl_loop loops[2];
+    drwav_cue_point cuePoint;
+    char title[8];
+    const drwav_chunk* pSmpl = drwav_find_chunk(pWav, "smpl");
+    const drwav_chunk* pList = drwav_find_chunk(pWav, "LIST");
+
+    return pSmpl != NULL && pSmpl->dataSize == 36 + 2*24 + 4 && pList != NULL && pList->dataSize == 34 &&
+           drwav_get_smpl_loops(pWav, loops, 2) == 2 && loops[1].end == 1499 &&
+           drwav_get_cue_points(pWav, &cuePoint, 1) == 1 && cuePoint.position == 1234 &&
+           drwav_get_info_string(pWav, "INAM", title, sizeof(title)) == 5 && strcmp(title, "Title") == 0;
+}
+
+static void test_file_mapped(const int16_t* pSamples, size_t frameCount, const unsigned char* pFileData, size_t fileSize)
+{
+    const char* name = "drwav_init_file_mapped()";
+    size_t sampleCount = frameCount*2;
+    int16_t* pReadBack = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    if (pReadBack == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    drwav wav;
+    TEST_CHECK(!drwav_init_file_mapped(&wav, "dr_wav_test2.missing.wav"), "%s: opened a file that doesn't exist", name);
+
+    if (drwav_init_file_mapped(&wav, TEST_FILE_PATH)) {
+        TEST_CHECK(wav.totalSampleCount == sampleCount, "%s: total sample count is %llu, expected %zu", name, (unsigned long long)wav.totalSampleCount, sampleCount);
+
+        // The raw data pointer points straight at the data chunk of the file.
+        uint64_t rawFrameCount = 0;
+        const void* pRaw = drwav_get_raw_data_pointer(&wav, &rawFrameCount);
+        const drwav_chunk* pData = drwav_find_chunk(&wav, "data");
+        TEST_CHECK(pRaw != NULL && rawFrameCount == frameCount && pData != NULL && pData->dataPos + frameCount*4 <= fileSize &&
+                   memcmp(pRaw, pFileData + pData->dataPos, frameCount*4) == 0, "%s: raw data pointer", name);
+
+        size_t samplesRead = test_read_and_compare(&wav, pSamples, sampleCount, 0, sampleCount/2, 999, pReadBack);
+        TEST_CHECK(test_check_metadata(&wav), "%s: metadata", name);
+        samplesRead += test_read_and_compare(&wav, pSamples, sampleCount, samplesRead, sampleCount, 4096, pReadBack);
+        TEST_CHECK(samplesRead == sampleCount, "%s: samples differ after %zu samples", name, samplesRead);
+
+        drwav_uninit(&wav);
+    } else {
+        TEST_CHECK(0, "%s: failed to open %s", name, TEST_FILE_PATH);
+    }
+
+    drwav* pWav = drwav_open_file_mapped(TEST_FILE_PATH);
+    TEST_CHECK(pWav != NULL && drwav_read_s16(pWav, sampleCount, pReadBack) == sampleCount && memcmp(pReadBack, pSamples, sampleCount*2) == 0, "drwav_open_file_mapped(): samples differ");
+    drwav_close(pWav);
+
+    printf("%-32s checked\n", name);
+    free(pReadBack);
+}
+
+#ifdef DRWAV_HAS_READ_AHEAD
+// Takes a consistent snapshot of the state shared with the read-ahead thread.
+static drwav__read_ahead test_get_read_ahead_state(drwav* pWav)
+{
+    drwav__read_ahead* pRA = (drwav__read_ahead*)pWav->pUserData;
+    drwav__ra_lock(pRA);
+    drwav__read_ahead state = *pRA;
+    drwav__ra_unlock(pRA);
+    return state;
+}
+
+// Checks reading through drwav_init_file_read_ahead() with a ring buffer of <bufferSize> bytes: sequential reads, the ring
+// being reset on seeks, seeks that stay within the current half, underruns, random seeks and metadata lookups.
+static void test_read_ahead(const int16_t* pSamples, size_t frameCount, size_t bufferSize, int seekCount)
+{
+    char name[64];
+    if (bufferSize == 0) {
+        snprintf(name, sizeof(name), "read-ahead (default ring)");
+    } else {
+        snprintf(name, sizeof(name), "read-ahead (%zu byte ring)", bufferSize);
+    }
+
+    size_t sampleCount = frameCount*2;
+    int16_t* pReadBack = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    if (pReadBack == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    // 0 is the default size.
+    int isTiny = bufferSize != 0 && bufferSize < 400;
+
+    drwav wav;
+    if (!drwav_init_file_read_ahead(&wav, TEST_FILE_PATH, bufferSize)) {
+        TEST_CHECK(0, "%s: failed to open %s", name, TEST_FILE_PATH);
+        free(pReadBack);
+        return;
+    }
+
+    const drwav_chunk* pData = drwav_find_chunk(&wav, "data");
+    uint64_t dataPos = (pData != NULL) ? pData->dataPos : 0;
+    TEST_CHECK(pData != NULL && pData->dataSize == frameCount*4, "%s: data chunk", name);
+    TEST_CHECK(wav.totalSampleCount == sampleCount, "%s: total sample count is %llu, expected %zu", name, (unsigned long long)wav.totalSampleCount, sampleCount);
+
+    // Every call after the first needs more than the ring can hold when it's tiny, so has to wait for the thread at least once.
+    // The first read after a seek is never counted.
+    uint32_t callCount = 20;
+    uint32_t underrunsBefore = drwav_get_read_ahead_underrun_count(&wav);
+    size_t samplesRead = test_read_and_compare(&wav, pSamples, sampleCount, 0, callCount*200, 200, pReadBack);
+    uint32_t underruns = drwav_get_read_ahead_underrun_count(&wav) - underrunsBefore;
+    TEST_CHECK(samplesRead == callCount*200, "%s: samples differ after %zu samples", name, samplesRead);
+    if (isTiny) {
+        TEST_CHECK(underruns >= callCount - 1, "%s: %u underruns in %u calls", name, underruns, callCount);
+    }
+
+    // A seek outside of the current half resets the ring.
+    drwav__read_ahead before = test_get_read_ahead_state(&wav);
+    size_t target = sampleCount / 2 + 1234;
+    TEST_CHECK(drwav_seek(&wav, target), "%s: drwav_seek(%zu)", name, target);
+    drwav__read_ahead after = test_get_read_ahead_state(&wav);
+    TEST_CHECK(after.generation == before.generation + 1, "%s: generation went from %u to %u on a seek", name, before.generation, after.generation);
+    TEST_CHECK(!after.isPrimed && after.readHalf == 0 && after.readOffset == 0 && after.readPos == dataPos + target*2, "%s: the ring wasn't reset", name);
+
+    underrunsBefore = drwav_get_read_ahead_underrun_count(&wav);
+    samplesRead = test_read_and_compare(&wav, pSamples, sampleCount, target, 2, 2, pReadBack);
+    TEST_CHECK(samplesRead == 2, "%s: samples differ after seeking to %zu", name, target);
+    TEST_CHECK(drwav_get_read_ahead_underrun_count(&wav) == underrunsBefore, "%s: the first read after a seek counted as an underrun", name);
+
+    // A short seek forward stays in the half that's being read.
+    before = test_get_read_ahead_state(&wav);
+    if (before.isHalfFull[before.readHalf] && before.readOffset + 40 < before.halfDataSize[before.readHalf]) {
+        TEST_CHECK(drwav_seek(&wav, target + 2 + 16), "%s: drwav_seek(%zu)", name, target + 18);
+        after = test_get_read_ahead_state(&wav);
+        TEST_CHECK(after.generation == before.generation && after.readOffset == before.readOffset + 32, "%s: a short seek reset the ring", name);
+        TEST_CHECK(test_read_and_compare(&wav, pSamples, sampleCount, target + 18, 100, 100, pReadBack) == 100, "%s: samples differ after a short seek", name);
+    } else {
+        TEST_CHECK(isTiny, "%s: the half being read should be full", name);
+    }
+
+    // Random seeks, interleaved with metadata lookups that seek away and back.
+    unsigned int random = 12345;
+    for (int iSeek = 0; iSeek < seekCount; ++iSeek) {
+        random = random*1103515245 + 12345;
+        size_t sample = ((random >> 8) % frameCount) * 2;
+        random = random*1103515245 + 12345;
+        size_t samplesToRead = (random >> 8) % (isTiny ? 400 : 20000);
+
+        TEST_CHECK(drwav_seek(&wav, sample), "%s: drwav_seek(%zu)", name, sample);
+        if (iSeek % 8 == 0) {
+            TEST_CHECK(test_check_metadata(&wav), "%s: metadata after seeking to %zu", name, sample);
+        }
+
+        size_t expectedCount = (samplesToRead < sampleCount - sample) ? samplesToRead : sampleCount - sample;
+        samplesRead = test_read_and_compare(&wav, pSamples, sampleCount, sample, samplesToRead/2, 1 + (random >> 20) % 3000, pReadBack);
+        if (iSeek % 8 == 4) {
+            TEST_CHECK(test_check_metadata(&wav), "%s: metadata part way through reading from %zu", name, sample);
+        }
+        samplesRead += test_read_and_compare(&wav, pSamples, sampleCount, sample + samplesRead, samplesToRead - samplesToRead/2, 4096, pReadBack);
+        TEST_CHECK(samplesRead == expectedCount, "%s: read %zu samples after seeking to %zu, expected %zu", name, samplesRead, sample, expectedCount);
+    }
+
+    // Reading right up to the end.
+    if (!isTiny) {
+        TEST_CHECK(drwav_seek(&wav, 0), "%s: drwav_seek(0)", name);
+        samplesRead = test_read_and_compare(&wav, pSamples, sampleCount, 0, sampleCount, 65536, pReadBack);
+        TEST_CHECK(samplesRead == sampleCount && drwav_read_s16(&wav, 2, pReadBack) == 0, "%s: read %zu samples from the start, expected %zu", name, samplesRead, sampleCount);
+    }
+
+    drwav_uninit(&wav);
+    printf("%-32s checked\n", name);
+    free(pReadBack);
+}
+#endif
+
+static void test_files()
+{
+    size_t frameCount = 200000;
+    size_t sampleCount = frameCount*2;
+
+    int16_t* pSamples = (int16_t*)malloc(sampleCount * sizeof(int16_t));
+    if (pSamples == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+
+    for (size_t iSample = 0; iSample < sampleCount; ++iSample) {
+        pSamples[iSample] = (int16_t)(iSample*7919 + (iSample >> 16));
+    }
+
+    test_memory_writer writer;
+    test_build_metadata_file(&writer, drwav_container_riff, pSamples, frameCount);
+
+    FILE* pFile = fopen(TEST_FILE_PATH, "wb");
+    if (pFile == NULL || fwrite(writer.pData, 1, writer.dataSize, pFile) != writer.dataSize) {
+        TEST_CHECK(0, "failed to write %s", TEST_FILE_PATH);
+        if (pFile != NULL) {
+            fclose(pFile);
+        }
+        goto done;
+    }
+    fclose(pFile);
+
+    test_file_mapped(pSamples, frameCount, writer.pData, writer.dataSize);
+
+#ifdef DRWAV_HAS_READ_AHEAD
+    {
+        drwav wav;
+        TEST_CHECK(drwav_init_memory(&wav, writer.pData, writer.dataSize) && drwav_get_read_ahead_underrun_count(&wav) == 0, "underruns reported for memory");
+        drwav_uninit(&wav);
+    }
+
+    test_read_ahead(pSamples, frameCount, 2, 16);
+    test_read_ahead(pSamples, frameCount, 4096, 400);
+    test_read_ahead(pSamples, frameCount, 0, 400);
+#endif
+
+done:
+    remove(TEST_FILE_PATH);
+    free(writer.pData);
+    free(pSamples);
+}
+
+
+int main(int argc, char** argv)
+{
+    int isQuick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    size_t frameCount = isQuick ? 20000 : 1000000;
+    int timingRuns = isQuick ? 1 : 5;
+
+    printf("Reading (MB/s of file data, %zu frames)\n", frameCount);
+    printf("%-12s    %-10s", "format", "output");
+    for (size_t iChunk = 0; iChunk < TEST_CHUNK_SIZE_COUNT; ++iChunk) {
+        printf(" %9zu", g_chunkSizes[iChunk]);
+    }
+    printf("   <- frames per call\n");
+
+    for (int iFormat = 0; iFormat < test_format_count; ++iFormat) {
+        test_format_read(&g_formats[iFormat], frameCount, timingRuns);
+    }
+
+
+    printf("\nWriting with drwav_write_f32() (MB/s of file data)\n");
+
+    float* pSamples = (float*)malloc(frameCount * 2 * sizeof(float));
+    if (pSamples == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    unsigned int random = 1;
+    for (size_t iFrame = 0; iFrame < frameCount; ++iFrame) {
+        for (unsigned int iChannel = 0; iChannel < 2; ++iChannel) {
+            pSamples[iFrame*2 + iChannel] = (float)test_signal(iFrame, iChannel, &random);
+        }
+    }
+
+    test_format_write(DR_WAVE_FORMAT_PCM,        16, 0, pSamples, frameCount, timingRuns);
+    test_format_write(DR_WAVE_FORMAT_PCM,        16, 1, pSamples, frameCount, timingRuns);
+    test_format_write(DR_WAVE_FORMAT_PCM,        24, 0, pSamples, frameCount, timingRuns);
+    test_format_write(DR_WAVE_FORMAT_PCM,        24, 1, pSamples, frameCount, timingRuns);
+    test_format_write(DR_WAVE_FORMAT_PCM,        32, 0, pSamples, frameCount, timingRuns);
+    test_format_write(DR_WAVE_FORMAT_IEEE_FLOAT, 32, 0, pSamples, frameCount, timingRuns);
+    free(pSamples);
+
+
+    printf("\nOther checks\n");
+
+    static const test_format_info monoFormat = {"s16 mono", DR_WAVE_FORMAT_PCM, 16, 2, 1, 0, 0};
+    test_downmix(&monoFormat, frameCount);
+    test_downmix(&g_formats[test_format_u8], frameCount);
+    test_downmix(&g_formats[test_format_s16], frameCount);
+    test_downmix(&g_formats[test_format_s24_extensible], frameCount);
+    test_downmix(&g_formats[test_format_f32_extensible], frameCount);
+
+    test_adpcm(1, 1, 1);
+    test_adpcm(1, 2, 1);
+    test_adpcm(1, 2, 0);
+    test_adpcm(0, 1, 1);
+    test_adpcm(0, 2, 1);
+    test_adpcm(0, 2, 0);
+
+    test_write_raw(drwav_container_riff, DR_WAVE_FORMAT_PCM,        2, 16);
+    test_write_raw(drwav_container_riff, DR_WAVE_FORMAT_PCM,        2, 24);
+    test_write_raw(drwav_container_riff, DR_WAVE_FORMAT_IEEE_FLOAT, 2, 32);
+    test_write_raw(drwav_container_rf64, DR_WAVE_FORMAT_PCM,        6, 16);
+    test_write_raw(drwav_container_rf64, DR_WAVE_FORMAT_IEEE_FLOAT, 2, 32);
+    test_rf64_promotion();
+
+    test_non_seekable();
+
+    test_metadata(drwav_container_riff);
+    test_metadata(drwav_container_w64);
+    test_files();
+
+
+    if (g_failCount > 0) {
+        printf("\n%d CHECKS FAILED\n", g_failCount);
+        return 1;
+    }
+
+    printf("\nALL CHECKS PASSED\n");
+    return 0;
+}